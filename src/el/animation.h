@@ -115,7 +115,11 @@ class Animation : public util::TypedObject,
 
  private:
   friend class AnimationManager;
+  static const uint32_t kNotBatched = ~0u;
   util::IntrusiveList<AnimationListener> m_listeners;
+  // Index into the AnimationManager update batch, or kNotBatched if the
+  // animation was started after the current batch was gathered.
+  uint32_t m_batch_index = kNotBatched;
   void InvokeOnAnimationStart();
   void InvokeOnAnimationUpdate(float progress);
   void InvokeOnAnimationStop(bool aborted);
@@ -156,7 +160,7 @@ class ExternalFloatAnimation : public FloatAnimation {
   float* target_value;
 
  public:
-  TBOBJECT_SUBCLASS(ExternalFloatAnimation, Animation);
+  TBOBJECT_SUBCLASS(ExternalFloatAnimation, FloatAnimation);
 
   ExternalFloatAnimation(
       float* target_value,
@@ -8,6 +8,8 @@
  */
 
 #include <algorithm>
+#include <cmath>
+#include <vector>
 
 #include "el/animation_manager.h"
 #include "el/util/metrics.h"
@@ -15,23 +17,73 @@
 namespace el {
 
 util::IntrusiveList<Animation> AnimationManager::animating_objects;
+util::IntrusiveList<AnimationUpdateListener> AnimationManager::update_listeners;
 int AnimationManager::block_animations_counter = 0;
 
-inline float SmoothStep(float x) { return x * x * (3.0f - 2.0f * x); }
+namespace {
 
-inline float sc(float x) {
-  float s = x < 0 ? -1.f : 1.f;
-  x = std::abs(x);
-  if (x >= 1) return s;
-  return s * (x < 0 ? x / 0.5f : (x / (1 + x * x)) / 0.5f);
+inline float SlowDown(float x) {
+  float tmp = 1 - x;
+  return 1 - tmp * tmp * tmp;
 }
 
+inline float SpeedUp(float x) { return x * x * x; }
+
+inline float SmoothStep(float x) { return x * x * (3.0f - 2.0f * x); }
+
+// Written without branches so that the batched loop can be vectorized.
 inline float SmoothCurve(float x, float a) {
   float r = a * x / (2 * a * x - a - x + 1);
   r = (r - 0.5f) * 2;
-  return sc(r) * 0.5f + 0.5f;
+  float s = r < 0 ? -1.f : 1.f;
+  float abs_r = std::abs(r);
+  float v = abs_r >= 1 ? 1.f : (abs_r / (1 + abs_r * abs_r)) / 0.5f;
+  return s * v * 0.5f + 0.5f;
 }
 
+inline float Smooth(float x) { return SmoothCurve(x, 0.6f); }
+
+inline float ApplyCurve(AnimationCurve curve, float progress) {
+  switch (curve) {
+    case AnimationCurve::kSlowDown:
+      return SlowDown(progress);
+    case AnimationCurve::kSpeedUp:
+      return SpeedUp(progress);
+    case AnimationCurve::kBezier:
+      return SmoothStep(progress);
+    case AnimationCurve::kSmooth:
+      return Smooth(progress);
+    default:  // linear (progress is already linear)
+      return progress;
+  }
+}
+
+const size_t kCurveCount = static_cast<size_t>(AnimationCurve::kSmooth) + 1;
+
+// Structure-of-arrays snapshot of the running animations, grouped by curve so
+// that each curve is evaluated in one tight loop. Kept between updates so that
+// steady-state frames don't allocate.
+struct UpdateBatch {
+  std::vector<float> elapsed;
+  std::vector<float> duration;
+  std::vector<float> progress;
+  // Animations using curve c are in [curve_begin[c], curve_begin[c + 1]).
+  size_t curve_begin[kCurveCount + 1];
+
+  template <float (*Curve)(float)>
+  void ApplyCurve(AnimationCurve curve) {
+    size_t c = static_cast<size_t>(curve);
+    float* values = progress.data() + curve_begin[c];
+    size_t count = curve_begin[c + 1] - curve_begin[c];
+    for (size_t i = 0; i < count; ++i) {
+      values[i] = Curve(values[i]);
+    }
+  }
+};
+UpdateBatch g_batch;
+
+}  // namespace
+
 // static
 void AnimationManager::AbortAllAnimations() {
   while (Animation* obj = animating_objects.GetFirst()) {
@@ -41,58 +93,117 @@ void AnimationManager::AbortAllAnimations() {
 
 // static
 void AnimationManager::Update() {
+  if (!animating_objects.HasLinks()) {
+    return;
+  }
   uint64_t time_now = util::GetTimeMS();
 
-  auto iter = animating_objects.IterateForward();
-  while (Animation* obj = iter.GetAndStep()) {
+  // Gather the running animations, bucketed by curve.
+  size_t curve_count[kCurveCount] = {0};
+  size_t count = 0;
+  for (Animation* obj = animating_objects.GetFirst(); obj;
+       obj = obj->GetNext()) {
+    ++curve_count[static_cast<size_t>(obj->animation_curve)];
+    ++count;
+  }
+  UpdateBatch& batch = g_batch;
+  batch.elapsed.resize(count);
+  batch.duration.resize(count);
+  batch.progress.resize(count);
+  size_t next_index[kCurveCount];
+  batch.curve_begin[0] = 0;
+  for (size_t c = 0; c < kCurveCount; ++c) {
+    next_index[c] = batch.curve_begin[c];
+    batch.curve_begin[c + 1] = batch.curve_begin[c] + curve_count[c];
+  }
+  for (Animation* obj = animating_objects.GetFirst(); obj;
+       obj = obj->GetNext()) {
     // Adjust the start time if it's the first update time for this object.
     if (obj->adjust_start_time) {
       obj->animation_start_time = time_now;
       obj->adjust_start_time = false;
     }
+    size_t index = next_index[static_cast<size_t>(obj->animation_curve)]++;
+    obj->m_batch_index = static_cast<uint32_t>(index);
+    batch.elapsed[index] =
+        static_cast<float>(time_now - obj->animation_start_time);
+    batch.duration[index] = static_cast<float>(obj->animation_duration);
+  }
 
-    // Calculate current progress
-    // If animation_duration is 0, it should just complete immediately.
-    float progress = 1.0f;
-    if (obj->animation_duration != 0) {
-      progress = static_cast<float>(time_now - obj->animation_start_time) /
-                 static_cast<float>(obj->animation_duration);
-      progress = std::min(progress, 1.0f);
-    }
+  // Calculate current progress.
+  // If animation_duration is 0, it should just complete immediately.
+  const float* elapsed = batch.elapsed.data();
+  const float* duration = batch.duration.data();
+  float* progress = batch.progress.data();
+  for (size_t i = 0; i < count; ++i) {
+    float p = std::min(elapsed[i] / duration[i], 1.0f);
+    progress[i] = duration[i] == 0 ? 1.0f : p;
+  }
+
+  // Apply animation curves, one contiguous range per curve.
+  batch.ApplyCurve<SlowDown>(AnimationCurve::kSlowDown);
+  batch.ApplyCurve<SpeedUp>(AnimationCurve::kSpeedUp);
+  batch.ApplyCurve<SmoothStep>(AnimationCurve::kBezier);
+  batch.ApplyCurve<Smooth>(AnimationCurve::kSmooth);
 
-    // Apply animation curve
-    float tmp;
-    switch (obj->animation_curve) {
-      case AnimationCurve::kSlowDown:
-        tmp = 1 - progress;
-        progress = 1 - tmp * tmp * tmp;
-        break;
-      case AnimationCurve::kSpeedUp:
-        progress = progress * progress * progress;
-        break;
-      case AnimationCurve::kBezier:
-        progress = SmoothStep(progress);
-        break;
-      case AnimationCurve::kSmooth:
-        progress = SmoothCurve(progress, 0.6f);
-        break;
-      default:  // linear (progress is already linear)
-        break;
+  auto begin_iter = update_listeners.IterateForward();
+  while (AnimationUpdateListener* listener = begin_iter.GetAndStep()) {
+    listener->OnAnimationsUpdateBegin();
+  }
+
+  // Update animations in order. Callbacks may start, abort or delete any
+  // animation, so walk the list safely and fall back to computing the
+  // progress of animations that weren't gathered above.
+  auto iter = animating_objects.IterateForward();
+  while (Animation* obj = iter.GetAndStep()) {
+    float obj_progress;
+    if (obj->m_batch_index != Animation::kNotBatched) {
+      obj_progress = progress[obj->m_batch_index];
+      obj->m_batch_index = Animation::kNotBatched;
+    } else {
+      if (obj->adjust_start_time) {
+        obj->animation_start_time = time_now;
+        obj->adjust_start_time = false;
+      }
+      obj_progress = 1.0f;
+      if (obj->animation_duration != 0) {
+        obj_progress =
+            static_cast<float>(time_now - obj->animation_start_time) /
+            static_cast<float>(obj->animation_duration);
+        obj_progress = std::min(obj_progress, 1.0f);
+      }
+      obj_progress = ApplyCurve(obj->animation_curve, obj_progress);
     }
 
     // Update animation
-    obj->InvokeOnAnimationUpdate(progress);
+    obj->InvokeOnAnimationUpdate(obj_progress);
     if (!animating_objects.ContainsLink(obj)) {
       continue;
     }
 
     // Remove completed animations
-    if (progress == 1.0f) {
+    if (obj_progress == 1.0f) {
       animating_objects.Remove(obj);
       obj->InvokeOnAnimationStop(false);
       delete obj;
     }
   }
+
+  auto end_iter = update_listeners.IterateForward();
+  while (AnimationUpdateListener* listener = end_iter.GetAndStep()) {
+    listener->OnAnimationsUpdateEnd();
+  }
+}
+
+// static
+void AnimationManager::AddUpdateListener(AnimationUpdateListener* listener) {
+  update_listeners.AddLast(listener);
+}
+
+// static
+void AnimationManager::RemoveUpdateListener(
+    AnimationUpdateListener* listener) {
+  update_listeners.Remove(listener);
 }
 
 // static
@@ -115,6 +226,7 @@ void AnimationManager::StartAnimation(Animation* obj,
   obj->animation_start_time = util::GetTimeMS();
   obj->animation_duration = std::max(animation_duration, uint64_t(0));
   obj->animation_curve = animation_curve;
+  obj->m_batch_index = Animation::kNotBatched;
   animating_objects.AddLast(obj);
   obj->InvokeOnAnimationStart();
 }
@@ -18,16 +18,40 @@
 
 namespace el {
 
+// Listens to AnimationManager::Update passes.
+// Useful for batching side effects (such as repaint invalidation) of all the
+// animations updated in the same frame.
+class AnimationUpdateListener
+    : public util::IntrusiveListEntry<AnimationUpdateListener> {
+ public:
+  virtual ~AnimationUpdateListener() = default;
+
+  // Called before the first animation is updated.
+  virtual void OnAnimationsUpdateBegin() = 0;
+
+  // Called after all animations have been updated (and completed animations
+  // have been stopped and deleted).
+  virtual void OnAnimationsUpdateEnd() = 0;
+};
+
 // System class that manages all animated object.
 class AnimationManager {
  private:
   static util::IntrusiveList<Animation> animating_objects;
+  static util::IntrusiveList<AnimationUpdateListener> update_listeners;
   static int block_animations_counter;
 
  public:
   // Updates all running animations.
+  // Progress of all animations running at the start of the update is computed
+  // in one batch, grouped by animation curve, before any of them is notified.
   static void Update();
 
+  // Adds a listener that is notified around each Update that has running
+  // animations.
+  static void AddUpdateListener(AnimationUpdateListener* listener);
+  static void RemoveUpdateListener(AnimationUpdateListener* listener);
+
   // Returns true if there is running animations.
   static bool has_running_animations();
 
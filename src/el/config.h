@@ -32,6 +32,12 @@
 // keyboard.
 // #define EL_ALWAYS_SHOW_EDIT_FOCUS
 
+// Enable to allocate elements from a slab allocator instead of the general
+// heap. Elements of popups and menus are created and destroyed often, and this
+// avoids fragmenting the heap over long sessions. Statistics are available in
+// DebugInfo::element_allocator.
+#define EL_POOLED_ELEMENTS
+
 // Enable to support TBBF fonts (Turbo Badger Bitmap Fonts).
 #define EL_FONT_RENDERER_TBBF
 
@@ -45,4 +51,12 @@
 // as long as it compiles.
 // #define EL_FONT_RENDERER_STB
 
+// Enables SSE2 versions of pixel kernels, such as glyph blurring and format
+// conversion. Defined when the compiler targets SSE2 (always the case on x64);
+// portable scalar versions are used otherwise.
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define EL_SIMD_SSE2
+#endif
+
 #endif  // EL_CONFIG_H_
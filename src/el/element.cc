@@ -7,7 +7,9 @@
  ******************************************************************************
  */
 
+#include <algorithm>
 #include <cstdarg>
+#include <vector>
 
 #include "el/element.h"
 #include "el/element_listener.h"
@@ -16,6 +18,7 @@
 #include "el/elements/tab_container.h"
 #include "el/elements/text_box.h"
 #include "el/event_handler.h"
+#include "el/frame_scheduler.h"
 #include "el/graphics/renderer.h"
 #include "el/list_item.h"
 #include "el/parsing/element_inflater.h"
@@ -24,6 +27,7 @@
 #include "el/util/debug.h"
 #include "el/util/math.h"
 #include "el/util/metrics.h"
+#include "el/util/slab_allocator.h"
 #include "el/util/string.h"
 #include "el/value.h"
 
@@ -43,6 +47,38 @@ bool Element::update_element_states = true;
 bool Element::update_skin_states = true;
 bool Element::show_focus_state = false;
 
+namespace {
+#ifdef EL_POOLED_ELEMENTS
+// Blocks up to this size are pooled, which covers all built-in elements.
+const size_t kMaxPooledElementSize = 2048;
+
+// Leaked so that elements deleted during static destruction can still be
+// freed.
+util::SlabAllocator* element_allocator() {
+  static auto allocator = new util::SlabAllocator(kMaxPooledElementSize);
+  return allocator;
+}
+
+// Depth of nested ~Element calls, and if memory should be released when the
+// outermost element has been freed.
+int delete_depth = 0;
+bool release_memory_after_delete = false;
+
+void UpdateAllocatorDebugInfo() {
+#ifdef EL_RUNTIME_DEBUG_INFO
+  util::DebugInfo::get()->element_allocator = element_allocator()->stats();
+#endif  // EL_RUNTIME_DEBUG_INFO
+}
+#endif  // EL_POOLED_ELEMENTS
+
+// Number of children above which painting builds the child vector.
+const size_t kChildVectorMinChildren = 64;
+
+// Elements invalidated during an invalidate batch, in invalidation order.
+int invalidate_batch_depth = 0;
+std::vector<Element*> pending_invalidations;
+}  // namespace
+
 // One shot timer for long click event.
 class LongClickTimer : private MessageHandler {
  public:
@@ -74,6 +110,17 @@ void Element::RegisterInflater() {
 Element::Element() = default;
 
 Element::~Element() {
+#ifdef EL_POOLED_ELEMENTS
+  ++delete_depth;
+#endif  // EL_POOLED_ELEMENTS
+  if (m_packed.is_invalidate_pending) {
+    // Usually the most recently invalidated element, so search from the back.
+    auto it = std::find(pending_invalidations.rbegin(),
+                        pending_invalidations.rend(), this);
+    assert(it != pending_invalidations.rend());
+    *it = nullptr;
+  }
+
   // A element must be removed from parent before deleted.
   RemoveFromParent();
   assert(!m_parent);
@@ -89,6 +136,7 @@ Element::~Element() {
     focused_element = nullptr;
   }
 
+  WeakElementPointer::ReleaseSlot(this);
   ElementListener::InvokeElementDelete(this);
   DeleteAllChildren();
 
@@ -96,6 +144,39 @@ Element::~Element() {
 
   assert(!m_listeners
               .HasLinks());  // There's still listeners added to this element!
+#ifdef EL_POOLED_ELEMENTS
+  --delete_depth;
+#endif  // EL_POOLED_ELEMENTS
+}
+
+#ifdef EL_POOLED_ELEMENTS
+void* Element::operator new(size_t size) {
+  void* ptr = element_allocator()->Allocate(size);
+  UpdateAllocatorDebugInfo();
+  return ptr;
+}
+
+void Element::operator delete(void* ptr, size_t size) {
+  element_allocator()->Free(ptr, size);
+  if (!delete_depth && release_memory_after_delete) {
+    release_memory_after_delete = false;
+    element_allocator()->Trim();
+  }
+  UpdateAllocatorDebugInfo();
+}
+#endif  // EL_POOLED_ELEMENTS
+
+void Element::ReleaseUnusedMemory() {
+#ifdef EL_POOLED_ELEMENTS
+  element_allocator()->Trim();
+  UpdateAllocatorDebugInfo();
+#endif  // EL_POOLED_ELEMENTS
+}
+
+void Element::ReleaseUnusedMemoryAfterDelete() {
+#ifdef EL_POOLED_ELEMENTS
+  release_memory_after_delete = true;
+#endif  // EL_POOLED_ELEMENTS
 }
 
 bool Element::LoadFile(const char* filename) {
@@ -292,11 +373,43 @@ void Element::Invalidate() {
   if (!computed_visibility() && !m_rect.empty()) {
     return;
   }
+  if (invalidate_batch_depth) {
+    // Visibility is checked above so that invalidating before hiding still
+    // repaints when the batch ends.
+    if (!m_packed.is_invalidate_pending) {
+      m_packed.is_invalidate_pending = true;
+      pending_invalidations.push_back(this);
+    }
+    return;
+  }
   Element* tmp = this;
   while (tmp) {
     tmp->OnInvalid();
     tmp = tmp->m_parent;
   }
+  FrameScheduler::RequestFrame(FrameSource::kInvalidation);
+}
+
+void Element::BeginInvalidateBatch() { ++invalidate_batch_depth; }
+
+void Element::EndInvalidateBatch() {
+  assert(invalidate_batch_depth > 0);
+  if (--invalidate_batch_depth) {
+    return;
+  }
+  // OnInvalid may invalidate other elements, which then go straight through.
+  for (size_t i = 0; i < pending_invalidations.size(); ++i) {
+    Element* element = pending_invalidations[i];
+    if (!element) {
+      continue;  // Deleted during the batch.
+    }
+    element->m_packed.is_invalidate_pending = false;
+    for (Element* tmp = element; tmp; tmp = tmp->m_parent) {
+      tmp->OnInvalid();
+    }
+    FrameScheduler::RequestFrame(FrameSource::kInvalidation);
+  }
+  pending_invalidations.clear();
 }
 
 void Element::InvalidateStates() {
@@ -504,6 +617,8 @@ void Element::AddChildRelative(Element* child, ElementZRel z,
     }
   }
 
+  OnChildVectorAdd(child);
+
   if (info == InvokeInfo::kNormal) {
     OnChildAdded(child);
     child->OnAdded();
@@ -529,6 +644,7 @@ void Element::RemoveChild(Element* child, InvokeInfo info) {
     ElementListener::InvokeElementRemove(this, child);
   }
 
+  OnChildVectorRemove(child);
   m_children.Remove(child);
   child->m_parent = nullptr;
 
@@ -875,44 +991,72 @@ Element* Element::GetElementAt(int x, int y, bool include_children) const {
   x -= child_translation_x;
   y -= child_translation_y;
 
-  Element* tmp = first_child();
-  Element* last_match = nullptr;
-  while (tmp) {
+  // The last hit child is on top, so search backwards and stop at the first
+  // hit.
+  for (Element* tmp = last_child(); tmp; tmp = tmp->GetPrev()) {
     HitStatus hit_status =
         tmp->GetHitStatus(x - tmp->m_rect.x, y - tmp->m_rect.y);
-    if (hit_status != HitStatus::kNoHit) {
-      if (include_children && hit_status != HitStatus::kHitNoChildren) {
-        last_match = tmp->GetElementAt(x - tmp->m_rect.x, y - tmp->m_rect.y,
-                                       include_children);
-        if (!last_match) {
-          last_match = tmp;
-        }
-      } else {
-        last_match = tmp;
+    if (hit_status == HitStatus::kNoHit) {
+      continue;
+    }
+    if (include_children && hit_status != HitStatus::kHitNoChildren) {
+      if (Element* match = tmp->GetElementAt(
+              x - tmp->m_rect.x, y - tmp->m_rect.y, include_children)) {
+        return match;
       }
     }
-    tmp = tmp->GetNext();
+    return tmp;
   }
-  return last_match;
+  return nullptr;
 }
 
 Element* Element::GetChildFromIndex(int index) const {
-  int i = 0;
-  for (Element* child = first_child(); child; child = child->GetNext()) {
-    if (i++ == index) return child;
+  EnsureChildVector();
+  if (index < 0 || size_t(index) >= m_child_vector->size()) {
+    return nullptr;
   }
-  return nullptr;
+  return (*m_child_vector)[index];
 }
 
 int Element::GetIndexFromChild(Element* child) const {
   assert(child->parent() == this);
-  int i = 0;
-  for (Element *tmp = first_child(); tmp; tmp = tmp->GetNext(), ++i) {
-    if (tmp == child) {
-      return i;
-    }
+  EnsureChildVector();
+  return int(child->m_child_index);
+}
+
+void Element::EnsureChildVector() const {
+  if (m_child_vector) {
+    return;
+  }
+  m_child_vector = std::make_unique<std::vector<Element*>>();
+  for (Element* child = first_child(); child; child = child->GetNext()) {
+    child->m_child_index = uint32_t(m_child_vector->size());
+    m_child_vector->push_back(child);
+  }
+}
+
+void Element::OnChildVectorAdd(Element* child) {
+  if (!m_child_vector) {
+    return;
+  }
+  if (child == last_child()) {
+    // Appending is the common case and keeps all other indices.
+    child->m_child_index = uint32_t(m_child_vector->size());
+    m_child_vector->push_back(child);
+  } else {
+    m_child_vector.reset();
+  }
+}
+
+void Element::OnChildVectorRemove(Element* child) {
+  if (!m_child_vector) {
+    return;
+  }
+  if (child == last_child()) {
+    m_child_vector->pop_back();
+  } else {
+    m_child_vector.reset();
   }
-  return -1;  // Should not happen!
 }
 
 bool Element::IsAncestorOf(Element* other_element) const {
@@ -993,15 +1137,21 @@ void Element::OnPaintChildren(const PaintProps& paint_props) {
   Rect clip_rect = Renderer::get()->clip_rect();
 
   // Invoke paint on all children that are in the current visible rect.
-  for (Element* child = first_child(); child; child = child->GetNext()) {
+  size_t child_count = 0;
+  ForEachChild([&](Element* child) {
+    ++child_count;
     if (clip_rect.intersects(child->m_rect)) {
       child->InvokePaint(paint_props);
     }
+  });
+  // Traverse wide trees through the contiguous child vector from now on.
+  if (child_count >= kChildVectorMinChildren) {
+    EnsureChildVector();
   }
 
   // Invoke paint of overlay elements on all children that are in the current
   // visible rect.
-  for (Element* child = first_child(); child; child = child->GetNext()) {
+  ForEachChild([&](Element* child) {
     if (clip_rect.intersects(child->m_rect) &&
         child->visibility() == Visibility::kVisible) {
       auto skin_element = child->background_skin_element();
@@ -1023,7 +1173,7 @@ void Element::OnPaintChildren(const PaintProps& paint_props) {
         }
       }
     }
-  }
+  });
 
   // Draw generic focus skin if the focused element is one of the children, and
   // the skin doesn't have a skin state for focus which would already be
@@ -1300,6 +1450,7 @@ void Element::InvalidateLayout(InvalidationMode il) {
   if (visibility() == Visibility::kGone) {
     return;
   }
+  FrameScheduler::RequestFrame(FrameSource::kLayout);
   Invalidate();
   if (il == InvalidationMode::kRecursive && m_parent) {
     m_parent->InvalidateLayout(il);
@@ -1465,7 +1616,7 @@ bool Element::InvokeEvent(Event ev) {
 
   if (ev.type == EventType::kChanged) {
     InvalidateSkinStates();
-    m_connection.SyncFromElement(this);
+    m_connection.SyncFromElement(this, ev.text_change);
   }
 
   if (!this_element.get()) {
@@ -275,6 +275,23 @@ class Element : public util::TypedObject,
   Element();
   virtual ~Element();
 
+#ifdef EL_POOLED_ELEMENTS
+  // Elements of all types are allocated from a shared slab allocator.
+  static void* operator new(size_t size);
+  static void operator delete(void* ptr, size_t size);
+#endif  // EL_POOLED_ELEMENTS
+
+  // Returns memory held for deleted elements to the system. This is done
+  // automatically when a form is deleted.
+  static void ReleaseUnusedMemory();
+
+ protected:
+  // Calls ReleaseUnusedMemory when the element currently being deleted, and
+  // all its children, have been freed. Called from destructors.
+  static void ReleaseUnusedMemoryAfterDelete();
+
+ public:
+
   bool LoadFile(const char* filename);
   bool LoadData(const char* data_str, size_t data_length = std::string::npos);
   bool LoadData(std::string data_str) {
@@ -311,6 +328,13 @@ class Element : public util::TypedObject,
   // sure the renderer repaints it and its children next frame.
   void Invalidate();
 
+  // Begins a period during which Invalidate only records the element, so that
+  // an element invalidated many times is invalidated once when the period is
+  // ended with EndInvalidateBatch. Batches may be nested.
+  static void BeginInvalidateBatch();
+  // Ends a period started with BeginInvalidateBatch.
+  static void EndInvalidateBatch();
+
   // Call if something changes that might need other elements to update their
   // state.
   // F.ex if a action availability changes, some element might have to become
@@ -582,8 +606,9 @@ class Element : public util::TypedObject,
 
   // Gets the child index of the given element (that must be a child of this
   // element).
-  // NOTE: avoid calling this in loops since it does iteration. Consider
-  // iterating the elements directly instead!
+  // Index lookups are constant time once the child vector has been built,
+  // which happens on the first lookup after children have been inserted or
+  // removed anywhere but at the end.
   int GetIndexFromChild(Element* child) const;
 
   // Gets the text of a child element with the given id, or an empty string if
@@ -1037,6 +1062,7 @@ class Element : public util::TypedObject,
 
  private:
   friend class ElementListener;
+  friend class WeakElementPointer;
   Element* m_parent = nullptr;
   TBID m_id;                // ID for GetElementById and others.
   TBID m_group_id;          // ID for button groups (such as RadioButton)
@@ -1047,6 +1073,12 @@ class Element : public util::TypedObject,
   // The rectangle of this element, relative to the parent. See set_rect.
   Rect m_rect;
   util::IntrusiveList<Element> m_children;
+  // Children in the same order as m_children, for constant time index lookups
+  // and contiguous traversal of wide trees. Built on demand and dropped when
+  // children are inserted or removed anywhere but at the end.
+  mutable std::unique_ptr<std::vector<Element*>> m_child_vector;
+  // Index of this element in m_parent->m_child_vector, if that exists.
+  mutable uint32_t m_child_index = 0;
   ElementValueConnection m_connection;
   util::IntrusiveList<ElementListener> m_listeners;
   util::IntrusiveList<EventHandler> event_handlers_;
@@ -1062,6 +1094,8 @@ class Element : public util::TypedObject,
   std::unique_ptr<elements::parts::Scroller> m_scroller;
   std::unique_ptr<LongClickTimer> m_long_click_timer;
   std::string m_tooltip_str;
+  // Slot used by WeakElementPointer, or 0 if none has been created.
+  uint32_t m_weak_slot = 0;
   union {
     struct {
       uint16_t is_group_root : 1;
@@ -1077,6 +1111,7 @@ class Element : public util::TypedObject,
       uint16_t visibility : 2;
       uint16_t inflate_child_z : 1;  // Should have enough bits to hold ElementZ
                                      // values.
+      uint16_t is_invalidate_pending : 1;
     } m_packed;
     uint16_t m_packed_init = 0;
   };
@@ -1140,6 +1175,27 @@ class Element : public util::TypedObject,
   // Returns the opacity for this element multiplied with its skin opacity and
   // state opacity.
   float CalculateOpacityInternal(State state, SkinElement* skin_element) const;
+  // Builds m_child_vector if it isn't already.
+  void EnsureChildVector() const;
+  // Updates m_child_vector for a child just added to or about to be removed
+  // from m_children.
+  void OnChildVectorAdd(Element* child);
+  void OnChildVectorRemove(Element* child);
+  // Calls fn with each child in order, using the child vector if built.
+  // Children must not be inserted or removed during the iteration (appending
+  // is safe, and other changes end it early).
+  template <typename F>
+  void ForEachChild(F fn) const {
+    if (m_child_vector) {
+      for (size_t i = 0; m_child_vector && i < m_child_vector->size(); ++i) {
+        fn((*m_child_vector)[i]);
+      }
+    } else {
+      for (Element* child = first_child(); child; child = child->GetNext()) {
+        fn(child);
+      }
+    }
+  }
 };
 
 // Gets this element or any child element with a matching id, or nullptr if
@@ -1155,6 +1211,7 @@ class ElementSkinConditionContext : public SkinConditionContext {
   explicit ElementSkinConditionContext(Element* element) : m_element(element) {}
   bool GetCondition(SkinTarget target,
                     const SkinCondition::ConditionInfo& info) const override;
+  const void* memo_key() const override { return m_element; }
 
  private:
   bool GetCondition(Element* element,
@@ -18,6 +18,20 @@ using el::util::SafeCast;
 
 extern util::IntrusiveList<ElementAnimation> element_animations;
 
+namespace {
+
+// Free list of element animation allocations, sized for the largest built-in
+// animation. Blocks are never returned to the system.
+union AnimationBlock {
+  AnimationBlock* next_free;
+  alignas(OpacityElementAnimation) char o[sizeof(OpacityElementAnimation)];
+  alignas(RectElementAnimation) char r[sizeof(RectElementAnimation)];
+};
+AnimationBlock* g_free_animation_blocks = nullptr;
+const size_t kAnimationBlocksPerChunk = 64;
+
+}  // namespace
+
 inline float Lerp(float src, float dst, float progress) {
   return src + (dst - src) * progress;
 }
@@ -30,6 +44,35 @@ ElementAnimation::ElementAnimation(Element* element) : m_element(element) {
 
 ElementAnimation::~ElementAnimation() { element_animations.Remove(this); }
 
+void* ElementAnimation::operator new(size_t size) {
+  if (size > sizeof(AnimationBlock)) {
+    return ::operator new(size);
+  }
+  if (!g_free_animation_blocks) {
+    auto chunk = new AnimationBlock[kAnimationBlocksPerChunk];
+    for (size_t i = 0; i < kAnimationBlocksPerChunk; ++i) {
+      chunk[i].next_free = g_free_animation_blocks;
+      g_free_animation_blocks = &chunk[i];
+    }
+  }
+  AnimationBlock* block = g_free_animation_blocks;
+  g_free_animation_blocks = block->next_free;
+  return block;
+}
+
+void ElementAnimation::operator delete(void* ptr, size_t size) {
+  if (!ptr) {
+    return;
+  }
+  if (size > sizeof(AnimationBlock)) {
+    ::operator delete(ptr);
+    return;
+  }
+  auto block = static_cast<AnimationBlock*>(ptr);
+  block->next_free = g_free_animation_blocks;
+  g_free_animation_blocks = block;
+}
+
 OpacityElementAnimation::OpacityElementAnimation(Element* element,
                                                  float src_opacity,
                                                  float dst_opacity, bool die)
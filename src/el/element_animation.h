@@ -33,6 +33,11 @@ class ElementAnimation : public Animation,
   explicit ElementAnimation(Element* element);
   ~ElementAnimation() override;
 
+  // Element animations are short lived and often started in bulk, so the
+  // built-in ones are allocated from a free list.
+  static void* operator new(size_t size);
+  static void operator delete(void* ptr, size_t size);
+
  public:
   Element* m_element;
 };
@@ -24,10 +24,15 @@ ElementAnimationManager elements_animation_manager;
 
 void ElementAnimationManager::Init() {
   assert(!element_animations.HasLinks());
-  ElementListener::AddGlobalListener(&elements_animation_manager);
+  ElementListener::AddGlobalListener(
+      &elements_animation_manager,
+      ElementListenerEvents::kDelete | ElementListenerEvents::kDying |
+          ElementListenerEvents::kAdded | ElementListenerEvents::kRemove);
+  AnimationManager::AddUpdateListener(&elements_animation_manager);
 }
 
 void ElementAnimationManager::Shutdown() {
+  AnimationManager::RemoveUpdateListener(&elements_animation_manager);
   ElementListener::RemoveGlobalListener(&elements_animation_manager);
   assert(!element_animations.HasLinks());
 }
@@ -108,4 +113,12 @@ void ElementAnimationManager::OnElementAdded(Element* parent,
 void ElementAnimationManager::OnElementRemove(Element* parent,
                                               Element* element) {}
 
+void ElementAnimationManager::OnAnimationsUpdateBegin() {
+  Element::BeginInvalidateBatch();
+}
+
+void ElementAnimationManager::OnAnimationsUpdateEnd() {
+  Element::EndInvalidateBatch();
+}
+
 }  // namespace el
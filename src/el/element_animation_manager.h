@@ -10,11 +10,16 @@
 #ifndef EL_ELEMENT_ANIMATION_MANAGER_H_
 #define EL_ELEMENT_ANIMATION_MANAGER_H_
 
+#include "el/animation_manager.h"
 #include "el/element_listener.h"
 
 namespace el {
 
-class ElementAnimationManager : public ElementListener {
+// Starts the default element animations (such as fading forms in and out) and
+// batches repaint invalidation so every animated element is invalidated once
+// per AnimationManager::Update.
+class ElementAnimationManager : public ElementListener,
+                                public AnimationUpdateListener {
  public:
   static void Init();
   static void Shutdown();
@@ -34,6 +39,9 @@ class ElementAnimationManager : public ElementListener {
   bool OnElementDying(Element* element) override;
   void OnElementAdded(Element* parent, Element* child) override;
   void OnElementRemove(Element* parent, Element* child) override;
+
+  void OnAnimationsUpdateBegin() override;
+  void OnAnimationsUpdateEnd() override;
 };
 
 }  // namespace el
@@ -7,112 +7,220 @@
  ******************************************************************************
  */
 
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
 #include "el/element.h"
 #include "el/element_listener.h"
 
 namespace el {
 
-util::IntrusiveList<ElementListenerGlobalLink> g_listeners;
+namespace {
+
+const int kEventTypeCount = 6;
+
+// Global listeners for each callback type, indexed by the bit position in
+// ElementListenerEvents.
+// Removed listeners are nulled and only erased once no dispatch is running, so
+// dispatch can walk the arrays by index while callbacks add or remove
+// listeners.
+std::vector<ElementListener*> g_listeners[kEventTypeCount];
+int g_dispatch_depth = 0;
+bool g_has_removed_listeners = false;
+
+int EventTypeIndex(ElementListenerEvents event) {
+  int index = 0;
+  while (static_cast<uint32_t>(event) >> (index + 1)) {
+    ++index;
+  }
+  return index;
+}
+
+void CompactListeners() {
+  for (auto& listeners : g_listeners) {
+    listeners.erase(std::remove(listeners.begin(), listeners.end(), nullptr),
+                    listeners.end());
+  }
+  g_has_removed_listeners = false;
+}
 
-void ElementListener::AddGlobalListener(ElementListener* listener) {
-  g_listeners.AddLast(listener);
+// Invokes fn for each global listener subscribed to event.
+template <typename T>
+void DispatchGlobal(ElementListenerEvents event, T fn) {
+  auto& listeners = g_listeners[EventTypeIndex(event)];
+  if (listeners.empty()) {
+    return;
+  }
+  ++g_dispatch_depth;
+  // Listeners added during dispatch are appended and won't be visited.
+  size_t count = listeners.size();
+  for (size_t i = 0; i < count; ++i) {
+    if (ElementListener* listener = listeners[i]) {
+      fn(listener);
+    }
+  }
+  if (!--g_dispatch_depth && g_has_removed_listeners) {
+    CompactListeners();
+  }
+}
+
+}  // namespace
+
+void ElementListener::AddGlobalListener(ElementListener* listener,
+                                        ElementListenerEvents events) {
+  for (int i = 0; i < kEventTypeCount; ++i) {
+    if (any(events & static_cast<ElementListenerEvents>(1 << i))) {
+      auto& listeners = g_listeners[i];
+      assert(std::find(listeners.begin(), listeners.end(), listener) ==
+             listeners.end());
+      listeners.push_back(listener);
+    }
+  }
 }
 
 void ElementListener::RemoveGlobalListener(ElementListener* listener) {
-  g_listeners.Remove(listener);
+  for (auto& listeners : g_listeners) {
+    auto it = std::find(listeners.begin(), listeners.end(), listener);
+    if (it == listeners.end()) {
+      continue;
+    }
+    if (g_dispatch_depth) {
+      *it = nullptr;
+      g_has_removed_listeners = true;
+    } else {
+      listeners.erase(it);
+    }
+  }
 }
 
 void ElementListener::InvokeElementDelete(Element* element) {
-  auto global_i = g_listeners.IterateForward();
   auto local_i = element->m_listeners.IterateForward();
   while (ElementListener* listener = local_i.GetAndStep()) {
     listener->OnElementDelete(element);
   }
-  while (ElementListenerGlobalLink* link = global_i.GetAndStep()) {
-    static_cast<ElementListener*>(link)->OnElementDelete(element);
-  }
+  DispatchGlobal(ElementListenerEvents::kDelete,
+                 [&](ElementListener* listener) {
+                   listener->OnElementDelete(element);
+                 });
 }
 
 bool ElementListener::InvokeElementDying(Element* element) {
   bool handled = false;
-  auto global_i = g_listeners.IterateForward();
   auto local_i = element->m_listeners.IterateForward();
   while (ElementListener* listener = local_i.GetAndStep()) {
     handled |= listener->OnElementDying(element);
   }
-  while (ElementListenerGlobalLink* link = global_i.GetAndStep()) {
-    handled |= static_cast<ElementListener*>(link)->OnElementDying(element);
-  }
+  DispatchGlobal(ElementListenerEvents::kDying,
+                 [&](ElementListener* listener) {
+                   handled |= listener->OnElementDying(element);
+                 });
   return handled;
 }
 
 void ElementListener::InvokeElementAdded(Element* parent, Element* child) {
-  auto global_i = g_listeners.IterateForward();
   auto local_i = parent->m_listeners.IterateForward();
   while (ElementListener* listener = local_i.GetAndStep()) {
     listener->OnElementAdded(parent, child);
   }
-  while (ElementListenerGlobalLink* link = global_i.GetAndStep()) {
-    static_cast<ElementListener*>(link)->OnElementAdded(parent, child);
-  }
+  DispatchGlobal(ElementListenerEvents::kAdded,
+                 [&](ElementListener* listener) {
+                   listener->OnElementAdded(parent, child);
+                 });
 }
 
 void ElementListener::InvokeElementRemove(Element* parent, Element* child) {
-  auto global_i = g_listeners.IterateForward();
   auto local_i = parent->m_listeners.IterateForward();
   while (ElementListener* listener = local_i.GetAndStep()) {
     listener->OnElementRemove(parent, child);
   }
-  while (ElementListenerGlobalLink* link = global_i.GetAndStep()) {
-    static_cast<ElementListener*>(link)->OnElementRemove(parent, child);
-  }
+  DispatchGlobal(ElementListenerEvents::kRemove,
+                 [&](ElementListener* listener) {
+                   listener->OnElementRemove(parent, child);
+                 });
 }
 
 void ElementListener::InvokeElementFocusChanged(Element* element,
                                                 bool focused) {
-  auto global_i = g_listeners.IterateForward();
   auto local_i = element->m_listeners.IterateForward();
   while (ElementListener* listener = local_i.GetAndStep()) {
     listener->OnElementFocusChanged(element, focused);
   }
-  while (ElementListenerGlobalLink* link = global_i.GetAndStep()) {
-    static_cast<ElementListener*>(link)
-        ->OnElementFocusChanged(element, focused);
-  }
+  DispatchGlobal(ElementListenerEvents::kFocusChanged,
+                 [&](ElementListener* listener) {
+                   listener->OnElementFocusChanged(element, focused);
+                 });
 }
 
 bool ElementListener::InvokeElementInvokeEvent(Element* element,
                                                const Event& ev) {
   bool handled = false;
-  auto global_i = g_listeners.IterateForward();
   auto local_i = element->m_listeners.IterateForward();
   while (ElementListener* listener = local_i.GetAndStep()) {
     handled |= listener->OnElementInvokeEvent(element, ev);
   }
-  while (ElementListenerGlobalLink* link = global_i.GetAndStep()) {
-    handled |=
-        static_cast<ElementListener*>(link)->OnElementInvokeEvent(element, ev);
-  }
+  DispatchGlobal(ElementListenerEvents::kInvokeEvent,
+                 [&](ElementListener* listener) {
+                   handled |= listener->OnElementInvokeEvent(element, ev);
+                 });
   return handled;
 }
 
+namespace {
+struct WeakSlot {
+  Element* element;
+  uint32_t generation;
+  uint32_t next_free;
+};
+
+// Slot 0 is never used so that 0 can mean no slot. Intentionally leaked so it
+// outlives any statically allocated elements.
+std::vector<WeakSlot>& weak_slots() {
+  static auto slots = new std::vector<WeakSlot>(1);
+  return *slots;
+}
+uint32_t g_first_free_weak_slot = 0;
+}  // namespace
+
 void WeakElementPointer::reset(Element* element) {
-  if (m_element == element) {
+  if (!element) {
+    m_slot = 0;
+    m_generation = 0;
     return;
   }
-  if (m_element) {
-    m_element->RemoveListener(this);
-  }
-  m_element = element;
-  if (m_element) {
-    m_element->AddListener(this);
+  auto& slots = weak_slots();
+  if (!element->m_weak_slot) {
+    if (g_first_free_weak_slot) {
+      element->m_weak_slot = g_first_free_weak_slot;
+      g_first_free_weak_slot = slots[g_first_free_weak_slot].next_free;
+    } else {
+      element->m_weak_slot = static_cast<uint32_t>(slots.size());
+      slots.push_back({nullptr, 0, 0});
+    }
+    slots[element->m_weak_slot].element = element;
+  }
+  m_slot = element->m_weak_slot;
+  m_generation = slots[m_slot].generation;
+}
+
+Element* WeakElementPointer::get() const {
+  if (!m_slot) {
+    return nullptr;
   }
+  const WeakSlot& slot = weak_slots()[m_slot];
+  return slot.generation == m_generation ? slot.element : nullptr;
 }
 
-void WeakElementPointer::OnElementDelete(Element* element) {
-  if (element == m_element) {
-    reset(nullptr);
+void WeakElementPointer::ReleaseSlot(Element* element) {
+  if (!element->m_weak_slot) {
+    return;
   }
+  WeakSlot& slot = weak_slots()[element->m_weak_slot];
+  slot.element = nullptr;
+  ++slot.generation;
+  slot.next_free = g_first_free_weak_slot;
+  g_first_free_weak_slot = element->m_weak_slot;
+  element->m_weak_slot = 0;
 }
 
 }  // namespace el
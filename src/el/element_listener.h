@@ -10,6 +10,9 @@
 #ifndef EL_ELEMENT_LISTENER_H_
 #define EL_ELEMENT_LISTENER_H_
 
+#include <cstdint>
+
+#include "el/types.h"
 #include "el/util/intrusive_list.h"
 
 namespace el {
@@ -17,21 +20,34 @@ namespace el {
 class Element;
 class Event;
 
-// Should never be created or subclassed anywhere except in ElementListener.
-// It's only purpose is to add a extra typed link for ElementListener, since it
-// needs to be added in multiple lists.
-class ElementListenerGlobalLink
-    : public util::IntrusiveListEntry<ElementListenerGlobalLink> {};
+// Callbacks a global ElementListener subscribes to.
+// Global listeners are only invoked for the callbacks they subscribed to, so
+// listeners should subscribe to exactly the callbacks they override.
+enum class ElementListenerEvents {
+  kNone = 0,
+  kDelete = 1 << 0,        // OnElementDelete
+  kDying = 1 << 1,         // OnElementDying
+  kAdded = 1 << 2,         // OnElementAdded
+  kRemove = 1 << 3,        // OnElementRemove
+  kFocusChanged = 1 << 4,  // OnElementFocusChanged
+  kInvokeEvent = 1 << 5,   // OnElementInvokeEvent
+
+  kAll = kDelete | kDying | kAdded | kRemove | kFocusChanged | kInvokeEvent,
+};
+MAKE_ENUM_FLAG_COMBO(ElementListenerEvents);
 
 // Listens to some callbacks from Element.
 // It may either listen to all elements globally, or one specific element.
 // Local listeners (added with Element:AddListener) will be invoked before
 // global listeners (added with ElementListener::AddGlobalListener).
-class ElementListener : public util::IntrusiveListEntry<ElementListener>,
-                        public ElementListenerGlobalLink {
+class ElementListener : public util::IntrusiveListEntry<ElementListener> {
  public:
-  // Adds a listener to all elements.
-  static void AddGlobalListener(ElementListener* listener);
+  // Adds a listener to all elements, invoked only for the given callbacks.
+  // Listeners may be added and removed from within callbacks. Listeners added
+  // during a callback are not invoked until the next one.
+  static void AddGlobalListener(
+      ElementListener* listener,
+      ElementListenerEvents events = ElementListenerEvents::kAll);
   static void RemoveGlobalListener(ElementListener* listener);
 
   // Called when element is being deleted (in its destructor, so virtual
@@ -82,24 +98,33 @@ class ElementListener : public util::IntrusiveListEntry<ElementListener>,
 
 // Keeps a pointer to a element that will be set to nullptr if the element is
 // removed.
-class WeakElementPointer : private ElementListener {
+//
+// This is a handle into a table of slots shared by all weak pointers. An
+// element gets a slot the first time a weak pointer to it is created, and the
+// slot generation is bumped when the element is deleted, which invalidates all
+// handles to it. Creating, copying and destroying weak pointers doesn't touch
+// the element listener lists.
+class WeakElementPointer {
  public:
   WeakElementPointer() = default;
   explicit WeakElementPointer(Element* element) { reset(element); }
-  ~WeakElementPointer() { reset(nullptr); }
 
   // Sets the element pointer that should be nulled if deleted.
   void reset(Element* element = nullptr);
 
   // Returns the element, or nullptr if it has been deleted.
-  Element* get() const { return m_element; }
+  Element* get() const;
 
-  operator bool() { return m_element != nullptr; }
+  operator bool() const { return get() != nullptr; }
 
  private:
-  void OnElementDelete(Element* element) override;
+  friend class Element;
+
+  // Invalidates all weak pointers to the element and frees its slot.
+  static void ReleaseSlot(Element* element);
 
-  Element* m_element = nullptr;
+  uint32_t m_slot = 0;  // 0 for no element.
+  uint32_t m_generation = 0;
 };
 
 }  // namespace el
@@ -30,9 +30,10 @@ void ElementValueConnection::Disconnect() {
   m_element = nullptr;
 }
 
-void ElementValueConnection::SyncFromElement(Element* source_element) {
+void ElementValueConnection::SyncFromElement(Element* source_element,
+                                             const TextChange* text_change) {
   if (m_value) {
-    m_value->SetFromElement(source_element);
+    m_value->SetFromElement(source_element, text_change);
   }
 }
 
@@ -45,7 +46,8 @@ ElementValue::~ElementValue() {
   }
 }
 
-void ElementValue::SetFromElement(Element* source_element) {
+void ElementValue::SetFromElement(Element* source_element,
+                                  const TextChange* text_change) {
   if (m_syncing) {
     // We ended up here because syncing is in progress.
     return;
@@ -53,9 +55,34 @@ void ElementValue::SetFromElement(Element* source_element) {
 
   // Get the value in the format.
   switch (m_value.type()) {
-    case Value::Type::kString:
-      m_value.set_string(source_element->text());
+    case Value::Type::kString: {
+      // The change only applies to our text if we were synced with the text
+      // it was made to, and nothing changed either of them since.
+      ElementValueConnection* connection = nullptr;
+      for (ElementValueConnection* c = m_connections.GetFirst(); c;
+           c = c->GetNext()) {
+        if (c->m_element == source_element) {
+          connection = c;
+          break;
+        }
+      }
+      if (text_change && !text_change->replaced_all && connection &&
+          connection->m_text_version == m_text_version &&
+          connection->m_text_sequence + 1 == text_change->sequence &&
+          text_change->offset + text_change->removed_length <= m_text.size()) {
+        m_text.replace(text_change->offset, text_change->removed_length,
+                       text_change->inserted_text);
+      } else {
+        m_text = source_element->text();
+      }
+      ++m_text_version;
+      if (connection && text_change) {
+        connection->m_text_sequence = text_change->sequence;
+        connection->m_text_version = m_text_version;
+      }
+      m_value_stale = true;
       break;
+    }
     case Value::Type::kNull:
     case Value::Type::kInt:
       m_value.set_integer(source_element->value());
@@ -93,7 +120,7 @@ void ElementValue::SyncToElement(Element* dst_element) {
   m_syncing = true;
   switch (m_value.type()) {
     case Value::Type::kString:
-      dst_element->set_text(m_value.as_string());
+      dst_element->set_text(m_text);
       break;
     case Value::Type::kNull:
     case Value::Type::kInt:
@@ -112,20 +139,40 @@ void ElementValue::SyncToElement(Element* dst_element) {
 
 void ElementValue::set_integer(int value) {
   m_value.set_integer(value);
+  m_value_stale = false;
   SyncToElements(nullptr);
 }
 
 void ElementValue::set_text(const char* text) {
   m_value.set_string(text, Value::Set::kNewCopy);
+  m_text = text;
+  ++m_text_version;
+  m_value_stale = false;
   SyncToElements(nullptr);
 }
 
 void ElementValue::set_double(double value) {
   // FIX: Value should use double instead of float?
   m_value.set_float(static_cast<float>(value));
+  m_value_stale = false;
   SyncToElements(nullptr);
 }
 
+std::string ElementValue::text() {
+  if (m_value.type() == Value::Type::kString) {
+    return m_text;
+  }
+  return m_value.as_string();
+}
+
+const Value& ElementValue::value() const {
+  if (m_value_stale) {
+    m_value.set_string(m_text);
+    m_value_stale = false;
+  }
+  return m_value;
+}
+
 ElementValue* ElementValueGroup::CreateValueIfNeeded(const TBID& name,
                                                      Value::Type type) {
   if (auto existing_value = GetValue(name)) {
@@ -14,6 +14,7 @@
 #include <string>
 #include <unordered_map>
 
+#include "el/event.h"
 #include "el/id.h"
 #include "el/util/intrusive_list.h"
 #include "el/value.h"
@@ -38,13 +39,20 @@ class ElementValueConnection
   void Disconnect();
 
   // Synchronizes the value of the element to the ElementValue and all other
-  // connected elements.
-  void SyncFromElement(Element* source_element);
+  // connected elements. If text_change is given only the changed range of
+  // the text is fetched (see Event::text_change).
+  void SyncFromElement(Element* source_element,
+                       const TextChange* text_change = nullptr);
 
  private:
   friend class ElementValue;
   ElementValue* m_value = nullptr;
   Element* m_element = nullptr;
+  // The TextChange::sequence of the element text and the text version of the
+  // value when they were last known to be equal. A version of 0 is never
+  // equal.
+  uint32_t m_text_sequence = 0;
+  uint32_t m_text_version = 0;
 };
 
 // Stores a Value that will be synchronized with all elements connected to it.
@@ -81,12 +89,16 @@ class ElementValue {
   void set_double(double value);
 
   // Sets the value from the given element. Using the current format type.
-  void SetFromElement(Element* source_element);
+  // For string values a text_change describing the edit of the element text
+  // lets the stored text be patched instead of copied, if the value was
+  // synced with the text the change was made to.
+  void SetFromElement(Element* source_element,
+                      const TextChange* text_change = nullptr);
 
-  int as_integer() { return m_value.as_integer(); }
-  std::string text() { return m_value.as_string(); }
-  double as_double() { return m_value.as_float(); }
-  const Value& value() const { return m_value; }
+  int as_integer() { return value().as_integer(); }
+  std::string text();
+  double as_double() { return value().as_float(); }
+  const Value& value() const;
 
  private:
   friend class ElementValueConnection;
@@ -95,7 +107,13 @@ class ElementValue {
   void SyncToElements(Element* exclude_element);
 
   TBID m_name;
-  Value m_value;
+  // Updated from m_text on demand for string values.
+  mutable Value m_value;
+  mutable bool m_value_stale = false;
+  // The text of string values, patched by partial changes.
+  std::string m_text;
+  // Incremented when m_text changes.
+  uint32_t m_text_version = 1;
   util::IntrusiveList<ElementValueConnection> m_connections;
   bool m_syncing = false;
 };
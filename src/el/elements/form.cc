@@ -41,6 +41,10 @@ Form::~Form() {
   title_design_button_.RemoveFromParent();
   title_close_button_.RemoveFromParent();
   title_mover_.RemoveChild(&title_label_);
+
+  // Forms are usually deleted with all their content, so release the memory
+  // of the whole subtree in bulk once it has been deleted.
+  ReleaseUnusedMemoryAfterDelete();
 }
 
 Rect Form::GetResizeToFitContentRect(ResizeFit fit) {
@@ -55,9 +55,13 @@ void ListBox::OnInflate(const parsing::InflateInfo& info) {
   Element::OnInflate(info);
 }
 
-void ListBox::OnSourceChanged() { InvalidateList(); }
+void ListBox::OnSourceChanged() {
+  m_item_index.Reset();
+  InvalidateList();
+}
 
 void ListBox::OnItemChanged(size_t index) {
+  m_item_index.OnItemChanged(m_source, index);
   if (m_list_is_invalid) {
     // We're updating all elements soon.
     return;
@@ -82,28 +86,29 @@ void ListBox::OnItemChanged(size_t index) {
 }
 
 void ListBox::OnItemAdded(size_t index) {
+  m_item_index.OnItemAdded(m_source, index);
   if (m_list_is_invalid) {
     // We're updating all elements soon.
     return;
   }
 
-  // Sorting, filtering etc. makes it messy to handle dynamic addition of items.
-  // Resort to invalidate the entire list (may even be faster anyway)
+  // The item index is already updated, but the item elements are recreated.
   InvalidateList();
 }
 
 void ListBox::OnItemRemoved(size_t index) {
+  m_item_index.OnItemRemoved(index);
   if (m_list_is_invalid) {
     // We're updating all elements soon.
     return;
   }
 
-  // Sorting, filtering etc. makes it messy to handle dynamic addition of items.
-  // Resort to invalidate the entire list (may even be faster anyway)
+  // The item index is already updated, but the item elements are recreated.
   InvalidateList();
 }
 
 void ListBox::OnAllItemsRemoved() {
+  m_item_index.Reset();
   InvalidateList();
   m_value = -1;
 }
@@ -146,29 +151,10 @@ void ListBox::ValidateList() {
     return;
   }
 
-  // Create a sorted list of the items we should include using the current
+  // Get the sorted list of the items we should include using the current
   // filter.
-  std::vector<int> sorted_index;
-  sorted_index.resize(m_source->size());
-
-  // Populate the sorted index list.
-  int num_sorted_items = 0;
-  for (size_t i = 0; i < m_source->size(); ++i) {
-    if (m_filter.empty() || m_source->Filter(i, m_filter)) {
-      sorted_index[num_sorted_items++] = static_cast<int>(i);
-    }
-  }
-
-  // Sort.
-  if (m_source->sort() != Sort::kNone) {
-    std::sort(
-        &sorted_index[0], &sorted_index[0] + num_sorted_items,
-        [&](const int a, const int b) {
-          int value =
-              strcmp(m_source->GetItemString(a), m_source->GetItemString(b));
-          return m_source->sort() == Sort::kDescending ? value > 0 : value < 0;
-        });
-  }
+  const auto& sorted_index = m_item_index.Filter(m_source, m_filter);
+  int num_sorted_items = static_cast<int>(sorted_index.size());
 
   // Show header if we only show a subset of all items.
   if (!m_filter.empty()) {
@@ -183,8 +169,8 @@ void ListBox::ValidateList() {
   }
 
   // Create new items.
-  for (int i = 0; i < num_sorted_items; ++i) {
-    CreateAndAddItemAfter(sorted_index[i], nullptr);
+  for (size_t index : sorted_index) {
+    CreateAndAddItemAfter(index, nullptr);
   }
 
   ListItem(m_value, true);
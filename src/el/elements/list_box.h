@@ -105,6 +105,7 @@ class ListBox : public Element, public ListItemObserver {
   GenericStringItemSource m_default_source;
   int m_value = -1;
   std::string m_filter;
+  ListItemIndex m_item_index;
   bool m_list_is_invalid = false;
   bool m_scroll_to_current = false;
   TBID m_header_lng_string_id;
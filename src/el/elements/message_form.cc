@@ -19,7 +19,8 @@ namespace el {
 namespace elements {
 
 MessageForm::MessageForm(Element* target, TBID id) : m_target(target) {
-  ElementListener::AddGlobalListener(this);
+  ElementListener::AddGlobalListener(
+      this, ElementListenerEvents::kDelete | ElementListenerEvents::kDying);
   set_id(id);
 }
 
@@ -24,7 +24,8 @@ ModalForm::ModalForm(std::function<void()> on_close_callback)
   ++visible_count_;
   set_settings(FormSettings::kTitleBar | FormSettings::kCloseButton |
                FormSettings::kCanActivate);
-  el::ElementListener::AddGlobalListener(this);
+  el::ElementListener::AddGlobalListener(
+      this, ElementListenerEvents::kAdded | ElementListenerEvents::kDying);
 }
 
 ModalForm::~ModalForm() {
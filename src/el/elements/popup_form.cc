@@ -72,7 +72,10 @@ Rect PopupAlignment::GetAlignedRect(Element* popup, Element* target) const {
 }
 
 PopupForm::PopupForm(Element* target) : m_target(target) {
-  ElementListener::AddGlobalListener(this);
+  ElementListener::AddGlobalListener(
+      this, ElementListenerEvents::kFocusChanged |
+                ElementListenerEvents::kInvokeEvent |
+                ElementListenerEvents::kDelete | ElementListenerEvents::kDying);
   set_background_skin(TBIDC("PopupForm"), InvokeInfo::kNoCallbacks);
   set_settings(FormSettings::kNone);
 }
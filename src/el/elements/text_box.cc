@@ -11,6 +11,7 @@
 
 #include "el/elements/menu_form.h"
 #include "el/elements/text_box.h"
+#include "el/frame_scheduler.h"
 #include "el/parsing/element_inflater.h"
 #include "el/skin.h"
 #include "el/text/font_face.h"
@@ -303,6 +304,11 @@ bool TextBox::OnEvent(const Event& ev) {
   return Element::OnEvent(ev);
 }
 
+void TextBox::OnProcess() {
+  // Lay out all text appended to the log since the last frame at once.
+  m_style_edit.FlushLog();
+}
+
 void TextBox::OnPaint(const PaintProps& paint_props) {
   Rect visible_rect = this->visible_rect();
 
@@ -428,6 +434,8 @@ void TextBox::OnMessageReceived(Message* msg) {
 
     // Post another blink message so we blink again.
     PostMessageDelayed(TBIDC("blink"), nullptr, kCaretBlinkTimeMillis);
+    FrameScheduler::RequestFrameAt(FrameSource::kCaret,
+                                   util::GetTimeMS() + kCaretBlinkTimeMillis);
   } else if (msg->message_id() == TBIDC("selscroll") &&
              captured_element == this) {
     // Get scroll speed from where mouse is relative to the padding rect.
@@ -462,6 +470,17 @@ void TextBox::OnChange() {
   }
 
   Event ev(EventType::kChanged);
+  TextChange change;
+  const text::TextChangeRange& range = m_style_edit.last_change();
+  change.replaced_all = range.replaced_all;
+  change.sequence = range.sequence;
+  if (!range.replaced_all) {
+    change.offset = range.offset;
+    change.removed_length = range.removed_length;
+    change.inserted_text =
+        m_style_edit.GetText(range.offset, range.inserted_length);
+  }
+  ev.text_change = &change;
   InvokeEvent(std::move(ev));
 }
 
@@ -519,6 +538,8 @@ void TextBox::CaretBlinkStart() {
   // Post the delayed blink message if we don't already have one
   if (!GetMessageById(TBIDC("blink"))) {
     PostMessageDelayed(TBIDC("blink"), nullptr, kCaretBlinkTimeMillis);
+    FrameScheduler::RequestFrameAt(FrameSource::kCaret,
+                                   util::GetTimeMS() + kCaretBlinkTimeMillis);
   }
 }
 
@@ -543,7 +564,10 @@ void TextBox::TextBoxScrollRoot::OnPaintChildren(
 void TextBox::TextBoxScrollRoot::GetChildTranslation(int* x, int* y) const {
   TextBox* edit_field = static_cast<TextBox*>(parent());
   *x = -edit_field->text_view()->scroll_x;
-  *y = -edit_field->text_view()->scroll_y;
+  // Embedded content is positioned by block ypos, which is offset by
+  // ypos_origin.
+  *y = -edit_field->text_view()->scroll_y -
+       edit_field->text_view()->ypos_origin;
 }
 
 HitStatus TextBox::TextBoxScrollRoot::GetHitStatus(int x, int y) {
@@ -142,6 +142,7 @@ class TextBox : public Element,
   Element* scroll_root() override { return &m_root; }
 
   bool OnEvent(const Event& ev) override;
+  void OnProcess() override;
   void OnPaint(const PaintProps& paint_props) override;
   void OnPaintChildren(const PaintProps& paint_props) override;
   void OnInflate(const parsing::InflateInfo& info) override;
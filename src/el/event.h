@@ -110,6 +110,20 @@ enum class SpecialKey {
   kF12,
 };
 
+// Describes an edit of the text of an element: removed_length bytes at offset
+// were replaced by inserted_text.
+struct TextChange {
+  size_t offset = 0;
+  size_t removed_length = 0;
+  std::string inserted_text;
+  // Set if the whole text was replaced, in which case the range is unused.
+  bool replaced_all = false;
+  // Incremented by the element for each change. The range only applies to the
+  // text as it was after the change with the previous sequence number, so
+  // listeners that missed a change must fetch the whole text.
+  uint32_t sequence = 0;
+};
+
 class Event : public util::TypedObject {
  public:
   TBOBJECT_SUBCLASS(Event, util::TypedObject);
@@ -137,6 +151,10 @@ class Event : public util::TypedObject {
   // Set for pointer events. True if the event is a touch event (finger or pen
   // on screen).
   bool touch = false;
+  // Set for EventType::kChanged by elements editing text. Lets listeners
+  // patch their copy of the text instead of fetching all of it. nullptr if
+  // unknown.
+  const TextChange* text_change = nullptr;
 
   explicit Event(EventType type) : type(type) {}
 
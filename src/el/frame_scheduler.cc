@@ -0,0 +1,104 @@
+/**
+ ******************************************************************************
+ * Elemental Forms : a lightweight user interface framework                   *
+ ******************************************************************************
+ * Copyright 2015 Ben Vanik. All rights reserved. Licensed as BSD 3-clause.   *
+ * Portions ©2011-2015 Emil Segerås: https://github.com/fruxo/turbobadger     *
+ ******************************************************************************
+ */
+
+#include <algorithm>
+
+#include "el/animation_manager.h"
+#include "el/frame_scheduler.h"
+#include "el/message_handler.h"
+#include "el/util/metrics.h"
+
+namespace el {
+
+FrameSource FrameScheduler::dirty_sources = FrameSource::kNone;
+uint64_t FrameScheduler::source_deadlines[kSourceCount] = {
+    kNotSoon, kNotSoon, kNotSoon, kNotSoon, kNotSoon};
+
+// static
+void FrameScheduler::RequestFrame(FrameSource source) {
+  dirty_sources |= source;
+}
+
+// static
+void FrameScheduler::RequestFrameAt(FrameSource source, uint64_t time_millis) {
+  for (int i = 0; i < kSourceCount; ++i) {
+    if (any(source & static_cast<FrameSource>(1 << i))) {
+      source_deadlines[i] = std::min(source_deadlines[i], time_millis);
+    }
+  }
+}
+
+// static
+FrameSource FrameScheduler::GetDueSources(uint64_t time_millis) {
+  FrameSource sources = dirty_sources;
+  if (AnimationManager::has_running_animations()) {
+    sources |= FrameSource::kAnimation;
+  }
+  if (MessageHandler::GetNextMessageFireTime() <= time_millis) {
+    sources |= FrameSource::kMessage;
+  }
+  for (int i = 0; i < kSourceCount; ++i) {
+    if (source_deadlines[i] <= time_millis) {
+      sources |= static_cast<FrameSource>(1 << i);
+    }
+  }
+  return sources;
+}
+
+// static
+bool FrameScheduler::is_dirty() {
+  return any(GetDueSources(util::GetTimeMS()));
+}
+
+// static
+uint64_t FrameScheduler::GetNextDeadline(FrameSource* sources) {
+  FrameSource now_sources = dirty_sources;
+  if (AnimationManager::has_running_animations()) {
+    now_sources |= FrameSource::kAnimation;
+  }
+  if (any(now_sources)) {
+    if (sources) {
+      *sources = now_sources;
+    }
+    return 0;
+  }
+
+  // Sources that share the earliest deadline are all reported. Note that the
+  // caret blinks using a delayed message, so kCaret comes with kMessage.
+  uint64_t deadline = MessageHandler::GetNextMessageFireTime();
+  FrameSource deadline_sources =
+      deadline != kNotSoon ? FrameSource::kMessage : FrameSource::kNone;
+  for (int i = 0; i < kSourceCount; ++i) {
+    if (source_deadlines[i] < deadline) {
+      deadline = source_deadlines[i];
+      deadline_sources = static_cast<FrameSource>(1 << i);
+    } else if (source_deadlines[i] == deadline && deadline != kNotSoon) {
+      deadline_sources |= static_cast<FrameSource>(1 << i);
+    }
+  }
+  if (sources) {
+    *sources = deadline_sources;
+  }
+  return deadline;
+}
+
+// static
+FrameSource FrameScheduler::BeginFrame() {
+  uint64_t now = util::GetTimeMS();
+  FrameSource sources = GetDueSources(now);
+  dirty_sources = FrameSource::kNone;
+  for (int i = 0; i < kSourceCount; ++i) {
+    if (source_deadlines[i] <= now) {
+      source_deadlines[i] = kNotSoon;
+    }
+  }
+  return sources;
+}
+
+}  // namespace el
@@ -0,0 +1,80 @@
+/**
+ ******************************************************************************
+ * Elemental Forms : a lightweight user interface framework                   *
+ ******************************************************************************
+ * Copyright 2015 Ben Vanik. All rights reserved. Licensed as BSD 3-clause.   *
+ * Portions ©2011-2015 Emil Segerås: https://github.com/fruxo/turbobadger     *
+ ******************************************************************************
+ */
+
+#ifndef EL_FRAME_SCHEDULER_H_
+#define EL_FRAME_SCHEDULER_H_
+
+#include <cstdint>
+
+#include "el/types.h"
+
+namespace el {
+
+// Reasons for the host to run a frame (process and paint).
+enum class FrameSource : uint32_t {
+  kNone = 0,
+  kInvalidation = 1 << 0,  // An element needs to be repainted.
+  kLayout = 1 << 1,        // An element needs to be laid out again.
+  kAnimation = 1 << 2,     // Animations are running.
+  kCaret = 1 << 3,         // The text caret blinks.
+  kMessage = 1 << 4,       // Messages are due for MessageHandler.
+  kAll = kInvalidation | kLayout | kAnimation | kCaret | kMessage,
+};
+MAKE_ENUM_FLAG_COMBO(FrameSource);
+
+// Tells hosts when they need to run a frame, so that a static window doesn't
+// have to repaint (or even wake up) at all.
+// A typical host loop:
+//   uint64_t deadline = FrameScheduler::GetNextDeadline();
+//   wait for input until deadline (forever if it's kNotSoon)
+//   if (FrameScheduler::is_dirty()) {
+//     FrameScheduler::BeginFrame();
+//     MessageHandler::ProcessMessages(), AnimationManager::Update(),
+//     root->InvokeProcessStates(), root->InvokeProcess() and paint.
+//   }
+class FrameScheduler {
+ public:
+  // Returned from GetNextDeadline when no frame is needed until something
+  // changes (such as input).
+  static const uint64_t kNotSoon = ~0ull;
+
+  // Requests a frame as soon as possible.
+  // This is done automatically by the library for all FrameSource values.
+  static void RequestFrame(FrameSource source);
+
+  // Requests a frame at the given time, in util::GetTimeMS time.
+  static void RequestFrameAt(FrameSource source, uint64_t time_millis);
+
+  // Gets the sources that need a frame at the given time.
+  static FrameSource GetDueSources(uint64_t time_millis);
+
+  // Returns true if a frame should be run now.
+  static bool is_dirty();
+
+  // Gets when the next frame needs to run: 0 if now, kNotSoon if not until
+  // something changes. If sources is given it receives the sources
+  // responsible for that deadline.
+  static uint64_t GetNextDeadline(FrameSource* sources = nullptr);
+
+  // Marks the start of a frame. Clears all requests that are due and returns
+  // their sources. Requests made during the frame (such as invalidation
+  // caused by processing or animations) make the scheduler dirty again.
+  static FrameSource BeginFrame();
+
+ private:
+  static const int kSourceCount = 5;
+  // Sources requested with RequestFrame.
+  static FrameSource dirty_sources;
+  // Earliest time requested with RequestFrameAt, per source bit.
+  static uint64_t source_deadlines[kSourceCount];
+};
+
+}  // namespace el
+
+#endif  // EL_FRAME_SCHEDULER_H_
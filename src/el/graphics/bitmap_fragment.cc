@@ -17,5 +17,9 @@ Bitmap* BitmapFragment::GetBitmap(Validate validate_type) {
   return m_map->GetBitmap(validate_type);
 }
 
+PixelFormat BitmapFragment::pixel_format() const {
+  return m_map->pixel_format();
+}
+
 }  // namespace graphics
 }  // namespace el
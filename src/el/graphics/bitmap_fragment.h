@@ -23,6 +23,7 @@ namespace graphics {
 
 class Bitmap;
 class BitmapFragmentMap;
+enum class PixelFormat;
 
 // Specify when the bitmap should be validated when calling
 // BitmapFragmentMap::GetBitmap.
@@ -34,6 +35,18 @@ enum class Validate {
   kFirstTime,
 };
 
+// Specifies how fragments are packed into a BitmapFragmentMap.
+enum class PackingAlgorithm {
+  // Fragments are placed in horizontal rows, each row as tall as the first
+  // fragment placed in it. Fast to allocate and free, but wastes space when
+  // fragment heights vary.
+  kRows,
+  // Fragments are placed using util::MaxRectsPacker. Packs much tighter
+  // (especially if fragments are added tallest first) but allocation is slower
+  // and freed space is only reclaimed well once a map is empty again.
+  kMaxRects,
+};
+
 // Allocates space for BitmapFragment in a row (used in BitmapFragmentMap).
 class BitmapFragmentSpaceAllocator : public util::SpaceAllocator {
  public:
@@ -56,6 +69,9 @@ class BitmapFragment {
   // Validate).
   graphics::Bitmap* GetBitmap(Validate validate_type = Validate::kAlways);
 
+  // Returns the pixel format of the map this fragment is stored in.
+  PixelFormat pixel_format() const;
+
   // Returns the height allocated to this fragment. This may be larger than
   // Height() depending of the internal allocation of fragments in a map. It
   // should rarely be used.
@@ -66,6 +82,7 @@ class BitmapFragment {
   Rect m_rect;
   BitmapFragmentSpaceAllocator* m_row = nullptr;
   BitmapFragmentSpaceAllocator::Space* m_space = nullptr;
+  Rect m_packed_rect;  // Space allocated with PackingAlgorithm::kMaxRects.
   TBID m_id;
   int m_row_height = 0;
 
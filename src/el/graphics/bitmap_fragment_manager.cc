@@ -35,6 +35,7 @@ BitmapFragment* BitmapFragmentManager::GetFragmentFromFile(
   }
 
   // Load the file.
+  assert(m_pixel_format == PixelFormat::kBGRA32);
   auto img = ImageLoader::CreateFromFile(filename);
   if (!img) {
     return nullptr;
@@ -44,11 +45,58 @@ BitmapFragment* BitmapFragmentManager::GetFragmentFromFile(
                            img->width(), img->data());
 }
 
+BitmapFragment* BitmapFragmentManager::GetFragmentFromImage(
+    const std::string& filename, bool dedicated_map, ImageLoader* image) {
+  TBID id(filename);
+
+  // If we already have a fragment for this filename, return that.
+  auto it = m_fragments.find(id);
+  if (it != m_fragments.end()) {
+    return it->second.get();
+  }
+
+  if (!image) {
+    return nullptr;
+  }
+  assert(m_pixel_format == PixelFormat::kBGRA32);
+  return CreateNewFragment(id, dedicated_map, image->width(), image->height(),
+                           image->width(), image->data());
+}
+
+std::vector<BitmapFragment*> BitmapFragmentManager::GetFragmentsFromImages(
+    const std::vector<ImageSource>& sources) {
+  std::vector<size_t> order(sources.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    order[i] = i;
+  }
+  if (m_presort_images) {
+    // Tallest first, then widest first. Stable so the result is deterministic.
+    auto image_height = [&sources](size_t i) {
+      return sources[i].image ? sources[i].image->height() : 0;
+    };
+    auto image_width = [&sources](size_t i) {
+      return sources[i].image ? sources[i].image->width() : 0;
+    };
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+      if (image_height(a) != image_height(b)) {
+        return image_height(a) > image_height(b);
+      }
+      return image_width(a) > image_width(b);
+    });
+  }
+  std::vector<BitmapFragment*> fragments(sources.size());
+  for (size_t i : order) {
+    fragments[i] = GetFragmentFromImage(
+        sources[i].filename, sources[i].dedicated_map, sources[i].image);
+  }
+  return fragments;
+}
+
 BitmapFragment* BitmapFragmentManager::CreateNewFragment(const TBID& id,
                                                          bool dedicated_map,
                                                          int data_w, int data_h,
                                                          int data_stride,
-                                                         uint32_t* data) {
+                                                         const void* data) {
   assert(!GetFragment(id));
 
   std::unique_ptr<BitmapFragment> fragment;
@@ -76,7 +124,7 @@ BitmapFragment* BitmapFragmentManager::CreateNewFragment(const TBID& id,
       po2h = util::GetNearestPowerOfTwo(data_h);
     }
     auto fragment_map = std::make_unique<BitmapFragmentMap>();
-    if (fragment_map->Init(po2w, po2h)) {
+    if (fragment_map->Init(po2w, po2h, m_packing_algorithm, m_pixel_format)) {
       fragment = fragment_map->CreateNewFragment(data_w, data_h, data_stride,
                                                  data, m_add_border);
       m_fragment_maps.push_back(std::move(fragment_map));
@@ -151,13 +199,24 @@ void BitmapFragmentManager::SetDefaultMapSize(int w, int h) {
 }
 
 int BitmapFragmentManager::GetUseRatio() const {
-  int used = 0;
-  int total = 0;
+  int fragment_pixels = 0;
+  int allocated_pixels = 0;
+  int total_pixels = 0;
+  GetOccupancy(&fragment_pixels, &allocated_pixels, &total_pixels);
+  return total_pixels ? (allocated_pixels * 100) / total_pixels : 0;
+}
+
+void BitmapFragmentManager::GetOccupancy(int* out_fragment_pixels,
+                                         int* out_allocated_pixels,
+                                         int* out_total_pixels) const {
+  *out_fragment_pixels = 0;
+  *out_allocated_pixels = 0;
+  *out_total_pixels = 0;
   for (auto& fragment_map : m_fragment_maps) {
-    used += fragment_map->m_allocated_pixels;
-    total += fragment_map->m_bitmap_w * fragment_map->m_bitmap_h;
+    *out_fragment_pixels += fragment_map->m_fragment_pixels;
+    *out_allocated_pixels += fragment_map->m_allocated_pixels;
+    *out_total_pixels += fragment_map->m_bitmap_w * fragment_map->m_bitmap_h;
   }
-  return total ? (used * 100) / total : 0;
 }
 
 #ifdef EL_RUNTIME_DEBUG_INFO
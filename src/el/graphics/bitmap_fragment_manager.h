@@ -15,6 +15,8 @@
 #include <unordered_map>
 #include <vector>
 
+#include "el/graphics/bitmap_fragment.h"
+#include "el/graphics/renderer.h"
 #include "el/id.h"
 
 namespace el {
@@ -22,6 +24,7 @@ namespace graphics {
 
 class BitmapFragment;
 class BitmapFragmentMap;
+class ImageLoader;
 
 // Manages loading bitmaps of arbitrary size, pack as many of them into as few
 // Bitmap as possible.
@@ -32,17 +35,62 @@ class BitmapFragmentManager {
   BitmapFragmentManager();
   ~BitmapFragmentManager();
 
+  // Describes an already decoded image to create a fragment for.
+  struct ImageSource {
+    std::string filename;
+    bool dedicated_map = false;
+    ImageLoader* image = nullptr;
+  };
+
   bool has_border() const { return m_add_border; }
   // Sets whether a 1px border should be added to new fragments so stretched
   // drawing won't get filtering artifacts at the edges (default is disabled).
   void set_has_border(bool add_border) { m_add_border = add_border; }
 
+  PackingAlgorithm packing_algorithm() const { return m_packing_algorithm; }
+  // Sets how fragments are packed into maps created after this call (default
+  // is PackingAlgorithm::kRows).
+  void set_packing_algorithm(PackingAlgorithm packing_algorithm) {
+    m_packing_algorithm = packing_algorithm;
+  }
+
+  PixelFormat pixel_format() const { return m_pixel_format; }
+  // Sets the pixel format of maps created after this call (default is
+  // PixelFormat::kBGRA32). Images can only be loaded into BGRA32 maps, while
+  // f.ex glyph coverage can use PixelFormat::kA8 to use a quarter of the
+  // memory, if the renderer supports it.
+  void set_pixel_format(PixelFormat pixel_format) {
+    m_pixel_format = pixel_format;
+  }
+
+  bool presort_images() const { return m_presort_images; }
+  // Sets whether GetFragmentsFromImages should insert images tallest first
+  // instead of in the given order (default is disabled). All fragments are
+  // known up front in that case so this packs much tighter.
+  void set_presort_images(bool presort_images) {
+    m_presort_images = presort_images;
+  }
+
   // Gets the fragment with the given image filename.
   // If it's not already loaded, it will be loaded into a new fragment with the
   // filename as id. returns nullptr on fail.
   BitmapFragment* GetFragmentFromFile(const std::string& filename,
                                       bool dedicated_map);
 
+  // Gets the fragment with the given image filename.
+  // If it's not already loaded, it will be created from the already decoded
+  // image with the filename as id. This allows images to be decoded elsewhere
+  // (f.ex on worker threads) and packed into maps later.
+  // Returns nullptr on fail.
+  BitmapFragment* GetFragmentFromImage(const std::string& filename,
+                                       bool dedicated_map, ImageLoader* image);
+
+  // Gets the fragments for all the given images as with GetFragmentFromImage.
+  // If presort_images is set they are packed tallest first, otherwise in the
+  // given order. Returns the fragments in the same order as sources.
+  std::vector<BitmapFragment*> GetFragmentsFromImages(
+      const std::vector<ImageSource>& sources);
+
   // Gets the fragment with the given id, or nullptr if it doesn't exist.
   BitmapFragment* GetFragment(const TBID& id) const;
 
@@ -52,10 +100,10 @@ class BitmapFragmentManager {
   // @param data_w the width of the data.
   // @param data_h the height of the data.
   // @param data_stride the number of pixels in a row of the input data.
-  // @param data pointer to the data in BGRA32 format.
+  // @param data pointer to the data in the pixel_format of this manager.
   BitmapFragment* CreateNewFragment(const TBID& id, bool dedicated_map,
                                     int data_w, int data_h, int data_stride,
-                                    uint32_t* data);
+                                    const void* data);
 
   // Deletes the given fragment and free the space it used in its map, so that
   // other fragments can take its place.
@@ -93,6 +141,14 @@ class BitmapFragmentManager {
   // maps in this fragment manager.
   int GetUseRatio() const;
 
+  // Gets the atlas occupancy of all maps in this fragment manager:
+  // out_fragment_pixels is the number of pixels of fragment data,
+  // out_allocated_pixels includes borders and any space lost to packing, and
+  // out_total_pixels is the total number of pixels in all maps.
+  // Useful to compare packing algorithms.
+  void GetOccupancy(int* out_fragment_pixels, int* out_allocated_pixels,
+                    int* out_total_pixels) const;
+
 #ifdef EL_RUNTIME_DEBUG_INFO
   // Renders the maps on screen, to analyze fragment positioning.
   void Debug();
@@ -103,6 +159,9 @@ class BitmapFragmentManager {
   std::unordered_map<uint32_t, std::unique_ptr<BitmapFragment>> m_fragments;
   int m_num_maps_limit = 0;
   bool m_add_border = false;
+  PackingAlgorithm m_packing_algorithm = PackingAlgorithm::kRows;
+  PixelFormat m_pixel_format = PixelFormat::kBGRA32;
+  bool m_presort_images = false;
   int m_default_map_w = 512;
   int m_default_map_h = 512;
 };
@@ -17,24 +17,43 @@
 namespace el {
 namespace graphics {
 
+namespace {
+// Maximum number of separate dirty rects tracked per map before they are all
+// collapsed into their bounding rect.
+const size_t kMaxDirtyRects = 8;
+
+// Returns the pixel with alpha cleared, used for the borders around fragments.
+inline uint32_t ClearAlpha(uint32_t pixel) { return pixel & 0x00ffffff; }
+inline uint8_t ClearAlpha(uint8_t /*pixel*/) { return 0; }
+}  // namespace
+
 BitmapFragmentMap::BitmapFragmentMap() = default;
 
-bool BitmapFragmentMap::Init(int bitmap_w, int bitmap_h) {
-  m_bitmap_data = new uint32_t[bitmap_w * bitmap_h];
+bool BitmapFragmentMap::Init(int bitmap_w, int bitmap_h,
+                             PackingAlgorithm packing_algorithm,
+                             PixelFormat pixel_format) {
+  const size_t data_size =
+      size_t(bitmap_w) * bitmap_h * GetBytesPerPixel(pixel_format);
+  m_bitmap_data.reset(new uint8_t[data_size]);
   m_bitmap_w = bitmap_w;
   m_bitmap_h = bitmap_h;
+  m_pixel_format = pixel_format;
+  if (packing_algorithm == PackingAlgorithm::kMaxRects) {
+    m_packer = std::make_unique<util::MaxRectsPacker>(bitmap_w, bitmap_h);
+  }
 #ifdef EL_RUNTIME_DEBUG_INFO
-  std::memset(m_bitmap_data, 0x88, bitmap_w * bitmap_h * sizeof(uint32_t));
+  std::memset(m_bitmap_data.get(), 0x88, data_size);
 #endif  // EL_RUNTIME_DEBUG_INFO
   return m_bitmap_data ? true : false;
 }
 
-BitmapFragmentMap::~BitmapFragmentMap() { delete[] m_bitmap_data; }
+BitmapFragmentMap::~BitmapFragmentMap() = default;
 
 std::unique_ptr<BitmapFragment> BitmapFragmentMap::CreateNewFragment(
-    int frag_w, int frag_h, int data_stride, uint32_t* frag_data,
+    int frag_w, int frag_h, int data_stride, const void* frag_data,
     bool add_border) {
-  // Finding available space works like this:
+  // With PackingAlgorithm::kMaxRects, finding space is up to the packer.
+  // With PackingAlgorithm::kRows, finding available space works like this:
   // The map size is sliced up horizontally in rows (initially just one row
   // covering
   // the entire map). When adding a new fragment, put it in the row with
@@ -71,6 +90,35 @@ std::unique_ptr<BitmapFragment> BitmapFragmentMap::CreateNewFragment(
   // const int granularity = 8;
   // needed_w = (needed_w + granularity - 1) / granularity * granularity;
   // needed_h = (needed_h + granularity - 1) / granularity * granularity;
+  auto frag = std::make_unique<BitmapFragment>();
+  frag->m_map = this;
+  if (m_packer) {
+    if (!m_packer->Insert(needed_w, needed_h, &frag->m_packed_rect)) {
+      return nullptr;
+    }
+    frag->m_rect.reset(frag->m_packed_rect.x + border,
+                       frag->m_packed_rect.y + border, frag_w, frag_h);
+    frag->m_row_height = needed_h;
+    m_allocated_pixels += needed_w * needed_h;
+  } else {
+    if (!AllocRowSpace(frag.get(), needed_w, needed_h)) {
+      return nullptr;
+    }
+    frag->m_rect.reset(frag->m_space->x + border, frag->m_row->y + border,
+                       frag_w, frag_h);
+    frag->m_row_height = frag->m_row->height;
+    m_allocated_pixels += frag->m_space->width * frag->m_row->height;
+  }
+  frag->m_batch_id = 0xffffffff;
+  m_fragment_pixels += frag_w * frag_h;
+  // Copy the fragment data into the map data.
+  CopyData(frag.get(), data_stride, frag_data, border);
+  InvalidateRect(frag->m_rect.Expand(border, border));
+  return frag;
+}
+
+bool BitmapFragmentMap::AllocRowSpace(BitmapFragment* frag, int needed_w,
+                                      int needed_h) {
   if (m_rows.empty()) {
     // Create a row covering the entire bitmap.
     auto row = std::make_unique<BitmapFragmentSpaceAllocator>(0, m_bitmap_w,
@@ -95,7 +143,7 @@ std::unique_ptr<BitmapFragment> BitmapFragmentMap::CreateNewFragment(
   }
   // Return if we're full.
   if (!best_row) {
-    return nullptr;
+    return false;
   }
   // If the row is unused, create a smaller row to only consume needed height
   // for fragment.
@@ -106,22 +154,14 @@ std::unique_ptr<BitmapFragment> BitmapFragmentMap::CreateNewFragment(
     m_rows.insert(m_rows.begin() + best_row_index + 1, std::move(row));
     best_row->height = needed_h;
   }
-  // Allocate the fragment and copy the fragment data into the map data.
+  // Allocate the fragment space.
   auto space = best_row->AllocSpace(needed_w);
   if (!space) {
-    return nullptr;
+    return false;
   }
-  auto frag = std::make_unique<BitmapFragment>();
-  frag->m_map = this;
   frag->m_row = best_row;
   frag->m_space = space;
-  frag->m_rect.reset(space->x + border, best_row->y + border, frag_w, frag_h);
-  frag->m_row_height = best_row->height;
-  frag->m_batch_id = 0xffffffff;
-  CopyData(frag.get(), data_stride, frag_data, border);
-  m_need_update = true;
-  m_allocated_pixels += frag->m_space->width * frag->m_row->height;
-  return frag;
+  return true;
 }
 
 void BitmapFragmentMap::FreeFragmentSpace(BitmapFragment* frag) {
@@ -131,15 +171,24 @@ void BitmapFragmentMap::FreeFragmentSpace(BitmapFragment* frag) {
 #ifdef EL_RUNTIME_DEBUG_INFO
   // Debug code to clear the area in debug builds so it's easier to
   // see & debug the allocation & deallocation of fragments in maps.
-  uint32_t* data32 = new uint32_t[frag->m_space->width * frag->m_row->height];
+  const size_t clear_size = size_t(frag->m_rect.w) * frag->m_rect.h *
+                            GetBytesPerPixel(m_pixel_format);
+  std::unique_ptr<uint8_t[]> clear_data(new uint8_t[clear_size]);
   static int c = 0;
-  std::memset(data32, (c++) * 32,
-              sizeof(uint32_t) * frag->m_space->width * frag->m_row->height);
-  CopyData(frag, frag->m_space->width, data32, false);
-  m_need_update = true;
-  delete[] data32;
+  std::memset(clear_data.get(), (c++) * 32, clear_size);
+  CopyData(frag, frag->m_rect.w, clear_data.get(), false);
+  InvalidateRect(frag->m_rect);
 #endif  // EL_RUNTIME_DEBUG_INFO
 
+  m_fragment_pixels -= frag->m_rect.w * frag->m_rect.h;
+  if (m_packer) {
+    m_allocated_pixels -= frag->m_packed_rect.w * frag->m_packed_rect.h;
+    m_packer->Free(frag->m_packed_rect);
+    frag->m_packed_rect.reset();
+    frag->m_row_height = 0;
+    return;
+  }
+
   m_allocated_pixels -= frag->m_space->width * frag->m_row->height;
   frag->m_row->FreeSpace(frag->m_space);
   frag->m_space = nullptr;
@@ -163,12 +212,25 @@ void BitmapFragmentMap::FreeFragmentSpace(BitmapFragment* frag) {
 }
 
 void BitmapFragmentMap::CopyData(BitmapFragment* frag, int data_stride,
-                                 uint32_t* frag_data, int border) {
+                                 const void* frag_data, int border) {
+  if (m_pixel_format == PixelFormat::kA8) {
+    CopyPixels(frag, data_stride, static_cast<const uint8_t*>(frag_data),
+               border);
+  } else {
+    CopyPixels(frag, data_stride, static_cast<const uint32_t*>(frag_data),
+               border);
+  }
+}
+
+template <typename T>
+void BitmapFragmentMap::CopyPixels(BitmapFragment* frag, int data_stride,
+                                   const T* frag_data, int border) {
+  T* bitmap_data = reinterpret_cast<T*>(m_bitmap_data.get());
   // Copy the bitmap data.
-  uint32_t* dst = m_bitmap_data + frag->m_rect.x + frag->m_rect.y * m_bitmap_w;
-  uint32_t* src = frag_data;
+  T* dst = bitmap_data + frag->m_rect.x + frag->m_rect.y * m_bitmap_w;
+  const T* src = frag_data;
   for (int i = 0; i < frag->m_rect.h; ++i) {
-    std::memcpy(dst, src, frag->m_rect.w * sizeof(uint32_t));
+    std::memcpy(dst, src, frag->m_rect.w * sizeof(T));
     dst += m_bitmap_w;
     src += data_stride;
   }
@@ -176,24 +238,24 @@ void BitmapFragmentMap::CopyData(BitmapFragment* frag, int data_stride,
   if (border) {
     Rect rect = frag->m_rect.Expand(border, border);
     // Copy vertical edges.
-    dst = m_bitmap_data + rect.x + (rect.y + 1) * m_bitmap_w;
+    dst = bitmap_data + rect.x + (rect.y + 1) * m_bitmap_w;
     src = frag_data;
     for (int i = 0; i < frag->m_rect.h; ++i) {
-      dst[0] = src[0] & 0x00ffffff;
-      dst[rect.w - 1] = src[frag->m_rect.w - 1] & 0x00ffffff;
+      dst[0] = ClearAlpha(src[0]);
+      dst[rect.w - 1] = ClearAlpha(src[frag->m_rect.w - 1]);
       dst += m_bitmap_w;
       src += data_stride;
     }
     // Copy horizontal edges.
-    dst = m_bitmap_data + rect.x + 1 + rect.y * m_bitmap_w;
+    dst = bitmap_data + rect.x + 1 + rect.y * m_bitmap_w;
     src = frag_data;
     for (int i = 0; i < frag->m_rect.w; ++i) {
-      dst[i] = src[i] & 0x00ffffff;
+      dst[i] = ClearAlpha(src[i]);
     }
-    dst = m_bitmap_data + rect.x + 1 + (rect.y + rect.h - 1) * m_bitmap_w;
+    dst = bitmap_data + rect.x + 1 + (rect.y + rect.h - 1) * m_bitmap_w;
     src = frag_data + (frag->m_rect.h - 1) * data_stride;
     for (int i = 0; i < frag->m_rect.w; ++i) {
-      dst[i] = src[i] & 0x00ffffff;
+      dst[i] = ClearAlpha(src[i]);
     }
   }
 }
@@ -206,15 +268,58 @@ Bitmap* BitmapFragmentMap::GetBitmap(Validate validate_type) {
   return m_bitmap.get();
 }
 
+void BitmapFragmentMap::InvalidateRect(const Rect& rect) {
+  if (m_need_update || !m_bitmap) {
+    // Everything will be uploaded anyway.
+    m_need_update = true;
+    return;
+  }
+  // Merge with any rect we touch, so that f.ex glyphs added next to each other
+  // in a row are uploaded together.
+  Rect dirty_rect = rect;
+  for (size_t i = 0; i < m_dirty_rects.size();) {
+    if (m_dirty_rects[i].Expand(1, 1).intersects(dirty_rect)) {
+      dirty_rect = dirty_rect.Union(m_dirty_rects[i]);
+      m_dirty_rects.erase(m_dirty_rects.begin() + i);
+      i = 0;
+    } else {
+      ++i;
+    }
+  }
+  m_dirty_rects.push_back(dirty_rect);
+  if (m_dirty_rects.size() > kMaxDirtyRects) {
+    for (auto& other_rect : m_dirty_rects) {
+      dirty_rect = dirty_rect.Union(other_rect);
+    }
+    m_dirty_rects.clear();
+    m_dirty_rects.push_back(dirty_rect);
+  }
+}
+
 bool BitmapFragmentMap::ValidateBitmap() {
+  if (!m_need_update && m_bitmap && !m_dirty_rects.empty()) {
+    // Upload only what changed, if the bitmap supports it.
+    for (auto& rect : m_dirty_rects) {
+      const size_t offset = (size_t(rect.x) + size_t(rect.y) * m_bitmap_w) *
+                            GetBytesPerPixel(m_pixel_format);
+      if (!m_bitmap->set_data_region(rect, m_bitmap_data.get() + offset,
+                                     m_bitmap_w)) {
+        m_need_update = true;
+        break;
+      }
+    }
+    m_dirty_rects.clear();
+  }
   if (m_need_update) {
     if (m_bitmap) {
-      m_bitmap->set_data(m_bitmap_data);
+      m_bitmap->set_data(m_bitmap_data.get());
     } else {
-      m_bitmap =
-          Renderer::get()->CreateBitmap(m_bitmap_w, m_bitmap_h, m_bitmap_data);
+      m_bitmap = Renderer::get()->CreateBitmap(m_bitmap_w, m_bitmap_h,
+                                               m_pixel_format,
+                                               m_bitmap_data.get());
     }
     m_need_update = false;
+    m_dirty_rects.clear();
   }
   return m_bitmap ? true : false;
 }
@@ -222,6 +327,7 @@ bool BitmapFragmentMap::ValidateBitmap() {
 void BitmapFragmentMap::DeleteBitmap() {
   m_bitmap.reset();
   m_need_update = true;
+  m_dirty_rects.clear();
 }
 
 }  // namespace graphics
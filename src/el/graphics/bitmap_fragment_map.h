@@ -15,6 +15,8 @@
 #include <vector>
 
 #include "el/graphics/bitmap_fragment.h"
+#include "el/graphics/renderer.h"
+#include "el/util/rect_packer.h"
 
 namespace el {
 namespace graphics {
@@ -30,17 +32,22 @@ class BitmapFragmentMap {
   BitmapFragmentMap();
   ~BitmapFragmentMap();
 
-  // Initializes the map with the given size.
+  // Initializes the map with the given size and pixel format.
   // The size should be a power of two since it will be used to create a
   // Bitmap (texture memory).
-  bool Init(int bitmap_w, int bitmap_h);
+  bool Init(int bitmap_w, int bitmap_h,
+            PackingAlgorithm packing_algorithm = PackingAlgorithm::kRows,
+            PixelFormat pixel_format = PixelFormat::kBGRA32);
 
-  // Creates a new fragment with the given size and data in this map.
+  PixelFormat pixel_format() const { return m_pixel_format; }
+
+  // Creates a new fragment with the given size and data (in the pixel format
+  // of this map, with data_stride pixels per row) in this map.
   // Returns nullptr if there is not enough room in this map or on any other
   // fail.
   std::unique_ptr<BitmapFragment> CreateNewFragment(int frag_w, int frag_h,
                                                     int data_stride,
-                                                    uint32_t* frag_data,
+                                                    const void* frag_data,
                                                     bool add_border);
 
   // Frees up the space used by the given fragment, so that other fragments can
@@ -56,16 +63,30 @@ class BitmapFragmentMap {
   friend class BitmapFragmentManager;
   bool ValidateBitmap();
   void DeleteBitmap();
-  void CopyData(BitmapFragment* frag, int data_stride, uint32_t* frag_data,
+  void CopyData(BitmapFragment* frag, int data_stride, const void* frag_data,
                 int border);
+  template <typename T>
+  void CopyPixels(BitmapFragment* frag, int data_stride, const T* frag_data,
+                  int border);
+
+  bool AllocRowSpace(BitmapFragment* frag, int needed_w, int needed_h);
+  // Marks the given rect of m_bitmap_data as needing upload to the bitmap.
+  void InvalidateRect(const Rect& rect);
 
   std::vector<std::unique_ptr<BitmapFragmentSpaceAllocator>> m_rows;
+  std::unique_ptr<util::MaxRectsPacker> m_packer;
   int m_bitmap_w = 0;
   int m_bitmap_h = 0;
-  uint32_t* m_bitmap_data = nullptr;
+  PixelFormat m_pixel_format = PixelFormat::kBGRA32;
+  std::unique_ptr<uint8_t[]> m_bitmap_data;
   std::unique_ptr<Bitmap> m_bitmap;
+  // Set if the whole bitmap must be updated (or created).
   bool m_need_update = false;
+  // Rects that must be updated in an existing bitmap. Kept short by merging
+  // touching rects, and collapsing all into one if there are too many.
+  std::vector<Rect> m_dirty_rects;
   int m_allocated_pixels = 0;
+  int m_fragment_pixels = 0;
 };
 
 }  // namespace graphics
@@ -23,6 +23,7 @@ class ImageLoader {
  public:
   // The system must implement this function and create an implementation of the
   // ImageLoader interface.
+  // This may be called from worker threads and must be thread safe.
   static std::unique_ptr<ImageLoader> CreateFromFile(
       const std::string& filename);
 
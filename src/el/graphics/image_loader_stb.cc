@@ -49,15 +49,25 @@ class StbiImageLoader : public ImageLoader {
 
 std::unique_ptr<ImageLoader> ImageLoader::CreateFromFile(
     const std::string& filename) {
-  // Load directly from file.
-  auto buffer = io::FileManager::ReadContents(filename);
-  if (!buffer) {
+  auto file = io::FileManager::OpenRead(filename);
+  if (!file) {
     return nullptr;
   }
 
+  // Decode straight from the file data if it's already in memory (mapped or
+  // archived files), otherwise read it into a temporary buffer.
+  std::vector<uint8_t> buffer;
+  const uint8_t* file_data = file->data();
+  size_t file_size = file->size();
+  if (!file_data) {
+    buffer.resize(file_size);
+    file_size = file->Read(buffer.data(), buffer.size());
+    file_data = buffer.data();
+  }
+
   int w, h, comp;
   auto img_data = stbi_load_from_memory(
-      buffer->data(), static_cast<int>(buffer->size()), &w, &h, &comp, 4);
+      file_data, static_cast<int>(file_size), &w, &h, &comp, 4);
   if (!img_data) {
     return nullptr;
   }
@@ -44,6 +44,11 @@ void Renderer::InvokeContextRestored() {
 void Renderer::BeginPaint(int render_target_w, int render_target_h) {
   begin_paint_batch_id_ = batch_.batch_id;
   frame_triangle_count_ = 0;
+  // Skip 0 on wrap, as it's used to indicate we aren't painting.
+  if (!++paint_frame_id_) {
+    ++paint_frame_id_;
+  }
+  is_painting_ = true;
 
   screen_rect_.reset(0, 0, render_target_w, render_target_h);
   clip_rect_ = screen_rect_;
@@ -51,6 +56,7 @@ void Renderer::BeginPaint(int render_target_w, int render_target_h) {
 
 void Renderer::EndPaint() {
   FlushAllInternal();
+  is_painting_ = false;
 
 #ifdef EL_RUNTIME_DEBUG_INFO
   if (EL_DEBUG_SETTING(util::DebugInfo::Setting::kDrawRenderBatches)) {
@@ -133,6 +139,20 @@ void Renderer::DrawBitmapColored(const Rect& dst_rect, const Rect& src_rect,
                   VER_COL(color.r, color.g, color.b, a), bitmap, nullptr);
 }
 
+void Renderer::DrawBitmapDistanceField(const Rect& dst_rect,
+                                       const Rect& src_rect,
+                                       const Color& color,
+                                       BitmapFragment* bitmap_fragment) {
+  assert(supports_distance_field());
+  if (auto bitmap = bitmap_fragment->GetBitmap(Validate::kFirstTime)) {
+    uint32_t a = (color.a * opacity_) / 255;
+    AddQuadInternal(
+        dst_rect.Offset(translation_x_, translation_y_),
+        src_rect.Offset(bitmap_fragment->m_rect.x, bitmap_fragment->m_rect.y),
+        VER_COL(color.r, color.g, color.b, a), bitmap, bitmap_fragment, true);
+  }
+}
+
 void Renderer::DrawBitmapTile(const Rect& dst_rect, Bitmap* bitmap) {
   AddQuadInternal(dst_rect.Offset(translation_x_, translation_y_),
                   Rect(0, 0, dst_rect.w, dst_rect.h), VER_COL_OPACITY(opacity_),
@@ -163,9 +183,11 @@ void Renderer::DrawRectFill(const Rect& dst_rect, const Color& color) {
 
 void Renderer::AddQuadInternal(const Rect& dst_rect, const Rect& src_rect,
                                uint32_t color, Bitmap* bitmap,
-                               BitmapFragment* fragment) {
+                               BitmapFragment* fragment,
+                               bool is_distance_field) {
   // On state change force flush.
-  if (batch_.bitmap != bitmap) {
+  if (batch_.bitmap != bitmap ||
+      batch_.is_distance_field != is_distance_field) {
     FlushBatch();
   }
 
@@ -175,6 +197,7 @@ void Renderer::AddQuadInternal(const Rect& dst_rect, const Rect& src_rect,
 
   // Setup batch textures (if any).
   batch_.bitmap = bitmap;
+  batch_.is_distance_field = is_distance_field;
   if (bitmap) {
     int bitmap_w = bitmap->width();
     int bitmap_h = bitmap->height();
@@ -22,6 +22,20 @@ namespace graphics {
 
 class BitmapFragment;
 
+// Pixel formats of Bitmap data.
+enum class PixelFormat {
+  // 32-bit BGRA, one uint32_t per pixel.
+  kBGRA32,
+  // 8-bit alpha. Drawn as white with the given alpha, so it's only useful for
+  // masks such as glyph coverage (see DrawBitmapColored).
+  kA8,
+};
+
+// Returns the size in bytes of one pixel in the given format.
+inline int GetBytesPerPixel(PixelFormat format) {
+  return format == PixelFormat::kA8 ? 1 : 4;
+}
+
 // RendererListener is a listener for Renderer.
 class RendererListener : public util::IntrusiveListEntry<RendererListener> {
  public:
@@ -49,11 +63,23 @@ class Bitmap {
   virtual int width() = 0;
   virtual int height() = 0;
 
-  // Updates the bitmap with the given data (in BGRA32 format).
+  // Updates the bitmap with the given data (in the pixel format the bitmap was
+  // created with).
   // NOTE: Implementations for batched renderers should call
   // Renderer::FlushBitmap to make sure any active batch is being flushed
   // before the bitmap is changed.
-  virtual void set_data(uint32_t* data) = 0;
+  virtual void set_data(const void* data) = 0;
+
+  // Updates the given rect of the bitmap with the given data (in the pixel
+  // format the bitmap was created with). data points at the first pixel of the
+  // rect and stride is the number of pixels in a row of data.
+  // Returns false if partial updates are not supported by the implementation,
+  // in which case the caller will use set_data instead.
+  // NOTE: The same flushing rules as for set_data apply.
+  virtual bool set_data_region(const Rect& /*rect*/, const void* /*data*/,
+                               int /*stride*/) {
+    return false;
+  }
 };
 
 // A batching interface for drawing performed by the library.
@@ -74,6 +100,11 @@ class Renderer {
   virtual void BeginPaint(int render_target_w, int render_target_h);
   virtual void EndPaint();
 
+  // Returns an id unique to the current BeginPaint/EndPaint pair, or 0 if not
+  // currently painting. Can be used to cache state that is stable for the
+  // duration of a frame.
+  uint32_t paint_frame_id() const { return is_painting_ ? paint_frame_id_ : 0; }
+
   // Translates all drawing with the given offset.
   void Translate(int dx, int dy);
 
@@ -116,6 +147,19 @@ class Renderer {
   void DrawBitmapColored(const Rect& dst_rect, const Rect& src_rect,
                          const Color& color, Bitmap* bitmap);
 
+  // Draws the src_rect part of the fragment stretched to dst_rect, treating its
+  // alpha channel as a distance field (see text/distance_field.h) that is
+  // thresholded at the outline and filled with color.
+  // Only valid if supports_distance_field returns true.
+  void DrawBitmapDistanceField(const Rect& dst_rect, const Rect& src_rect,
+                               const Color& color,
+                               BitmapFragment* bitmap_fragment);
+
+  // Returns true if the implementation can draw distance fields (see
+  // DrawBitmapDistanceField), f.ex with a smoothstep in its fragment shader.
+  // When false, distance field glyphs are converted to coverage on the CPU.
+  virtual bool supports_distance_field() const { return false; }
+
   // Draws the bitmap tiled into dst_rect.
   void DrawBitmapTile(const Rect& dst_rect, Bitmap* bitmap);
 
@@ -129,11 +173,19 @@ class Renderer {
   // it may be changed or deleted after this call.
   void FlushBitmapFragment(BitmapFragment* bitmap_fragment);
 
-  // Creates a new Bitmap from the given data (in BGRA32 format).
+  // Creates a new Bitmap from the given data in the given pixel format, which
+  // must be supported (see supports_pixel_format).
   // Width and height must be a power of two.
   // Returns nullptr if fail.
   virtual std::unique_ptr<Bitmap> CreateBitmap(int width, int height,
-                                               uint32_t* data) = 0;
+                                               PixelFormat format,
+                                               const void* data) = 0;
+
+  // Returns true if bitmaps can be created in the given pixel format.
+  // PixelFormat::kBGRA32 must always be supported.
+  virtual bool supports_pixel_format(PixelFormat format) const {
+    return format == PixelFormat::kBGRA32;
+  }
 
   // Adds a listener to this renderer.
   // Does not take ownership.
@@ -154,8 +206,8 @@ class Renderer {
 
   // Defines the hint given to BeginBatchHint.
   enum class BatchHint {
-    // All calls are either DrawBitmap or DrawBitmapColored with the same bitmap
-    // fragment.
+    // All calls are either DrawBitmap, DrawBitmapColored or
+    // DrawBitmapDistanceField with the same bitmap fragment.
     kDrawBitmapFragment,
   };
 
@@ -184,6 +236,8 @@ class Renderer {
 
     Bitmap* bitmap = nullptr;
     BitmapFragment* fragment = nullptr;
+    // True if the bitmap alpha is a distance field that should be thresholded.
+    bool is_distance_field = false;
 
     uint32_t batch_id = 0;
     bool is_flushing = false;
@@ -208,8 +262,8 @@ class Renderer {
   virtual void set_clip_rect(const Rect& rect) = 0;
 
   void AddQuadInternal(const Rect& dst_rect, const Rect& src_rect,
-                       uint32_t color, Bitmap* bitmap,
-                       BitmapFragment* fragment);
+                       uint32_t color, Bitmap* bitmap, BitmapFragment* fragment,
+                       bool is_distance_field = false);
   void FlushAllInternal();
 
   static Renderer* renderer_singleton_;
@@ -227,6 +281,8 @@ class Renderer {
 
   size_t begin_paint_batch_id_ = 0;
   size_t frame_triangle_count_ = 0;
+  uint32_t paint_frame_id_ = 0;
+  bool is_painting_ = false;
 };
 
 }  // namespace graphics
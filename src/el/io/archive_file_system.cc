@@ -0,0 +1,254 @@
+/**
+ ******************************************************************************
+ * Elemental Forms : a lightweight user interface framework                   *
+ ******************************************************************************
+ * Copyright 2015 Ben Vanik. All rights reserved. Licensed as BSD 3-clause.   *
+ * Portions ©2011-2015 Emil Segerås: https://github.com/fruxo/turbobadger     *
+ ******************************************************************************
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "el/io/archive_file_system.h"
+#include "el/io/directory.h"
+
+namespace el {
+namespace io {
+
+namespace {
+class ArchiveFile : public File {
+ public:
+  ArchiveFile(const uint8_t* data, size_t length)
+      : data_(data), length_(length) {}
+
+  size_t size() const override { return length_; }
+
+  size_t Read(void* buffer, size_t length) override {
+    size_t to_read = std::min(length_ - position_, length);
+    if (!to_read) {
+      return 0;
+    }
+    std::memcpy(buffer, data_ + position_, to_read);
+    position_ += to_read;
+    return to_read;
+  }
+
+  const uint8_t* data() const override { return data_; }
+
+ private:
+  const uint8_t* data_;
+  size_t length_;
+  size_t position_ = 0;
+};
+
+bool NamesEqual(const char* a, const char* b, size_t length) {
+  for (size_t i = 0; i < length; ++i) {
+    char ca = a[i] == '\\' ? '/' : a[i];
+    char cb = b[i] == '\\' ? '/' : b[i];
+    if (ca != cb) {
+      return false;
+    }
+  }
+  return true;
+}
+}  // namespace
+
+uint32_t ArchiveFileSystem::HashName(const char* name, size_t length) {
+  // FNV-1a.
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < length; ++i) {
+    char c = name[i] == '\\' ? '/' : name[i];
+    hash ^= uint8_t(c);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+std::unique_ptr<ArchiveFileSystem> ArchiveFileSystem::Open(
+    std::unique_ptr<File> archive_file) {
+  if (!archive_file) {
+    return nullptr;
+  }
+  std::unique_ptr<ArchiveFileSystem> archive(new ArchiveFileSystem());
+  size_t length = archive_file->size();
+  archive->data_ = archive_file->data();
+  if (!archive->data_ || reinterpret_cast<uintptr_t>(archive->data_) % 4) {
+    // Not in memory (or not aligned for the index structs); keep a copy.
+    archive->owned_data_.resize(length);
+    length = archive_file->Read(archive->owned_data_.data(), length);
+    archive->data_ = archive->owned_data_.data();
+    archive_file.reset();
+  }
+  archive->archive_file_ = std::move(archive_file);
+  if (!archive->Validate(length)) {
+    return nullptr;
+  }
+  return archive;
+}
+
+bool ArchiveFileSystem::Validate(size_t length) {
+  if (length < sizeof(Header)) {
+    return false;
+  }
+  header_ = reinterpret_cast<const Header*>(data_);
+  entries_ = reinterpret_cast<const Entry*>(data_ + sizeof(Header));
+  if (header_->magic != kMagic || header_->version != kVersion ||
+      !header_->table_size ||
+      (header_->table_size & (header_->table_size - 1)) ||
+      header_->entry_count > header_->table_size ||
+      (length - sizeof(Header)) / sizeof(Entry) < header_->table_size) {
+    return false;
+  }
+  // Check the ranges up front so lookups can trust them.
+  for (uint32_t i = 0; i < header_->table_size; ++i) {
+    const Entry& entry = entries_[i];
+    if (size_t(entry.name_offset) + entry.name_length > length ||
+        size_t(entry.data_offset) + entry.data_length > length) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::unique_ptr<File> ArchiveFileSystem::OpenRead(std::string filename) {
+  if (filename.empty()) {
+    return nullptr;
+  }
+  uint32_t hash = HashName(filename.c_str(), filename.size());
+  uint32_t mask = header_->table_size - 1;
+  for (uint32_t i = 0; i <= mask; ++i) {
+    const Entry& entry = entries_[(hash + i) & mask];
+    if (!entry.name_length) {
+      // Empty slot; the name is not in the table.
+      return nullptr;
+    }
+    if (entry.name_hash == hash && entry.name_length == filename.size() &&
+        NamesEqual(reinterpret_cast<const char*>(data_ + entry.name_offset),
+                   filename.c_str(), filename.size())) {
+      return std::make_unique<ArchiveFile>(data_ + entry.data_offset,
+                                           entry.data_length);
+    }
+  }
+  return nullptr;
+}
+
+void ArchiveWriter::AddFile(std::string filename, const void* data,
+                            size_t length) {
+  if (filename.empty()) {
+    return;
+  }
+  std::replace(filename.begin(), filename.end(), '\\', '/');
+  auto bytes = reinterpret_cast<const uint8_t*>(data);
+  for (auto& file : files_) {
+    if (file.first == filename) {
+      file.second.assign(bytes, bytes + length);
+      return;
+    }
+  }
+  files_.emplace_back(std::move(filename),
+                      std::vector<uint8_t>(bytes, bytes + length));
+}
+
+bool ArchiveWriter::AddDirectory(const std::string& root_path) {
+  std::vector<std::string> filenames;
+  if (!ListFilesRecursive(root_path, &filenames)) {
+    return false;
+  }
+  std::string prefix = root_path;
+  if (!prefix.empty() && prefix.back() != '/' && prefix.back() != '\\') {
+    prefix += '/';
+  }
+  for (auto& filename : filenames) {
+    FILE* file_handle = fopen((prefix + filename).c_str(), "rb");
+    if (!file_handle) {
+      return false;
+    }
+    std::vector<uint8_t> buffer;
+    uint8_t chunk[4096];
+    while (size_t read = fread(chunk, 1, sizeof(chunk), file_handle)) {
+      buffer.insert(buffer.end(), chunk, chunk + read);
+    }
+    fclose(file_handle);
+    AddFile(filename, buffer.data(), buffer.size());
+  }
+  return true;
+}
+
+std::vector<uint8_t> ArchiveWriter::Serialize() const {
+  using Header = ArchiveFileSystem::Header;
+  using Entry = ArchiveFileSystem::Entry;
+
+  // Keep the load factor at or below 50% so probe sequences stay short.
+  uint32_t table_size = 1;
+  while (table_size < files_.size() * 2) {
+    table_size <<= 1;
+  }
+
+  size_t names_offset = sizeof(Header) + table_size * sizeof(Entry);
+  size_t names_length = 0;
+  for (auto& file : files_) {
+    names_length += file.first.size();
+  }
+  auto align = [](size_t offset) {
+    const size_t a = ArchiveFileSystem::kDataAlignment;
+    return (offset + a - 1) & ~(a - 1);
+  };
+  size_t total_length = align(names_offset + names_length);
+  for (auto& file : files_) {
+    total_length = align(total_length + file.second.size());
+  }
+
+  std::vector<uint8_t> buffer(total_length);
+  Header header;
+  header.magic = ArchiveFileSystem::kMagic;
+  header.version = ArchiveFileSystem::kVersion;
+  header.entry_count = uint32_t(files_.size());
+  header.table_size = table_size;
+  std::memcpy(buffer.data(), &header, sizeof(header));
+
+  std::vector<Entry> entries(table_size, Entry{0, 0, 0, 0, 0});
+  size_t name_offset = names_offset;
+  size_t data_offset = align(names_offset + names_length);
+  for (auto& file : files_) {
+    Entry entry;
+    entry.name_hash =
+        ArchiveFileSystem::HashName(file.first.c_str(), file.first.size());
+    entry.name_offset = uint32_t(name_offset);
+    entry.name_length = uint32_t(file.first.size());
+    entry.data_offset = uint32_t(data_offset);
+    entry.data_length = uint32_t(file.second.size());
+    std::memcpy(buffer.data() + name_offset, file.first.data(),
+                file.first.size());
+    if (!file.second.empty()) {
+      std::memcpy(buffer.data() + data_offset, file.second.data(),
+                  file.second.size());
+    }
+    name_offset += file.first.size();
+    data_offset = align(data_offset + file.second.size());
+
+    uint32_t slot = entry.name_hash & (table_size - 1);
+    while (entries[slot].name_length) {
+      slot = (slot + 1) & (table_size - 1);
+    }
+    entries[slot] = entry;
+  }
+  std::memcpy(buffer.data() + sizeof(Header), entries.data(),
+              entries.size() * sizeof(Entry));
+  return buffer;
+}
+
+bool ArchiveWriter::WriteToFile(const std::string& path) const {
+  auto buffer = Serialize();
+  FILE* file_handle = fopen(path.c_str(), "wb");
+  if (!file_handle) {
+    return false;
+  }
+  size_t written = fwrite(buffer.data(), 1, buffer.size(), file_handle);
+  fclose(file_handle);
+  return written == buffer.size();
+}
+
+}  // namespace io
+}  // namespace el
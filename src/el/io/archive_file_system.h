@@ -0,0 +1,107 @@
+/**
+ ******************************************************************************
+ * Elemental Forms : a lightweight user interface framework                   *
+ ******************************************************************************
+ * Copyright 2015 Ben Vanik. All rights reserved. Licensed as BSD 3-clause.   *
+ * Portions ©2011-2015 Emil Segerås: https://github.com/fruxo/turbobadger     *
+ ******************************************************************************
+ */
+
+#ifndef EL_IO_ARCHIVE_FILE_SYSTEM_H_
+#define EL_IO_ARCHIVE_FILE_SYSTEM_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "el/io/file_system.h"
+
+namespace el {
+namespace io {
+
+// A read-only file system backed by a single indexed archive file.
+// The archive contains a hash table of file names to data ranges so lookups
+// don't need to touch the host file system, and the whole archive is a single
+// (ideally memory mapped) file instead of hundreds of small ones.
+// Opened files reference the archive data directly and expose it through
+// File::data(). They must not outlive the ArchiveFileSystem.
+//
+// Archives are built offline with ArchiveWriter.
+//
+// Layout (all integers little endian):
+//   Header
+//   Entry[table_size]  open addressed hash table, empty slots have no name
+//   names              file names, not terminated
+//   data               file contents, each aligned to kDataAlignment
+class ArchiveFileSystem : public FileSystem {
+ public:
+  static const uint32_t kMagic = 0x52414C45;  // 'ELAR'
+  static const uint32_t kVersion = 1;
+  static const size_t kDataAlignment = 16;
+
+  struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entry_count;
+    uint32_t table_size;  // Power of two.
+  };
+  struct Entry {
+    uint32_t name_hash;
+    uint32_t name_offset;
+    uint32_t name_length;
+    uint32_t data_offset;
+    uint32_t data_length;
+  };
+
+  // Opens an archive from the given file. If the file data is not already in
+  // memory (see File::data()) it is read into a buffer owned by the file
+  // system. Returns nullptr if the file is not a valid archive.
+  static std::unique_ptr<ArchiveFileSystem> Open(
+      std::unique_ptr<File> archive_file);
+
+  // Hashes a file name the same way the archive index does.
+  // Backslashes are treated as forward slashes.
+  static uint32_t HashName(const char* name, size_t length);
+
+  size_t file_count() const { return header_->entry_count; }
+
+  std::unique_ptr<File> OpenRead(std::string filename) override;
+
+ private:
+  ArchiveFileSystem() = default;
+
+  bool Validate(size_t length);
+
+  std::unique_ptr<File> archive_file_;
+  std::vector<uint8_t> owned_data_;
+  const uint8_t* data_ = nullptr;
+  const Header* header_ = nullptr;
+  const Entry* entries_ = nullptr;
+};
+
+// Builds archives readable by ArchiveFileSystem.
+class ArchiveWriter {
+ public:
+  // Adds a file with the given contents, replacing any previous file with the
+  // same name. Empty names are ignored.
+  void AddFile(std::string filename, const void* data, size_t length);
+
+  // Adds all files found under root_path (recursively), named relative to it.
+  // Returns false if the directory could not be read.
+  bool AddDirectory(const std::string& root_path);
+
+  // Returns the serialized archive.
+  std::vector<uint8_t> Serialize() const;
+
+  // Serializes the archive to the given path on the host file system.
+  bool WriteToFile(const std::string& path) const;
+
+ private:
+  std::vector<std::pair<std::string, std::vector<uint8_t>>> files_;
+};
+
+}  // namespace io
+}  // namespace el
+
+#endif  // EL_IO_ARCHIVE_FILE_SYSTEM_H_
@@ -0,0 +1,28 @@
+/**
+ ******************************************************************************
+ * Elemental Forms : a lightweight user interface framework                   *
+ ******************************************************************************
+ * Copyright 2015 Ben Vanik. All rights reserved. Licensed as BSD 3-clause.   *
+ * Portions ©2011-2015 Emil Segerås: https://github.com/fruxo/turbobadger     *
+ ******************************************************************************
+ */
+
+#ifndef EL_IO_DIRECTORY_H_
+#define EL_IO_DIRECTORY_H_
+
+#include <string>
+#include <vector>
+
+namespace el {
+namespace io {
+
+// Appends the paths of all regular files under root_path (recursively) to
+// out_filenames, relative to root_path and with '/' separators.
+// Returns false if root_path could not be opened.
+bool ListFilesRecursive(const std::string& root_path,
+                        std::vector<std::string>* out_filenames);
+
+}  // namespace io
+}  // namespace el
+
+#endif  // EL_IO_DIRECTORY_H_
@@ -0,0 +1,56 @@
+/**
+ ******************************************************************************
+ * Elemental Forms : a lightweight user interface framework                   *
+ ******************************************************************************
+ * Copyright 2015 Ben Vanik. All rights reserved. Licensed as BSD 3-clause.   *
+ * Portions ©2011-2015 Emil Segerås: https://github.com/fruxo/turbobadger     *
+ ******************************************************************************
+ */
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "el/io/directory.h"
+
+namespace el {
+namespace io {
+
+namespace {
+bool ListFiles(const std::string& root_path, const std::string& relative_path,
+               std::vector<std::string>* out_filenames) {
+  DIR* dir = opendir((root_path + relative_path).c_str());
+  if (!dir) {
+    return false;
+  }
+  while (dirent* ent = readdir(dir)) {
+    std::string name = ent->d_name;
+    if (name == "." || name == "..") {
+      continue;
+    }
+    std::string relative_name = relative_path + name;
+    struct stat file_stat;
+    if (stat((root_path + relative_name).c_str(), &file_stat) == -1) {
+      continue;
+    }
+    if (S_ISDIR(file_stat.st_mode)) {
+      ListFiles(root_path, relative_name + '/', out_filenames);
+    } else if (S_ISREG(file_stat.st_mode)) {
+      out_filenames->push_back(relative_name);
+    }
+  }
+  closedir(dir);
+  return true;
+}
+}  // namespace
+
+bool ListFilesRecursive(const std::string& root_path,
+                        std::vector<std::string>* out_filenames) {
+  std::string prefix = root_path;
+  if (!prefix.empty() && prefix.back() != '/' && prefix.back() != '\\') {
+    prefix += '/';
+  }
+  return ListFiles(prefix, "", out_filenames);
+}
+
+}  // namespace io
+}  // namespace el
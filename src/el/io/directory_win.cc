@@ -0,0 +1,58 @@
+/**
+ ******************************************************************************
+ * Elemental Forms : a lightweight user interface framework                   *
+ ******************************************************************************
+ * Copyright 2015 Ben Vanik. All rights reserved. Licensed as BSD 3-clause.   *
+ * Portions ©2011-2015 Emil Segerås: https://github.com/fruxo/turbobadger     *
+ ******************************************************************************
+ */
+
+#include "el/io/directory.h"
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#define NOMINMAX
+#include <SDKDDKVer.h>
+#include <windows.h>
+
+namespace el {
+namespace io {
+
+namespace {
+bool ListFiles(const std::string& root_path, const std::string& relative_path,
+               std::vector<std::string>* out_filenames) {
+  WIN32_FIND_DATAA find_data;
+  HANDLE find_handle = ::FindFirstFileA(
+      (root_path + relative_path + "*").c_str(), &find_data);
+  if (find_handle == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  do {
+    std::string name = find_data.cFileName;
+    if (name == "." || name == "..") {
+      continue;
+    }
+    std::string relative_name = relative_path + name;
+    if (find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+      ListFiles(root_path, relative_name + '/', out_filenames);
+    } else {
+      out_filenames->push_back(relative_name);
+    }
+  } while (::FindNextFileA(find_handle, &find_data));
+  ::FindClose(find_handle);
+  return true;
+}
+}  // namespace
+
+bool ListFilesRecursive(const std::string& root_path,
+                        std::vector<std::string>* out_filenames) {
+  std::string prefix = root_path;
+  if (!prefix.empty() && prefix.back() != '/' && prefix.back() != '\\') {
+    prefix += '/';
+  }
+  return ListFiles(prefix, "", out_filenames);
+}
+
+}  // namespace io
+}  // namespace el
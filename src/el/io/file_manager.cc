@@ -39,6 +39,9 @@ std::unique_ptr<std::vector<uint8_t>> FileManager::ReadContents(
   if (!file) {
     return nullptr;
   }
+  if (auto data = file->data()) {
+    return std::make_unique<std::vector<uint8_t>>(data, data + file->size());
+  }
   auto buffer = std::make_unique<std::vector<uint8_t>>(file->size());
   file->Read(buffer->data(), buffer->size());
   return buffer;
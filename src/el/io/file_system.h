@@ -10,6 +10,7 @@
 #ifndef EL_IO_FILE_SYSTEM_H_
 #define EL_IO_FILE_SYSTEM_H_
 
+#include <cstdint>
 #include <memory>
 #include <string>
 
@@ -25,12 +26,21 @@ class File {
   virtual size_t size() const = 0;
   virtual size_t Read(void* buffer, size_t length) = 0;
 
+  // Returns the entire file contents (size() bytes) if they are already in
+  // memory, such as for memory mapped or embedded files. Returns nullptr if
+  // the contents must be fetched with Read.
+  // Callers can use this to avoid copying the data.
+  virtual const uint8_t* data() const { return nullptr; }
+
  protected:
   File() = default;
 };
 
 class FileSystem {
  public:
+  // Opens the given file for reading, or returns nullptr if not found.
+  // This may be called from multiple threads at once (f.ex when decoding skin
+  // bitmaps in parallel).
   virtual std::unique_ptr<File> OpenRead(std::string filename) = 0;
 };
 
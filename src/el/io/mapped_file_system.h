@@ -0,0 +1,38 @@
+/**
+ ******************************************************************************
+ * Elemental Forms : a lightweight user interface framework                   *
+ ******************************************************************************
+ * Copyright 2015 Ben Vanik. All rights reserved. Licensed as BSD 3-clause.   *
+ * Portions ©2011-2015 Emil Segerås: https://github.com/fruxo/turbobadger     *
+ ******************************************************************************
+ */
+
+#ifndef EL_IO_MAPPED_FILE_SYSTEM_H_
+#define EL_IO_MAPPED_FILE_SYSTEM_H_
+
+#include <memory>
+#include <string>
+
+#include "el/io/file_system.h"
+
+namespace el {
+namespace io {
+
+// A file system rooted at root_path that memory maps files instead of reading
+// them. Opened files expose their contents through File::data() so that
+// consumers (image decoding, parsing, ArchiveFileSystem) can use the data
+// without copying it.
+class MappedFileSystem : public FileSystem {
+ public:
+  explicit MappedFileSystem(std::string root_path);
+
+  std::unique_ptr<File> OpenRead(std::string filename) override;
+
+ private:
+  std::string root_path_;
+};
+
+}  // namespace io
+}  // namespace el
+
+#endif  // EL_IO_MAPPED_FILE_SYSTEM_H_
@@ -0,0 +1,92 @@
+/**
+ ******************************************************************************
+ * Elemental Forms : a lightweight user interface framework                   *
+ ******************************************************************************
+ * Copyright 2015 Ben Vanik. All rights reserved. Licensed as BSD 3-clause.   *
+ * Portions ©2011-2015 Emil Segerås: https://github.com/fruxo/turbobadger     *
+ ******************************************************************************
+ */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "el/io/mapped_file_system.h"
+
+namespace el {
+namespace io {
+
+namespace {
+class MappedFile : public File {
+ public:
+  MappedFile(void* mapping, size_t length)
+      : mapping_(mapping), length_(length) {}
+  ~MappedFile() override {
+    if (mapping_) {
+      munmap(mapping_, length_);
+    }
+  }
+
+  size_t size() const override { return length_; }
+
+  size_t Read(void* buffer, size_t length) override {
+    size_t to_read = std::min(length_ - position_, length);
+    if (!to_read) {
+      return 0;
+    }
+    std::memcpy(buffer, data() + position_, to_read);
+    position_ += to_read;
+    return to_read;
+  }
+
+  const uint8_t* data() const override {
+    return reinterpret_cast<const uint8_t*>(mapping_);
+  }
+
+ private:
+  void* mapping_;
+  size_t length_;
+  size_t position_ = 0;
+};
+}  // namespace
+
+MappedFileSystem::MappedFileSystem(std::string root_path)
+    : root_path_(std::move(root_path)) {
+  auto last_char = root_path_[root_path_.size() - 1];
+  if (last_char != '/' && last_char != '\\') {
+    root_path_ += '/';
+  }
+}
+
+std::unique_ptr<File> MappedFileSystem::OpenRead(std::string filename) {
+  auto full_path = root_path_ + filename;
+  int fd = open(full_path.c_str(), O_RDONLY);
+  if (fd == -1) {
+    return nullptr;
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) == -1 || !S_ISREG(file_stat.st_mode)) {
+    close(fd);
+    return nullptr;
+  }
+  size_t length = size_t(file_stat.st_size);
+  void* mapping = nullptr;
+  if (length) {
+    // Empty files can't be mapped; they are returned without a mapping.
+    mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+      close(fd);
+      return nullptr;
+    }
+  }
+  // The mapping stays valid after the descriptor is closed.
+  close(fd);
+  return std::make_unique<MappedFile>(mapping, length);
+}
+
+}  // namespace io
+}  // namespace el
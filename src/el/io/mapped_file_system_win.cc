@@ -0,0 +1,108 @@
+/**
+ ******************************************************************************
+ * Elemental Forms : a lightweight user interface framework                   *
+ ******************************************************************************
+ * Copyright 2015 Ben Vanik. All rights reserved. Licensed as BSD 3-clause.   *
+ * Portions ©2011-2015 Emil Segerås: https://github.com/fruxo/turbobadger     *
+ ******************************************************************************
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "el/io/mapped_file_system.h"
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#define NOMINMAX
+#include <SDKDDKVer.h>
+#include <windows.h>
+
+namespace el {
+namespace io {
+
+namespace {
+class MappedFile : public File {
+ public:
+  MappedFile(HANDLE mapping_handle, void* view, size_t length)
+      : mapping_handle_(mapping_handle), view_(view), length_(length) {}
+  ~MappedFile() override {
+    if (view_) {
+      ::UnmapViewOfFile(view_);
+    }
+    if (mapping_handle_) {
+      ::CloseHandle(mapping_handle_);
+    }
+  }
+
+  size_t size() const override { return length_; }
+
+  size_t Read(void* buffer, size_t length) override {
+    size_t to_read = std::min(length_ - position_, length);
+    if (!to_read) {
+      return 0;
+    }
+    std::memcpy(buffer, data() + position_, to_read);
+    position_ += to_read;
+    return to_read;
+  }
+
+  const uint8_t* data() const override {
+    return reinterpret_cast<const uint8_t*>(view_);
+  }
+
+ private:
+  HANDLE mapping_handle_;
+  void* view_;
+  size_t length_;
+  size_t position_ = 0;
+};
+}  // namespace
+
+MappedFileSystem::MappedFileSystem(std::string root_path)
+    : root_path_(std::move(root_path)) {
+  auto last_char = root_path_[root_path_.size() - 1];
+  if (last_char != '/' && last_char != '\\') {
+    root_path_ += '/';
+  }
+}
+
+std::unique_ptr<File> MappedFileSystem::OpenRead(std::string filename) {
+  auto full_path = root_path_ + filename;
+  HANDLE file_handle =
+      ::CreateFileA(full_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file_handle == INVALID_HANDLE_VALUE) {
+    return nullptr;
+  }
+  LARGE_INTEGER file_size;
+  if (!::GetFileSizeEx(file_handle, &file_size)) {
+    ::CloseHandle(file_handle);
+    return nullptr;
+  }
+  size_t length = size_t(file_size.QuadPart);
+  HANDLE mapping_handle = nullptr;
+  void* view = nullptr;
+  if (length) {
+    // Empty files can't be mapped; they are returned without a mapping.
+    mapping_handle = ::CreateFileMappingA(file_handle, nullptr, PAGE_READONLY,
+                                          0, 0, nullptr);
+    if (mapping_handle) {
+      view = ::MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+    }
+    if (!view) {
+      if (mapping_handle) {
+        ::CloseHandle(mapping_handle);
+      }
+      ::CloseHandle(file_handle);
+      return nullptr;
+    }
+  }
+  // The mapping keeps the file open, so the file handle can be closed.
+  ::CloseHandle(file_handle);
+  return std::make_unique<MappedFile>(mapping_handle, view, length);
+}
+
+}  // namespace io
+}  // namespace el
@@ -7,6 +7,10 @@
  ******************************************************************************
  */
 
+#include <algorithm>
+#include <cctype>
+#include <numeric>
+
 #include "el/elements/icon_box.h"
 #include "el/elements/layout_box.h"
 #include "el/elements/menu_form.h"
@@ -14,6 +18,7 @@
 #include "el/list_item.h"
 #include "el/parsing/parse_node.h"
 #include "el/util/debug.h"
+#include "el/util/parallel.h"
 #include "el/util/string.h"
 
 namespace el {
@@ -198,6 +203,181 @@ void ListItemSource::InvokeAllItemsRemoved() {
   }
 }
 
+namespace {
+// Items searched by each worker when filtering in parallel.
+const size_t kFilterChunkSize = 8192;
+
+// Uppercases the string the same way util::stristr compares characters.
+std::string FoldCase(const char* str) {
+  std::string folded = str ? str : "";
+  for (auto& c : folded) {
+    c = static_cast<char>(std::toupper(c));
+  }
+  return folded;
+}
+}  // namespace
+
+void ListItemIndex::Reset() {
+  is_built_ = false;
+  has_filtered_ = false;
+  strings_.clear();
+  folded_strings_.clear();
+  sorted_.clear();
+  filtered_.clear();
+}
+
+void ListItemIndex::OnItemChanged(ListItemSource* source, size_t index) {
+  if (!is_built_) {
+    return;
+  }
+  has_filtered_ = false;
+  SetItemKey(source, index);
+  if (sort_ != Sort::kNone) {
+    // The string may have changed so the item may need to move.
+    sorted_.erase(std::find(sorted_.begin(), sorted_.end(), index));
+    InsertSorted(index);
+  }
+}
+
+void ListItemIndex::OnItemAdded(ListItemSource* source, size_t index) {
+  if (!is_built_) {
+    return;
+  }
+  has_filtered_ = false;
+  strings_.emplace(strings_.begin() + index);
+  folded_strings_.emplace(folded_strings_.begin() + index);
+  SetItemKey(source, index);
+  for (auto& sorted_index : sorted_) {
+    if (sorted_index >= index) {
+      ++sorted_index;
+    }
+  }
+  InsertSorted(index);
+}
+
+void ListItemIndex::OnItemRemoved(size_t index) {
+  if (!is_built_) {
+    return;
+  }
+  has_filtered_ = false;
+  strings_.erase(strings_.begin() + index);
+  folded_strings_.erase(folded_strings_.begin() + index);
+  sorted_.erase(std::find(sorted_.begin(), sorted_.end(), index));
+  for (auto& sorted_index : sorted_) {
+    if (sorted_index > index) {
+      --sorted_index;
+    }
+  }
+}
+
+const std::vector<size_t>& ListItemIndex::Filter(ListItemSource* source,
+                                                 const std::string& filter) {
+  if (!is_built_ || strings_.size() != source->size()) {
+    Build(source);
+  } else if (sort_ != source->sort()) {
+    // Sorting was changed on the source without any notification.
+    sort_ = source->sort();
+    std::sort(sorted_.begin(), sorted_.end(),
+              [this](size_t a, size_t b) { return IsLess(a, b); });
+    has_filtered_ = false;
+  }
+  if (filter.empty()) {
+    return sorted_;
+  }
+
+  if (!source->uses_default_filter()) {
+    // The source may look at anything, so just ask it about every item.
+    filtered_.clear();
+    for (size_t index : sorted_) {
+      if (source->Filter(index, filter)) {
+        filtered_.push_back(index);
+      }
+    }
+    has_filtered_ = false;
+    return filtered_;
+  }
+
+  // Anything matching a filter also matches all of its substrings, so if the
+  // new filter contains the previous one only the previous matches need to be
+  // searched.
+  std::string folded_filter = FoldCase(filter.c_str());
+  std::vector<size_t> candidates;
+  if (has_filtered_ &&
+      folded_filter.find(filtered_filter_) != std::string::npos) {
+    candidates.swap(filtered_);
+  } else {
+    candidates = sorted_;
+  }
+
+  size_t chunk_count =
+      (candidates.size() + kFilterChunkSize - 1) / kFilterChunkSize;
+  std::vector<std::vector<size_t>> chunk_matches(chunk_count);
+  auto filter_chunk = [&](size_t chunk) {
+    size_t begin = chunk * kFilterChunkSize;
+    size_t end = std::min(begin + kFilterChunkSize, candidates.size());
+    auto& matches = chunk_matches[chunk];
+    for (size_t i = begin; i < end; ++i) {
+      size_t index = candidates[i];
+      if (folded_strings_[index].find(folded_filter) != std::string::npos) {
+        matches.push_back(index);
+      }
+    }
+  };
+  // Only small sources are filtered inline.
+  util::ParallelFor(chunk_count, filter_chunk, 4);
+
+  filtered_.clear();
+  for (auto& matches : chunk_matches) {
+    filtered_.insert(filtered_.end(), matches.begin(), matches.end());
+  }
+  filtered_filter_ = std::move(folded_filter);
+  has_filtered_ = true;
+  return filtered_;
+}
+
+void ListItemIndex::Build(ListItemSource* source) {
+  Reset();
+  size_t count = source->size();
+  strings_.resize(count);
+  folded_strings_.resize(count);
+  for (size_t i = 0; i < count; ++i) {
+    SetItemKey(source, i);
+  }
+  sort_ = source->sort();
+  sorted_.resize(count);
+  std::iota(sorted_.begin(), sorted_.end(), size_t(0));
+  if (sort_ != Sort::kNone) {
+    std::sort(sorted_.begin(), sorted_.end(),
+              [this](size_t a, size_t b) { return IsLess(a, b); });
+  }
+  is_built_ = true;
+}
+
+void ListItemIndex::SetItemKey(ListItemSource* source, size_t index) {
+  const char* str = source->GetItemString(index);
+  strings_[index] = str ? str : "";
+  folded_strings_[index] = FoldCase(str);
+}
+
+void ListItemIndex::InsertSorted(size_t index) {
+  auto it = std::upper_bound(
+      sorted_.begin(), sorted_.end(), index,
+      [this](size_t a, size_t b) { return IsLess(a, b); });
+  sorted_.insert(it, index);
+}
+
+bool ListItemIndex::IsLess(size_t a, size_t b) const {
+  if (sort_ == Sort::kNone) {
+    return a < b;
+  }
+  // Items with equal strings keep their source order so the order is stable.
+  int value = strings_[a].compare(strings_[b]);
+  if (!value) {
+    return a < b;
+  }
+  return sort_ == Sort::kDescending ? value > 0 : value < 0;
+}
+
 void GenericStringItemSource::ReadItemNodes(
     el::parsing::ParseNode* parent_node,
     GenericStringItemSource* target_source) {
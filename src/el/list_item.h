@@ -89,6 +89,10 @@ class ListItemSource {
   // By default, it returns true if GetItemString contains filter.
   virtual bool Filter(size_t index, const std::string& filter);
 
+  // Returns true if Filter is the default, so list elements may match against
+  // their cached copies of the item strings instead of calling it.
+  virtual bool uses_default_filter() const { return false; }
+
   // Gets the string of a item.
   // If a item has more than one string, return the one that should be used for
   // inline-find (pressing keys in the list will scroll to the item starting
@@ -129,6 +133,48 @@ class ListItemSource {
   Sort m_sort = Sort::kNone;
 };
 
+// Keeps the sorted order and cached filter keys for the items of a
+// ListItemSource, so that list elements can filter large sources quickly.
+// The item strings are read once and then kept up to date by the item
+// notifications, which the owning ListItemObserver must forward.
+//
+// Filtering uses multiple threads for large sources, and when a filter extends
+// the previous one only the previous matches are searched again.
+class ListItemIndex {
+ public:
+  // Drops all cached data. It's rebuilt on the next call to Filter.
+  void Reset();
+
+  void OnItemChanged(ListItemSource* source, size_t index);
+  void OnItemAdded(ListItemSource* source, size_t index);
+  void OnItemRemoved(size_t index);
+
+  // Returns the indices of the items matching filter (or all items if filter
+  // is empty), in the sort order of the source.
+  // The result is valid until the next call to any other method.
+  const std::vector<size_t>& Filter(ListItemSource* source,
+                                    const std::string& filter);
+
+ private:
+  void Build(ListItemSource* source);
+  void SetItemKey(ListItemSource* source, size_t index);
+  void InsertSorted(size_t index);
+  bool IsLess(size_t a, size_t b) const;
+
+  bool is_built_ = false;
+  Sort sort_ = Sort::kNone;
+  // Item strings used for sorting.
+  std::vector<std::string> strings_;
+  // Uppercase item strings used for case insensitive filtering.
+  std::vector<std::string> folded_strings_;
+  // All item indices in sort order.
+  std::vector<size_t> sorted_;
+  // Matches for filtered_filter_, valid if has_filtered_ is set.
+  std::vector<size_t> filtered_;
+  std::string filtered_filter_;
+  bool has_filtered_ = false;
+};
+
 // An item provider for list elements (ListBox and DropDownButton).
 // It stores items of the type specified by the template in an array.
 template <class T>
@@ -159,7 +205,7 @@ class ListItemSourceList : public ListItemSource {
 
   // Adds a new item at the given index.
   void insert(size_t index, std::unique_ptr<T> item) {
-    items_.insert(index, std::move(item));
+    items_.insert(items_.begin() + index, std::move(item));
     InvokeItemAdded(index);
   }
 
@@ -236,6 +282,9 @@ class GenericStringItem {
 // An item source list providing items of type GenericStringItem.
 class GenericStringItemSource : public ListItemSourceList<GenericStringItem> {
  public:
+  // Subclasses overriding Filter must override this to return false.
+  bool uses_default_filter() const override { return true; }
+
   static void ReadItemNodes(el::parsing::ParseNode* parent_node,
                             GenericStringItemSource* target_source);
 };
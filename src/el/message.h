@@ -10,6 +10,7 @@
 #ifndef EL_MESSAGE_H_
 #define EL_MESSAGE_H_
 
+#include <cstddef>
 #include <memory>
 
 #include "el/id.h"
@@ -35,15 +36,10 @@ struct MessageData : public util::TypedObject {
   TBID id2;
 };
 
-// Should never be created or subclassed anywhere except in Message.
-// It's only purpose is to add a extra typed link for Message, since it needs
-// to be added in multiple lists.
-class MessageLink : public util::IntrusiveListEntry<MessageLink> {};
-
 // A message created and owned by MessageHandler.
 // It carries a message id, and may also carry a MessageData with additional
 // parameters.
-class Message : public util::IntrusiveListEntry<Message>, public MessageLink {
+class Message : public util::IntrusiveListEntry<Message> {
  public:
   Message(TBID message_id, std::unique_ptr<MessageData> data,
           uint64_t fire_time_millis, MessageHandler* message_handler)
@@ -53,6 +49,11 @@ class Message : public util::IntrusiveListEntry<Message>, public MessageLink {
         message_handler_(message_handler) {}
   ~Message() = default;
 
+  // Messages are allocated from a pool shared by all message handlers, since
+  // they are short lived and posted very frequently.
+  static void* operator new(size_t size);
+  static void operator delete(void* ptr);
+
   const TBID& message_id() const { return message_id_; }
   // The message data, or nullptr if no data is set.
   MessageData* data() const { return data_.get(); }
@@ -62,10 +63,20 @@ class Message : public util::IntrusiveListEntry<Message>, public MessageLink {
   MessageHandler* message_handler() const { return message_handler_; }
 
  private:
+  friend class MessageHandler;
+  friend class MessageQueue;
+  static const size_t kNotDelayed = ~size_t(0);
+
   TBID message_id_;
   std::unique_ptr<MessageData> data_;
   uint64_t fire_time_millis_;
   MessageHandler* message_handler_;
+  // Time the message was posted, used for latency stats.
+  uint64_t post_time_millis_ = 0;
+  // Post order, used to deliver messages with equal fire times in order.
+  uint64_t sequence_ = 0;
+  // Index in the delayed message heap, or kNotDelayed.
+  size_t heap_index_ = kNotDelayed;
 };
 
 }  // namespace el
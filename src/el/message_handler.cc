@@ -7,22 +7,188 @@
  ******************************************************************************
  */
 
+#include <algorithm>
+#include <atomic>
+#include <cassert>
 #include <cstddef>
+#include <vector>
 
 #include "el/message_handler.h"
+#include "el/util/intrusive_list.h"
 #include "el/util/metrics.h"
 #include "el/util/timer.h"
 
 namespace el {
 
-// List of all delayed messages.
-util::IntrusiveList<MessageLink> g_all_delayed_messages;
-// List of all nondelayed messages.
-util::IntrusiveList<MessageLink> g_all_normal_messages;
+namespace {
+
+// Free list of message allocations. Blocks are never returned to the system
+// since the number of pending messages usually stays around its peak.
+union MessageBlock {
+  MessageBlock* next_free;
+  alignas(Message) char storage[sizeof(Message)];
+};
+MessageBlock* g_free_message_blocks = nullptr;
+const size_t kMessageBlocksPerChunk = 64;
+
+}  // namespace
+
+void* Message::operator new(size_t size) {
+  assert(size == sizeof(Message));
+  if (!g_free_message_blocks) {
+    auto chunk = new MessageBlock[kMessageBlocksPerChunk];
+    for (size_t i = 0; i < kMessageBlocksPerChunk; ++i) {
+      chunk[i].next_free = g_free_message_blocks;
+      g_free_message_blocks = &chunk[i];
+    }
+  }
+  MessageBlock* block = g_free_message_blocks;
+  g_free_message_blocks = block->next_free;
+  return block;
+}
+
+void Message::operator delete(void* ptr) {
+  if (!ptr) {
+    return;
+  }
+  auto block = static_cast<MessageBlock*>(ptr);
+  block->next_free = g_free_message_blocks;
+  g_free_message_blocks = block;
+}
+
+// The global message queues shared by all MessageHandlers.
+class MessageQueue {
+ public:
+  // Delayed messages, as a binary min-heap ordered by fire time and then by
+  // post order.
+  std::vector<Message*> delayed;
+  // Nondelayed messages in post order.
+  util::IntrusiveList<Message> normal;
+  uint64_t next_sequence = 1;
+  MessageHandler::Stats stats;
+
+  void PushDelayed(Message* msg) {
+    msg->heap_index_ = delayed.size();
+    delayed.push_back(msg);
+    SiftUp(msg->heap_index_);
+    stats.delayed_queue_depth = delayed.size();
+    stats.peak_delayed_queue_depth =
+        std::max(stats.peak_delayed_queue_depth, delayed.size());
+  }
+
+  void RemoveDelayed(Message* msg) {
+    size_t index = msg->heap_index_;
+    msg->heap_index_ = Message::kNotDelayed;
+    Message* last = delayed.back();
+    delayed.pop_back();
+    stats.delayed_queue_depth = delayed.size();
+    if (last == msg) {
+      return;
+    }
+    delayed[index] = last;
+    last->heap_index_ = index;
+    SiftUp(index);
+    SiftDown(last->heap_index_);
+  }
+
+  void PushNormal(Message* msg) {
+    normal.AddLast(msg);
+    ++stats.normal_queue_depth;
+    stats.peak_normal_queue_depth =
+        std::max(stats.peak_normal_queue_depth, stats.normal_queue_depth);
+  }
+
+  void RemoveNormal(Message* msg) {
+    normal.Remove(msg);
+    --stats.normal_queue_depth;
+  }
+
+  void RecordDispatch(uint64_t due_time, uint64_t now) {
+    uint64_t latency = now > due_time ? now - due_time : 0;
+    ++stats.dispatched_count;
+    stats.total_dispatch_latency_ms += latency;
+    stats.max_dispatch_latency_ms =
+        std::max(stats.max_dispatch_latency_ms, latency);
+  }
+
+ private:
+  static bool IsEarlier(const Message* a, const Message* b) {
+    if (a->fire_time_millis_ != b->fire_time_millis_) {
+      return a->fire_time_millis_ < b->fire_time_millis_;
+    }
+    return a->sequence_ < b->sequence_;
+  }
+
+  void Place(Message* msg, size_t index) {
+    delayed[index] = msg;
+    msg->heap_index_ = index;
+  }
+
+  void SiftUp(size_t index) {
+    Message* msg = delayed[index];
+    while (index) {
+      size_t parent = (index - 1) / 2;
+      if (!IsEarlier(msg, delayed[parent])) {
+        break;
+      }
+      Place(delayed[parent], index);
+      index = parent;
+    }
+    Place(msg, index);
+  }
+
+  void SiftDown(size_t index) {
+    Message* msg = delayed[index];
+    size_t count = delayed.size();
+    while (true) {
+      size_t child = index * 2 + 1;
+      if (child >= count) {
+        break;
+      }
+      if (child + 1 < count && IsEarlier(delayed[child + 1], delayed[child])) {
+        ++child;
+      }
+      if (!IsEarlier(delayed[child], msg)) {
+        break;
+      }
+      Place(delayed[child], index);
+      index = child;
+    }
+    Place(msg, index);
+  }
+};
+
+MessageQueue g_message_queue;
+
+namespace {
+
+// A message posted with PostMessageFromAnyThread waiting in the inbox.
+struct InboxEntry {
+  InboxEntry* next;
+  MessageHandler* message_handler;
+  // TBID isn't used since it isn't safe to copy across threads in debug
+  // builds.
+  uint32_t message_id;
+  std::unique_ptr<MessageData> data;
+  uint64_t post_time_millis;
+};
+
+// Multiple producer, single consumer inbox. Producers push onto the head of a
+// singly linked stack, and the consumer takes the whole stack at once and
+// reverses it to get the post order.
+std::atomic<InboxEntry*> g_inbox_head(nullptr);
+
+std::atomic<void (*)()> g_wake_up_callback(nullptr);
+
+}  // namespace
 
 MessageHandler::MessageHandler() = default;
 
-MessageHandler::~MessageHandler() { DeleteAllMessages(); }
+MessageHandler::~MessageHandler() {
+  // Messages for this handler may be waiting in the inbox.
+  DrainInbox();
+  DeleteAllMessages();
+}
 
 void MessageHandler::PostMessageDelayed(TBID message_id,
                                         std::unique_ptr<MessageData> data,
@@ -35,39 +201,17 @@ void MessageHandler::PostMessageOnTime(TBID message_id,
                                        std::unique_ptr<MessageData> data,
                                        uint64_t fire_time) {
   Message* msg = new Message(message_id, std::move(data), fire_time, this);
-  // Find the message that is already in the list that should fire later, so we
-  // can insert msg just before that. (Always keep the list ordered after fire
-  // time).
-
-  // NOTE: If another message is added during OnMessageReceived, it might or
-  // might not be fired in the right order compared to other delayed messages,
-  // depending on if it's inserted before or after the message being processed!
-
-  Message* later_msg = nullptr;
-  MessageLink* link = g_all_delayed_messages.GetFirst();
-  while (link) {
-    Message* msg_in_list = static_cast<Message*>(link);
-    if (msg_in_list->fire_time_millis() > msg->fire_time_millis()) {
-      later_msg = msg_in_list;
-      break;
-    }
-    link = link->GetNext();
-  }
+  msg->sequence_ = g_message_queue.next_sequence++;
+  g_message_queue.PushDelayed(msg);
 
-  // Add it to the global list in the right order.
-  if (later_msg) {
-    g_all_delayed_messages.AddBefore(msg, later_msg);
-  } else {
-    g_all_delayed_messages.AddLast(msg);
-  }
-
-  // Add it to the list in messagehandler.
-  m_messages.AddLast(msg);
+  // Add it to the index in messagehandler.
+  m_messages_by_id[message_id].push_back(msg);
+  ++m_message_count;
 
   // If we added it first and there's no normal messages, the next fire time has
   // changed and we have to reschedule the timer.
-  if (!g_all_normal_messages.GetFirst() &&
-      g_all_delayed_messages.GetFirst() == msg) {
+  if (!g_message_queue.normal.GetFirst() &&
+      g_message_queue.delayed.front() == msg) {
     util::RescheduleTimer(msg->fire_time_millis());
   }
 }
@@ -75,39 +219,104 @@ void MessageHandler::PostMessageOnTime(TBID message_id,
 void MessageHandler::PostMessage(TBID message_id,
                                  std::unique_ptr<MessageData> data) {
   Message* msg = new Message(message_id, std::move(data), 0, this);
-  g_all_normal_messages.AddLast(msg);
-  m_messages.AddLast(msg);
+  msg->post_time_millis_ = util::GetTimeMS();
+  QueueNormalMessage(msg);
 
   // If we added it and there was no messages, the next fire time has
   // changed and we have to rescedule the timer.
-  if (g_all_normal_messages.GetFirst() == msg) {
+  if (g_message_queue.normal.GetFirst() == msg) {
     util::RescheduleTimer(0);
   }
 }
 
-Message* MessageHandler::GetMessageById(TBID message_id) {
-  auto iter = m_messages.IterateForward();
-  while (Message* msg = iter.GetAndStep()) {
-    if (msg->message_id() == message_id) {
-      return msg;
+void MessageHandler::PostMessageFromAnyThread(
+    const TBID& message_id, std::unique_ptr<MessageData> data) {
+  auto entry = new InboxEntry();
+  entry->message_handler = this;
+  entry->message_id = message_id;
+  entry->data = std::move(data);
+  entry->post_time_millis = util::GetTimeMS();
+  entry->next = g_inbox_head.load(std::memory_order_relaxed);
+  while (!g_inbox_head.compare_exchange_weak(entry->next, entry,
+                                             std::memory_order_release,
+                                             std::memory_order_relaxed)) {
+  }
+
+  // Only the post that made the inbox non-empty needs to wake the host.
+  if (!entry->next) {
+    util::RescheduleTimer(0);
+    if (auto wake_up = g_wake_up_callback.load(std::memory_order_acquire)) {
+      wake_up();
     }
   }
-  return nullptr;
+}
+
+// static
+void MessageHandler::set_wake_up_callback(void (*callback)()) {
+  g_wake_up_callback.store(callback, std::memory_order_release);
+}
+
+// static
+void MessageHandler::DrainInbox() {
+  if (!g_inbox_head.load(std::memory_order_relaxed)) {
+    return;
+  }
+  InboxEntry* entry = g_inbox_head.exchange(nullptr, std::memory_order_acquire);
+  // Reverse to get the entries in post order.
+  InboxEntry* first = nullptr;
+  while (entry) {
+    InboxEntry* next = entry->next;
+    entry->next = first;
+    first = entry;
+    entry = next;
+  }
+  while (first) {
+    InboxEntry* next = first->next;
+    Message* msg = new Message(TBID(first->message_id), std::move(first->data),
+                               0, first->message_handler);
+    msg->post_time_millis_ = first->post_time_millis;
+    first->message_handler->QueueNormalMessage(msg);
+    delete first;
+    first = next;
+  }
+}
+
+void MessageHandler::QueueNormalMessage(Message* msg) {
+  msg->sequence_ = g_message_queue.next_sequence++;
+  g_message_queue.PushNormal(msg);
+  m_messages_by_id[msg->message_id()].push_back(msg);
+  ++m_message_count;
+}
+
+Message* MessageHandler::GetMessageById(TBID message_id) {
+  auto it = m_messages_by_id.find(message_id);
+  if (it == m_messages_by_id.end() || it->second.empty()) {
+    return nullptr;
+  }
+  return it->second.front();
+}
+
+void MessageHandler::RemoveFromIndex(Message* msg) {
+  // Entries are kept when they become empty, since handlers tend to post the
+  // same few ids over and over.
+  auto& messages = m_messages_by_id[msg->message_id()];
+  messages.erase(std::find(messages.begin(), messages.end(), msg));
+  --m_message_count;
 }
 
 void MessageHandler::DeleteMessage(Message* msg) {
   // Ensure the same message handler.
   assert(msg->message_handler() == this);
 
-  // Remove from global list (g_all_delayed_messages or g_all_normal_messages)
-  if (g_all_delayed_messages.ContainsLink(msg)) {
-    g_all_delayed_messages.Remove(msg);
-  } else if (g_all_normal_messages.ContainsLink(msg)) {
-    g_all_normal_messages.Remove(msg);
+  // Remove from the global queue.
+  if (msg->heap_index_ != Message::kNotDelayed) {
+    g_message_queue.RemoveDelayed(msg);
+  } else {
+    g_message_queue.RemoveNormal(msg);
   }
 
-  // Remove from local list
-  m_messages.Remove(msg);
+  // Remove from local index.
+  RemoveFromIndex(msg);
 
   delete msg;
 
@@ -116,39 +325,46 @@ void MessageHandler::DeleteMessage(Message* msg) {
 }
 
 void MessageHandler::DeleteAllMessages() {
-  while (Message* msg = m_messages.GetFirst()) {
-    DeleteMessage(msg);
+  for (auto& it : m_messages_by_id) {
+    while (!it.second.empty()) {
+      DeleteMessage(it.second.back());
+    }
   }
 }
 
 // static
 void MessageHandler::ProcessMessages() {
+  DrainInbox();
+
   // Handle delayed messages.
-  auto iter = g_all_delayed_messages.IterateForward();
-  while (Message* msg = static_cast<Message*>(iter.GetAndStep())) {
-    if (util::GetTimeMS() >= msg->fire_time_millis()) {
-      // Remove from global list.
-      g_all_delayed_messages.Remove(msg);
-      // Remove from local list.
-      msg->message_handler()->m_messages.Remove(msg);
-
-      msg->message_handler()->OnMessageReceived(msg);
-
-      delete msg;
-    } else {
-      // Since the list is sorted, all remaining messages should fire later.
+  auto& delayed = g_message_queue.delayed;
+  while (!delayed.empty()) {
+    Message* msg = delayed.front();
+    uint64_t now = util::GetTimeMS();
+    if (now < msg->fire_time_millis()) {
+      // Since the heap is ordered, all remaining messages should fire later.
       break;
     }
+    // Remove from global queue.
+    g_message_queue.RemoveDelayed(msg);
+    // Remove from local index.
+    msg->message_handler()->RemoveFromIndex(msg);
+
+    g_message_queue.RecordDispatch(msg->fire_time_millis(), now);
+    msg->message_handler()->OnMessageReceived(msg);
+
+    delete msg;
   }
 
   // Handle normal messages.
-  iter = g_all_normal_messages.IterateForward();
-  while (Message* msg = static_cast<Message*>(iter.GetAndStep())) {
-    // Remove from global list.
-    g_all_normal_messages.Remove(msg);
-    // Remove from local list.
-    msg->message_handler()->m_messages.Remove(msg);
+  auto iter = g_message_queue.normal.IterateForward();
+  while (Message* msg = iter.GetAndStep()) {
+    // Remove from global queue.
+    g_message_queue.RemoveNormal(msg);
+    // Remove from local index.
+    msg->message_handler()->RemoveFromIndex(msg);
 
+    g_message_queue.RecordDispatch(msg->post_time_millis_, util::GetTimeMS());
     msg->message_handler()->OnMessageReceived(msg);
 
     delete msg;
@@ -157,17 +373,31 @@ void MessageHandler::ProcessMessages() {
 
 // static
 uint64_t MessageHandler::GetNextMessageFireTime() {
-  if (g_all_normal_messages.GetFirst()) {
+  if (g_message_queue.normal.GetFirst() ||
+      g_inbox_head.load(std::memory_order_relaxed)) {
     return 0;
   }
 
-  if (g_all_delayed_messages.GetFirst()) {
-    auto first_delayed_msg =
-        static_cast<Message*>(g_all_delayed_messages.GetFirst());
-    return first_delayed_msg->fire_time_millis();
+  if (!g_message_queue.delayed.empty()) {
+    return g_message_queue.delayed.front()->fire_time_millis();
   }
 
   return kNotSoon;
 }
 
+// static
+const MessageHandler::Stats& MessageHandler::stats() {
+  return g_message_queue.stats;
+}
+
+// static
+void MessageHandler::ResetStats() {
+  auto& stats = g_message_queue.stats;
+  stats.peak_normal_queue_depth = stats.normal_queue_depth;
+  stats.peak_delayed_queue_depth = stats.delayed_queue_depth;
+  stats.dispatched_count = 0;
+  stats.total_dispatch_latency_ms = 0;
+  stats.max_dispatch_latency_ms = 0;
+}
+
 }  // namespace el
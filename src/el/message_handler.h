@@ -11,10 +11,11 @@
 #define EL_MESSAGE_HANDLER_H_
 
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include "el/id.h"
 #include "el/message.h"
-#include "el/util/intrusive_list.h"
 
 namespace el {
 
@@ -25,12 +26,30 @@ namespace el {
 // Immediate messages are put on a queue and delivered as soon as possible,
 // after any delayed messages that has passed their delivery time. This queue is
 // global (among all MessageHandlers).
+// Delayed messages with the same fire time are delivered in the order they
+// were posted.
 class MessageHandler {
  public:
   // kNotSoon is returned from MessageHandler::GetNextMessageFireTime
   // and means that there is currently no more messages to process.
   static const uint64_t kNotSoon = ~0ull;
 
+  // Statistics for the global message queues.
+  struct Stats {
+    // Number of messages currently queued.
+    size_t normal_queue_depth = 0;
+    size_t delayed_queue_depth = 0;
+    // Highest number of messages queued since the last ResetStats.
+    size_t peak_normal_queue_depth = 0;
+    size_t peak_delayed_queue_depth = 0;
+    // Number of messages delivered since the last ResetStats.
+    uint64_t dispatched_count = 0;
+    // Time between when messages should have been delivered (the fire time, or
+    // the post time for nondelayed messages) and when they were.
+    uint64_t total_dispatch_latency_ms = 0;
+    uint64_t max_dispatch_latency_ms = 0;
+  };
+
   MessageHandler();
   virtual ~MessageHandler();
 
@@ -52,6 +71,21 @@ class MessageHandler {
   // automatically when the message is deleted.
   void PostMessage(TBID message_id, std::unique_ptr<MessageData> data);
 
+  // Posts a message to the target from any thread.
+  // The message is put in a lock-free inbox that is moved to the normal
+  // message queue by the next ProcessMessages call, so it won't be found by
+  // GetMessageById until then. Messages posted from the same thread are
+  // delivered in order.
+  // When the inbox goes from empty to non-empty util::RescheduleTimer(0) and
+  // the wake up callback (see set_wake_up_callback) are called on the posting
+  // thread, so hosts using this must be able to handle them from any thread.
+  // The handler must outlive any pending calls to this, and data must be safe
+  // to delete on the thread processing messages.
+  // message_id is taken by reference since copying a TBID isn't thread safe
+  // in debug builds.
+  void PostMessageFromAnyThread(const TBID& message_id,
+                                std::unique_ptr<MessageData> data);
+
   // Checks if this messagehandler has a pending message with the given id.
   // Returns the message if found, or nullptr.
   // If you want to delete the message, call DeleteMessage.
@@ -82,8 +116,26 @@ class MessageHandler {
   // MessageHandler::kNotSoon (no call to ProcessMessages is needed). */
   static uint64_t GetNextMessageFireTime();
 
+  // Sets a function waking up the host if it's blocked waiting for events,
+  // f.ex by calling glfwPostEmptyEvent, so messages posted with
+  // PostMessageFromAnyThread are processed without waiting for input.
+  // It's called on the posting thread. nullptr (default) to not wake up.
+  static void set_wake_up_callback(void (*callback)());
+
+  static const Stats& stats();
+  // Resets the peak, dispatch count and latency stats.
+  static void ResetStats();
+
  private:
-  util::IntrusiveList<Message> m_messages;
+  // Moves messages posted with PostMessageFromAnyThread to the normal queue.
+  static void DrainInbox();
+
+  void QueueNormalMessage(Message* msg);
+  void RemoveFromIndex(Message* msg);
+
+  // Pending messages by id, each in the order they were posted.
+  std::unordered_map<uint32_t, std::vector<Message*>> m_messages_by_id;
+  size_t m_message_count = 0;
 };
 
 }  // namespace el
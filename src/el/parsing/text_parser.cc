@@ -9,6 +9,7 @@
 
 #include <cassert>
 #include <cctype>
+#include <cstring>
 
 #include "el/parsing/text_parser.h"
 #include "el/parsing/text_parser_stream.h"
@@ -186,60 +187,22 @@ bool IsEndQuote(const char* buf_start, const char* buf, const char quote_type) {
 TextParser::Status TextParser::Read(TextParserStream* stream,
                                     TextParserTarget* target) {
   util::StringBuilder line(1024);
-  util::StringBuilder work(1024);
 
   current_indent = 0;
   current_line_nr = 1;
   pending_multiline = false;
   multi_line_sub_level = 0;
 
-  while (size_t read_len = stream->GetMoreData(work.data(), work.capacity())) {
-    char* buf = work.data();
-
-    // Skip BOM (BYTE ORDER MARK) character, often in the beginning of UTF-8
-    // documents.
-    if (current_line_nr == 1 && read_len > 3 && (uint8_t)buf[0] == 239 &&
-        (uint8_t)buf[1] == 187 && (uint8_t)buf[2] == 191) {
-      read_len -= 3;
-      buf += 3;
-    }
-
-    size_t line_pos = 0;
-    while (true) {
-      // Find line end.
-      size_t line_start = line_pos;
-      while (line_pos < read_len && buf[line_pos] != '\n') {
-        line_pos++;
-      }
-
-      if (line_pos < read_len) {
-        // We have a line.
-        // Skip preceding \r (if we have one).
-        size_t line_len = line_pos - line_start;
-        line.Append(buf + line_start, line_len);
-
-        // Strip away trailing '\r' if the line has it.
-        char* linebuf = line.data();
-        size_t linebuf_len = line.GetAppendPos();
-        if (linebuf_len > 0 && linebuf[linebuf_len - 1] == '\r') {
-          linebuf[linebuf_len - 1] = 0;
-        }
-
-        // Terminate the line string.
-        line.Append("", 1);
-
-        // Handle line.
-        OnLine(line.data(), target);
-        current_line_nr++;
-
-        line.ResetAppendPos();
-        line_pos++;  // Skip this \n
-        // Find next line.
-        continue;
-      }
-      // No more lines here so push the rest and break for more data.
-      line.Append(buf + line_start, read_len - line_start);
-      break;
+  size_t data_len = 0;
+  if (const char* data = stream->GetData(&data_len)) {
+    // The whole document is already in memory so it can be consumed directly
+    // without copying it through the work buffer.
+    ReadChunk(data, data_len, &line, target);
+  } else {
+    util::StringBuilder work(1024);
+    while (size_t read_len =
+               stream->GetMoreData(work.data(), work.capacity())) {
+      ReadChunk(work.data(), read_len, &line, target);
     }
   }
   if (line.GetAppendPos()) {
@@ -250,6 +213,55 @@ TextParser::Status TextParser::Read(TextParserStream* stream,
   return Status::kOk;
 }
 
+void TextParser::ReadChunk(const char* buf, size_t buf_len,
+                           util::StringBuilder* line,
+                           TextParserTarget* target) {
+  // Skip BOM (BYTE ORDER MARK) character, often in the beginning of UTF-8
+  // documents.
+  if (current_line_nr == 1 && buf_len > 3 && (uint8_t)buf[0] == 239 &&
+      (uint8_t)buf[1] == 187 && (uint8_t)buf[2] == 191) {
+    buf_len -= 3;
+    buf += 3;
+  }
+
+  size_t line_pos = 0;
+  while (true) {
+    // Find line end.
+    size_t line_start = line_pos;
+    auto line_end = reinterpret_cast<const char*>(
+        std::memchr(buf + line_pos, '\n', buf_len - line_pos));
+    line_pos = line_end ? size_t(line_end - buf) : buf_len;
+
+    if (line_pos < buf_len) {
+      // We have a line.
+      size_t line_len = line_pos - line_start;
+      line->Append(buf + line_start, line_len);
+
+      // Strip away trailing '\r' if the line has it.
+      char* linebuf = line->data();
+      size_t linebuf_len = line->GetAppendPos();
+      if (linebuf_len > 0 && linebuf[linebuf_len - 1] == '\r') {
+        linebuf[linebuf_len - 1] = 0;
+      }
+
+      // Terminate the line string.
+      line->Append("", 1);
+
+      // Handle line.
+      OnLine(line->data(), target);
+      current_line_nr++;
+
+      line->ResetAppendPos();
+      line_pos++;  // Skip this \n
+      // Find next line.
+      continue;
+    }
+    // No more lines here so push the rest and break for more data.
+    line->Append(buf + line_start, buf_len - line_start);
+    break;
+  }
+}
+
 void TextParser::OnLine(char* line, TextParserTarget* target) {
   if (is_space_or_comment(&line)) {
     if (*line == '#') {
@@ -42,6 +42,10 @@ class TextParser {
   Status Read(TextParserStream* stream, TextParserTarget* target);
 
  private:
+  // Splits buf into lines and handles each complete one. A trailing partial
+  // line is left in line so it can be completed by the next chunk.
+  void ReadChunk(const char* buf, size_t buf_len, util::StringBuilder* line,
+                 TextParserTarget* target);
   void OnLine(char* line, TextParserTarget* target);
   void OnCompactLine(char* line, TextParserTarget* target);
   void OnMultiline(char* line, TextParserTarget* target);
@@ -30,6 +30,11 @@ size_t FileTextParserStream::GetMoreData(char* buf, size_t buf_len) {
   return file_->Read(buf, buf_len);
 }
 
+const char* FileTextParserStream::GetData(size_t* out_length) {
+  *out_length = file_->size();
+  return reinterpret_cast<const char*>(file_->data());
+}
+
 bool DataTextParserStream::Read(const char* data, size_t data_length,
                                 TextParserTarget* target) {
   m_data = data;
@@ -47,5 +52,10 @@ size_t DataTextParserStream::GetMoreData(char* buf, size_t buf_len) {
   return consume;
 }
 
+const char* DataTextParserStream::GetData(size_t* out_length) {
+  *out_length = m_data_len;
+  return m_data;
+}
+
 }  // namespace parsing
 }  // namespace el
@@ -26,12 +26,16 @@ class TextParserStream {
  public:
   virtual ~TextParserStream() = default;
   virtual size_t GetMoreData(char* buf, size_t buf_len) = 0;
+  // Returns the entire stream contents if they are already in memory, in
+  // which case GetMoreData is never called. Returns nullptr otherwise.
+  virtual const char* GetData(size_t* /*out_length*/) { return nullptr; }
 };
 
 class FileTextParserStream : public TextParserStream {
  public:
   bool Read(const std::string& filename, TextParserTarget* target);
   size_t GetMoreData(char* buf, size_t buf_len) override;
+  const char* GetData(size_t* out_length) override;
 
  private:
   std::unique_ptr<io::File> file_;
@@ -41,6 +45,7 @@ class DataTextParserStream : public TextParserStream {
  public:
   bool Read(const char* data, size_t data_length, TextParserTarget* target);
   size_t GetMoreData(char* buf, size_t buf_len) override;
+  const char* GetData(size_t* out_length) override;
 
  private:
   const char* m_data = nullptr;
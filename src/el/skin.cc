@@ -11,11 +11,15 @@
 #include <cassert>
 #include <cstdio>
 #include <string>
+#include <utility>
+#include <vector>
 
+#include "el/graphics/image_loader.h"
 #include "el/parsing/parse_node.h"
 #include "el/skin.h"
 #include "el/util/debug.h"
 #include "el/util/metrics.h"
+#include "el/util/parallel.h"
 #include "el/util/string_builder.h"
 
 namespace el {
@@ -55,6 +59,11 @@ Skin::Skin() {
 
   // Avoid filtering artifacts at edges when we draw fragments stretched.
   m_frag_manager.set_has_border(true);
+
+  // All skin bitmaps are known up front and never freed individually, so pack
+  // them as tightly as possible to use fewer maps.
+  m_frag_manager.set_packing_algorithm(graphics::PackingAlgorithm::kMaxRects);
+  m_frag_manager.set_presort_images(true);
 }
 
 bool Skin::Load(const char* skin_file) {
@@ -170,47 +179,109 @@ bool Skin::ReloadBitmaps() {
     success = m_frag_manager.ValidateBitmaps();
   }
 
-  TBDebugOut("Skin loaded using %dll bitmaps.\n", m_frag_manager.map_count());
+  int fragment_pixels = 0;
+  int allocated_pixels = 0;
+  int total_pixels = 0;
+  m_frag_manager.GetOccupancy(&fragment_pixels, &allocated_pixels,
+                              &total_pixels);
+  TBDebugOut(
+      "Skin loaded using %d bitmaps: %d of %d pixels used by fragments (%d%%), "
+      "%d allocated (%d%%).\n",
+      int(m_frag_manager.map_count()), fragment_pixels, total_pixels,
+      total_pixels ? fragment_pixels * 100 / total_pixels : 0,
+      allocated_pixels,
+      total_pixels ? allocated_pixels * 100 / total_pixels : 0);
   return success;
 }
 
 bool Skin::ReloadBitmapsInternal() {
-  // Load all bitmap files into new bitmap fragments.
+  // A bitmap file to decode. Files are often shared between elements, so each
+  // file is only decoded once.
+  struct DecodeJob {
+    std::string filename;
+    std::string filename_dst_dpi;
+    std::string loaded_filename;
+    std::unique_ptr<graphics::ImageLoader> image;
+    bool is_dst_dpi = false;
+  };
+  std::vector<DecodeJob> jobs;
+  std::unordered_map<std::string, size_t> job_indices;
+  std::vector<std::pair<SkinElement*, size_t>> element_jobs;
+
+  // Gather the files to load in a deterministic (element) order.
   util::StringBuilder filename_dst_DPI;
-  bool success = true;
   for (auto& it : m_elements) {
     auto element = it.second.get();
-    if (!element->bitmap_file.empty()) {
-      assert(!element->bitmap);
-
-      // FIX: dedicated_map is not needed for all backends (only deprecated
-      // fixed function GL).
-      // TODO(benvanik): fix shaders/etc to properly repeat subregions?
-      // This will force a new, empty map to be created just for tiled textures.
-      bool dedicated_map = element->type == SkinElementType::kTile;
-
-      // Try to load bitmap fragment in the destination DPI (F.ex "foo.png"
-      // becomes "foo@192.png")
-      int bitmap_dpi = m_dim_conv.GetSrcDPI();
+    if (element->bitmap_file.empty()) {
+      continue;
+    }
+    assert(!element->bitmap);
+    auto job_it = job_indices.find(element->bitmap_file);
+    if (job_it == job_indices.end()) {
+      DecodeJob job;
+      job.filename = element->bitmap_file;
       if (m_dim_conv.NeedConversion()) {
+        // Try to load bitmap fragment in the destination DPI (F.ex "foo.png"
+        // becomes "foo@192.png")
         m_dim_conv.GetDstDPIFilename(element->bitmap_file, &filename_dst_DPI);
-        element->bitmap = m_frag_manager.GetFragmentFromFile(
-            filename_dst_DPI.c_str(), dedicated_map);
-        if (element->bitmap) {
-          bitmap_dpi = m_dim_conv.GetDstDPI();
-        }
+        job.filename_dst_dpi = filename_dst_DPI.c_str();
       }
-      element->SetBitmapDPI(m_dim_conv, bitmap_dpi);
-
-      // If we still have no bitmap fragment, load from default file.
-      if (!element->bitmap) {
-        element->bitmap = m_frag_manager.GetFragmentFromFile(
-            element->bitmap_file, dedicated_map);
+      job_it = job_indices.emplace(job.filename, jobs.size()).first;
+      jobs.push_back(std::move(job));
+    }
+    element_jobs.emplace_back(element, job_it->second);
+  }
+
+  // Read and decode all files in parallel. This only touches the job itself so
+  // it's safe to do off the main thread.
+  util::ParallelFor(jobs.size(), [&jobs](size_t i) {
+    DecodeJob& job = jobs[i];
+    if (!job.filename_dst_dpi.empty()) {
+      job.image = graphics::ImageLoader::CreateFromFile(job.filename_dst_dpi);
+      if (job.image) {
+        job.loaded_filename = job.filename_dst_dpi;
+        job.is_dst_dpi = true;
+        return;
       }
+    }
+    // If we still have no bitmap, load from default file.
+    job.image = graphics::ImageLoader::CreateFromFile(job.filename);
+    job.loaded_filename = job.filename;
+  });
+
+  // Pack the decoded images into fragments on this thread in the same order
+  // they were gathered (or presorted by the fragment manager), so the
+  // resulting maps are always the same.
+  std::vector<graphics::BitmapFragmentManager::ImageSource> sources;
+  sources.reserve(element_jobs.size());
+  for (auto& element_job : element_jobs) {
+    SkinElement* element = element_job.first;
+    DecodeJob& job = jobs[element_job.second];
+    graphics::BitmapFragmentManager::ImageSource source;
+    source.filename = job.loaded_filename;
+    // FIX: dedicated_map is not needed for all backends (only deprecated
+    // fixed function GL).
+    // TODO(benvanik): fix shaders/etc to properly repeat subregions?
+    // This will force a new, empty map to be created just for tiled textures.
+    source.dedicated_map = element->type == SkinElementType::kTile;
+    source.image = job.image.get();
+    sources.push_back(std::move(source));
+  }
+  auto fragments = m_frag_manager.GetFragmentsFromImages(sources);
 
-      if (!element->bitmap) {
-        success = false;
-      }
+  bool success = true;
+  for (size_t i = 0; i < element_jobs.size(); ++i) {
+    SkinElement* element = element_jobs[i].first;
+    DecodeJob& job = jobs[element_jobs[i].second];
+    element->bitmap = fragments[i];
+    int bitmap_dpi = m_dim_conv.GetSrcDPI();
+    if (element->bitmap && job.is_dst_dpi) {
+      bitmap_dpi = m_dim_conv.GetDstDPI();
+    }
+    element->SetBitmapDPI(m_dim_conv, bitmap_dpi);
+
+    if (!element->bitmap) {
+      success = false;
     }
   }
   return success;
@@ -296,16 +367,11 @@ SkinElement* Skin::PaintSkin(const Rect& dst_rect, SkinElement* element,
 
   // Paint all child elements that matches the state (or should be painted for
   // all states).
-  if (element->m_child_elements.has_state_elements()) {
-    auto state_element = element->m_child_elements.first_element();
-    while (state_element) {
-      if (state_element->IsMatch(state, context)) {
+  element->m_child_elements.ForEachMatch(
+      state, context, [&](SkinElementState* state_element) {
         PaintSkin(dst_rect, state_element->element_id,
                   state_element->state & state, context);
-      }
-      state_element = state_element->GetNext();
-    }
-  }
+      });
 
   // Paint ugly rectangles on invalid skin elements in debug builds.
   EL_IF_DEBUG(if (paint_error_highlight) Renderer::get()->DrawRect(
@@ -327,14 +393,11 @@ void Skin::PaintSkinOverlay(const Rect& dst_rect, SkinElement* element,
 
   // Paint all overlay elements that matches the state (or should be painted for
   // all states).
-  auto state_element = element->m_overlay_elements.first_element();
-  while (state_element) {
-    if (state_element->IsMatch(state, context)) {
-      PaintSkin(dst_rect, state_element->element_id,
-                state_element->state & state, context);
-    }
-    state_element = state_element->GetNext();
-  }
+  element->m_overlay_elements.ForEachMatch(
+      state, context, [&](SkinElementState* state_element) {
+        PaintSkin(dst_rect, state_element->element_id,
+                  state_element->state & state, context);
+      });
 
   element->is_painting = false;
 }
@@ -697,13 +760,7 @@ bool SkinElementState::IsMatch(SkinState test_state,
     return false;
   }
   if (any(test_state & state) || state == SkinState::kAll) {
-    for (SkinCondition* condition = conditions.GetFirst(); condition;
-         condition = condition->GetNext()) {
-      if (!condition->GetCondition(context)) {
-        return false;
-      }
-    }
-    return true;
+    return IsConditionMatch(context);
   }
   return false;
 }
@@ -715,17 +772,24 @@ bool SkinElementState::IsExactMatch(SkinState test_state,
     return false;
   }
   if (test_state == state || state == SkinState::kAll) {
-    for (SkinCondition* condition = conditions.GetFirst(); condition;
-         condition = condition->GetNext()) {
-      if (!condition->GetCondition(context)) {
-        return false;
-      }
-    }
-    return true;
+    return IsConditionMatch(context);
   }
   return false;
 }
 
+bool SkinElementState::IsConditionMatch(
+    const SkinConditionContext& context) const {
+  for (SkinCondition* condition = conditions.GetFirst(); condition;
+       condition = condition->GetNext()) {
+    if (!condition->GetCondition(context)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+SkinElementStateList::SkinElementStateList() = default;
+
 SkinElementStateList::~SkinElementStateList() {
   while (SkinElementState* state = m_state_elements.GetFirst()) {
     m_state_elements.Remove(state);
@@ -736,20 +800,56 @@ SkinElementStateList::~SkinElementStateList() {
 SkinElementState* SkinElementStateList::GetStateElement(
     SkinState state, const SkinConditionContext& context,
     SkinElementState::MatchRule rule) const {
-  // First try to get a state element with a exact match to the current state.
-  if (SkinElementState* element_state =
-          GetStateElementExactMatch(state, context, rule)) {
-    return element_state;
+  if (!m_compiled) {
+    return nullptr;
+  }
+  const Range& range = m_compiled->first_match[size_t(rule)][StateIndex(state)];
+  if (!range.count) {
+    return nullptr;
+  }
+  // Candidates without conditions always match, so this is the common case of
+  // a direct table lookup.
+  SkinElementState* first = m_compiled->entries[range.first];
+  if (!first->conditions.HasLinks()) {
+    return first;
+  }
+
+  // Conditions are only stable while painting a frame, so outside of painting
+  // (or for contexts that can't be identified) we always evaluate them.
+  auto renderer = graphics::Renderer::get();
+  uint32_t frame_id = renderer ? renderer->paint_frame_id() : 0;
+  const void* key = context.memo_key();
+  MemoEntry* memo = nullptr;
+  if (frame_id && key) {
+    size_t slot = (reinterpret_cast<uintptr_t>(key) / sizeof(void*) +
+                   StateIndex(state)) %
+                  kMemoSize;
+    memo = &m_compiled->memo[slot];
+    if (memo->key == key && memo->frame_id == frame_id &&
+        memo->rule == uint8_t(rule) && memo->state == StateIndex(state)) {
+      return memo->result;
+    }
   }
-  // No exact state match. Get a state with a partly match if there is one.
-  SkinElementState* state_element = m_state_elements.GetFirst();
-  while (state_element) {
-    if (state_element->IsMatch(state, context, rule)) {
-      return state_element;
+
+  // Exact matches come before partial matches in the candidate list, so the
+  // first candidate with matching conditions is the one the skin wants.
+  SkinElementState* result = nullptr;
+  for (size_t i = range.first; i < range.first + range.count; ++i) {
+    SkinElementState* state_element = m_compiled->entries[i];
+    if (state_element->IsConditionMatch(context)) {
+      result = state_element;
+      break;
     }
-    state_element = state_element->GetNext();
   }
-  return nullptr;
+
+  if (memo) {
+    memo->key = key;
+    memo->frame_id = frame_id;
+    memo->rule = uint8_t(rule);
+    memo->state = uint8_t(StateIndex(state));
+    memo->result = result;
+  }
+  return result;
 }
 
 SkinElementState* SkinElementStateList::GetStateElementExactMatch(
@@ -824,6 +924,70 @@ void SkinElementStateList::Load(ParseNode* n) {
     m_state_elements.AddLast(state);
     element_node = element_node->GetNext();
   }
+
+  Compile();
+}
+
+void SkinElementStateList::Compile() {
+  m_compiled.reset();
+  if (!m_state_elements.HasLinks()) {
+    return;
+  }
+  m_compiled.reset(new Compiled());
+  auto& entries = m_compiled->entries;
+
+  // Matching on state alone; conditions are evaluated at lookup time.
+  auto state_matches = [](SkinElementState* state_element, SkinState state,
+                          SkinElementState::MatchRule rule, bool exact) {
+    if (rule == SkinElementState::MatchRule::kOnlySpecificState &&
+        state_element->state == SkinState::kAll) {
+      return false;
+    }
+    if (state_element->state == SkinState::kAll) {
+      return true;
+    }
+    return exact ? state_element->state == state
+                 : any(state_element->state & state);
+  };
+
+  for (size_t i = 0; i < kStateCount; ++i) {
+    auto state = SkinState(i);
+    for (auto rule : {SkinElementState::MatchRule::kDefault,
+                      SkinElementState::MatchRule::kOnlySpecificState}) {
+      Range& range = m_compiled->first_match[size_t(rule)][i];
+      range.first = uint16_t(entries.size());
+      bool done = false;
+      // Exact matches first, then partial matches. A candidate that already
+      // failed its conditions as an exact match would fail again, so it's
+      // only added once.
+      for (bool exact : {true, false}) {
+        for (SkinElementState* state_element = m_state_elements.GetFirst();
+             state_element && !done; state_element = state_element->GetNext()) {
+          if (!state_matches(state_element, state, rule, exact)) {
+            continue;
+          }
+          if (!exact && state_matches(state_element, state, rule, true)) {
+            continue;
+          }
+          entries.push_back(state_element);
+          // Nothing after an unconditional candidate can ever be returned.
+          done = !state_element->conditions.HasLinks();
+        }
+      }
+      range.count = uint16_t(entries.size() - range.first);
+    }
+
+    Range& range = m_compiled->all_matches[i];
+    range.first = uint16_t(entries.size());
+    for (SkinElementState* state_element = m_state_elements.GetFirst();
+         state_element; state_element = state_element->GetNext()) {
+      if (state_matches(state_element, state,
+                        SkinElementState::MatchRule::kDefault, false)) {
+        entries.push_back(state_element);
+      }
+    }
+    range.count = uint16_t(entries.size() - range.first);
+  }
 }
 
 }  // namespace el
@@ -10,9 +10,11 @@
 #ifndef EL_SKIN_H_
 #define EL_SKIN_H_
 
+#include <array>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "el/graphics/bitmap_fragment.h"
 #include "el/graphics/bitmap_fragment_manager.h"
@@ -154,6 +156,11 @@ class SkinConditionContext {
   // Returns true if the given target and property equals the given value.
   virtual bool GetCondition(SkinTarget target,
                             const SkinCondition::ConditionInfo& info) const = 0;
+
+  // Returns a key identifying the object the conditions are evaluated for, or
+  // nullptr if condition results for this context must not be memoized.
+  // Results are only memoized for the duration of a single paint frame.
+  virtual const void* memo_key() const { return nullptr; }
 };
 
 // SkinElementState has a skin element id that should be used if its state and
@@ -174,14 +181,22 @@ class SkinElementState : public util::IntrusiveListEntry<SkinElementState> {
   bool IsExactMatch(SkinState test_state, const SkinConditionContext& context,
                     MatchRule rule = MatchRule::kDefault) const;
 
+  // Returns true if all conditions (if any) are true for the given context.
+  bool IsConditionMatch(const SkinConditionContext& context) const;
+
   TBID element_id;
   SkinState state;
   util::AutoDeleteIntrusiveList<SkinCondition> conditions;
 };
 
 // List of state elements in a SkinElement.
+// The list is compiled into lookup tables indexed by SkinState when loaded so
+// that state elements without conditions are found without walking the list.
+// Only state elements with conditions need to be evaluated at lookup time, and
+// those results are memoized per context for the current paint frame.
 class SkinElementStateList {
  public:
+  SkinElementStateList();
   ~SkinElementStateList();
 
   SkinElementState* GetStateElement(
@@ -199,10 +214,62 @@ class SkinElementStateList {
     return m_state_elements.GetFirst();
   }
 
+  // Calls fn for each state element matching the given state (see
+  // SkinElementState::IsMatch), in the order they are specified in the skin.
+  template <typename F>
+  void ForEachMatch(SkinState state, const SkinConditionContext& context,
+                    F fn) const {
+    if (!m_compiled) return;
+    const auto& range = m_compiled->all_matches[StateIndex(state)];
+    for (size_t i = range.first; i < range.first + range.count; ++i) {
+      SkinElementState* state_element = m_compiled->entries[i];
+      if (state_element->IsConditionMatch(context)) {
+        fn(state_element);
+      }
+    }
+  }
+
   void Load(parsing::ParseNode* n);
 
  private:
+  static constexpr size_t kStateCount = size_t(SkinState::kAll) + 1;
+  static constexpr size_t kMemoSize = 8;
+
+  // A range of candidates in Compiled::entries.
+  struct Range {
+    uint16_t first = 0;
+    uint16_t count = 0;
+  };
+
+  // Memoized result of a conditional lookup.
+  struct MemoEntry {
+    const void* key = nullptr;
+    uint32_t frame_id = 0;
+    uint8_t rule = 0;
+    uint8_t state = 0;
+    SkinElementState* result = nullptr;
+  };
+
+  struct Compiled {
+    // Candidates for GetStateElement per rule and state: all exact matches
+    // followed by all partial matches, ending at the first candidate without
+    // conditions. The first candidate whose conditions are true wins.
+    Range first_match[2][kStateCount];
+    // Candidates for ForEachMatch per state (with MatchRule::kDefault).
+    Range all_matches[kStateCount];
+    std::vector<SkinElementState*> entries;
+    std::array<MemoEntry, kMemoSize> memo;
+  };
+
+  static size_t StateIndex(SkinState state) {
+    return size_t(state & SkinState::kAll);
+  }
+
+  // Rebuilds the lookup tables from m_state_elements.
+  void Compile();
+
   util::IntrusiveList<SkinElementState> m_state_elements;
+  std::unique_ptr<Compiled> m_compiled;
 };
 
 // Skin element.
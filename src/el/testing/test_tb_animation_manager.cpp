@@ -0,0 +1,119 @@
+/**
+ ******************************************************************************
+ * Elemental Forms : a lightweight user interface framework                   *
+ ******************************************************************************
+ * Copyright 2015 Ben Vanik. All rights reserved. Licensed as BSD 3-clause.   *
+ * Portions ©2011-2015 Emil Segerås: https://github.com/fruxo/turbobadger     *
+ ******************************************************************************
+ */
+
+#include <vector>
+
+#include "el/animation_manager.h"
+#include "el/element.h"
+#include "el/element_animation.h"
+#include "el/testing/testing.h"
+
+#ifdef EL_UNIT_TESTING
+
+using namespace el;
+
+namespace {
+class InvalidCountingElement : public Element {
+ public:
+  void OnInvalid() override { ++invalid_count; }
+  int invalid_count = 0;
+};
+
+// Appends updated animations to a shared order. A listener can only be added
+// to one animation, so each needs its own.
+class OrderListener : public AnimationListener {
+ public:
+  explicit OrderListener(std::vector<Animation*>* order) : order(order) {}
+  void OnAnimationStart(Animation* obj) override {}
+  void OnAnimationUpdate(Animation* obj, float progress) override {
+    order->push_back(obj);
+  }
+  void OnAnimationStop(Animation* obj, bool aborted) override {}
+  std::vector<Animation*>* order;
+};
+}  // namespace
+
+EL_TEST_GROUP(tb_animation_manager) {
+  EL_TEST(zero_duration_completes) {
+    const AnimationCurve curves[] = {
+        AnimationCurve::kLinear, AnimationCurve::kSlowDown,
+        AnimationCurve::kSpeedUp, AnimationCurve::kBezier,
+        AnimationCurve::kSmooth};
+    float values[5] = {0};
+    for (int i = 0; i < 5; ++i) {
+      auto anim = new ExternalFloatAnimation(&values[i], curves[i], 0);
+      anim->dst_val = 10.f;
+      AnimationManager::StartAnimation(anim, curves[i], 0);
+    }
+    AnimationManager::Update();
+    EL_VERIFY(!AnimationManager::has_running_animations());
+    for (int i = 0; i < 5; ++i) {
+      EL_VERIFY(values[i] == 10.f);
+    }
+  }
+  EL_TEST(update_order_is_start_order) {
+    // Animations are evaluated grouped by curve but must still be updated in
+    // the order they were started.
+    std::vector<Animation*> order;
+    OrderListener listener_a(&order), listener_b(&order), listener_c(&order);
+    FloatAnimation a(0), b(0), c(0);
+    a.AddListener(&listener_a);
+    b.AddListener(&listener_b);
+    c.AddListener(&listener_c);
+    AnimationManager::StartAnimation(&a, AnimationCurve::kSmooth, 100000);
+    AnimationManager::StartAnimation(&b, AnimationCurve::kLinear, 100000);
+    AnimationManager::StartAnimation(&c, AnimationCurve::kSmooth, 100000);
+    AnimationManager::Update();
+    EL_VERIFY(order.size() == 3);
+    EL_VERIFY(order[0] == &a && order[1] == &b && order[2] == &c);
+    EL_VERIFY(a.is_animating() && a.current_progress < 1.f);
+    AnimationManager::AbortAnimation(&a, false);
+    AnimationManager::AbortAnimation(&b, false);
+    AnimationManager::AbortAnimation(&c, false);
+  }
+  EL_TEST(invalidate_once_per_element) {
+    InvalidCountingElement parent;
+    auto child = new InvalidCountingElement();
+    parent.set_rect(Rect(0, 0, 100, 100));
+    child->set_rect(Rect(0, 0, 10, 10));
+    parent.AddChild(child);
+    AnimationManager::StartAnimation(
+        new OpacityElementAnimation(child, 1.f, 0.5f, false),
+        AnimationCurve::kLinear, 0);
+    AnimationManager::StartAnimation(
+        new RectElementAnimation(child, Rect(0, 0, 10, 10),
+                                 Rect(5, 5, 20, 20)),
+        AnimationCurve::kBezier, 0);
+    child->invalid_count = 0;
+    parent.invalid_count = 0;
+    AnimationManager::Update();
+    EL_VERIFY(child->opacity() == 0.5f);
+    EL_VERIFY(child->rect().equals(Rect(5, 5, 20, 20)));
+    EL_VERIFY(child->invalid_count == 1);
+    EL_VERIFY(parent.invalid_count == 1);
+    parent.DeleteAllChildren();
+  }
+  EL_TEST(delete_during_batch) {
+    InvalidCountingElement parent;
+    auto child = new InvalidCountingElement();
+    parent.set_rect(Rect(0, 0, 100, 100));
+    child->set_rect(Rect(0, 0, 10, 10));
+    parent.AddChild(child);
+    // Invalidated by the update and then deleted when the animation stops.
+    AnimationManager::StartAnimation(
+        new OpacityElementAnimation(child, 1.f, 0.5f, true),
+        AnimationCurve::kLinear, 0);
+    parent.invalid_count = 0;
+    AnimationManager::Update();
+    EL_VERIFY(!parent.first_child());
+    EL_VERIFY(parent.invalid_count == 1);
+  }
+}
+
+#endif  // EL_UNIT_TESTING
@@ -0,0 +1,90 @@
+/**
+ ******************************************************************************
+ * Elemental Forms : a lightweight user interface framework                   *
+ ******************************************************************************
+ * Copyright 2015 Ben Vanik. All rights reserved. Licensed as BSD 3-clause.   *
+ * Portions ©2011-2015 Emil Segerås: https://github.com/fruxo/turbobadger     *
+ ******************************************************************************
+ */
+
+#include <cstring>
+
+#include "el/io/archive_file_system.h"
+#include "el/io/memory_file_system.h"
+#include "el/testing/testing.h"
+
+#ifdef EL_UNIT_TESTING
+
+using namespace el;
+using el::io::ArchiveFileSystem;
+using el::io::ArchiveWriter;
+
+namespace {
+std::unique_ptr<ArchiveFileSystem> OpenArchive(
+    const std::vector<uint8_t>& buffer) {
+  io::MemoryFileSystem memory_file_system;
+  memory_file_system.AddFile("archive", buffer.data(), buffer.size());
+  return ArchiveFileSystem::Open(memory_file_system.OpenRead("archive"));
+}
+}  // namespace
+
+EL_TEST_GROUP(tb_archive) {
+  EL_TEST(lookup) {
+    ArchiveWriter writer;
+    writer.AddFile("a.txt", "alpha", 5);
+    writer.AddFile("dir/b.txt", "beta", 4);
+    writer.AddFile("dir\\c.txt", "gamma", 5);
+    writer.AddFile("empty.txt", "", 0);
+    auto buffer = writer.Serialize();
+    auto archive = OpenArchive(buffer);
+    EL_VERIFY(archive);
+    EL_VERIFY(archive->file_count() == 4);
+
+    auto file = archive->OpenRead("dir/b.txt");
+    EL_VERIFY(file);
+    EL_VERIFY(file->size() == 4);
+    EL_VERIFY(file->data());
+    EL_VERIFY(std::memcmp(file->data(), "beta", 4) == 0);
+
+    char read_buffer[8] = {0};
+    file = archive->OpenRead("dir/c.txt");
+    EL_VERIFY(file);
+    EL_VERIFY(file->Read(read_buffer, sizeof(read_buffer)) == 5);
+    EL_VERIFY(std::strcmp(read_buffer, "gamma") == 0);
+
+    EL_VERIFY(archive->OpenRead("dir\\b.txt"));
+    file = archive->OpenRead("empty.txt");
+    EL_VERIFY(file && file->size() == 0);
+    EL_VERIFY(!archive->OpenRead("missing.txt"));
+    EL_VERIFY(!archive->OpenRead("a.tx"));
+    EL_VERIFY(!archive->OpenRead(""));
+  }
+  EL_TEST(many_files) {
+    ArchiveWriter writer;
+    for (int i = 0; i < 200; ++i) {
+      std::string name = "file" + std::to_string(i);
+      writer.AddFile(name, &i, sizeof(i));
+    }
+    auto buffer = writer.Serialize();
+    auto archive = OpenArchive(buffer);
+    EL_VERIFY(archive);
+    for (int i = 0; i < 200; ++i) {
+      auto file = archive->OpenRead("file" + std::to_string(i));
+      EL_VERIFY(file && file->size() == sizeof(i));
+      int value;
+      std::memcpy(&value, file->data(), sizeof(value));
+      EL_VERIFY(value == i);
+    }
+  }
+  EL_TEST(invalid) {
+    std::vector<uint8_t> buffer(64, 0);
+    EL_VERIFY(!OpenArchive(buffer));
+    ArchiveWriter writer;
+    writer.AddFile("a.txt", "alpha", 5);
+    buffer = writer.Serialize();
+    buffer.resize(sizeof(ArchiveFileSystem::Header) + 4);
+    EL_VERIFY(!OpenArchive(buffer));
+  }
+}
+
+#endif  // EL_UNIT_TESTING
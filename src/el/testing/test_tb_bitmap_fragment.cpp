@@ -0,0 +1,59 @@
+/**
+ ******************************************************************************
+ * Elemental Forms : a lightweight user interface framework                   *
+ ******************************************************************************
+ * Copyright 2015 Ben Vanik. All rights reserved. Licensed as BSD 3-clause.   *
+ * Portions ©2011-2015 Emil Segerås: https://github.com/fruxo/turbobadger     *
+ ******************************************************************************
+ */
+
+#include <cstdint>
+#include <vector>
+
+#include "el/graphics/bitmap_fragment.h"
+#include "el/graphics/bitmap_fragment_manager.h"
+#include "el/graphics/renderer.h"
+#include "el/testing/testing.h"
+
+#ifdef EL_UNIT_TESTING
+
+using namespace el;
+using namespace el::graphics;
+
+EL_TEST_GROUP(tb_bitmap_fragment) {
+  EL_TEST(bytes_per_pixel) {
+    EL_VERIFY(GetBytesPerPixel(PixelFormat::kBGRA32) == 4);
+    EL_VERIFY(GetBytesPerPixel(PixelFormat::kA8) == 1);
+  }
+  EL_TEST(alpha_map) {
+    if (!Renderer::get()->supports_pixel_format(PixelFormat::kA8)) {
+      return;
+    }
+    BitmapFragmentManager frag_manager;
+    frag_manager.set_pixel_format(PixelFormat::kA8);
+    frag_manager.set_has_border(true);
+    frag_manager.SetDefaultMapSize(64, 64);
+
+    std::vector<uint8_t> coverage(10 * 12, 0xff);
+    BitmapFragment* frag = frag_manager.CreateNewFragment(
+        TBID(1u), false, 10, 12, 10, coverage.data());
+    EL_VERIFY(frag);
+    EL_VERIFY(frag->pixel_format() == PixelFormat::kA8);
+    EL_VERIFY(frag->width() == 10 && frag->height() == 12);
+    EL_VERIFY(frag->GetBitmap());
+    EL_VERIFY(frag_manager.map_count() == 1);
+
+    int fragment_pixels = 0;
+    int allocated_pixels = 0;
+    int total_pixels = 0;
+    frag_manager.GetOccupancy(&fragment_pixels, &allocated_pixels,
+                              &total_pixels);
+    EL_VERIFY(fragment_pixels == 10 * 12);
+    EL_VERIFY(total_pixels == 64 * 64);
+
+    frag_manager.FreeFragment(frag);
+    EL_VERIFY(!frag_manager.GetFragment(TBID(1u)));
+  }
+}
+
+#endif  // EL_UNIT_TESTING
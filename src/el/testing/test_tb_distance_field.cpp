@@ -0,0 +1,154 @@
+/**
+ ******************************************************************************
+ * Elemental Forms : a lightweight user interface framework                   *
+ ******************************************************************************
+ * Copyright 2015 Ben Vanik. All rights reserved. Licensed as BSD 3-clause.   *
+ * Portions ©2011-2015 Emil Segerås: https://github.com/fruxo/turbobadger     *
+ ******************************************************************************
+ */
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "el/testing/testing.h"
+#include "el/text/distance_field.h"
+#include "el/text/font_face.h"
+#include "el/text/font_manager.h"
+
+#ifdef EL_UNIT_TESTING
+
+using namespace el;
+using namespace el::text;
+
+namespace {
+
+// Renders every glyph as a filled square half the font size, and counts how
+// many glyphs it has rasterized.
+class SquareFontRenderer : public FontRenderer {
+ public:
+  static int render_count;
+
+  std::unique_ptr<FontFace> Create(FontManager* font_manager,
+                                   const std::string& filename,
+                                   const FontDescription& font_desc) override {
+    if (filename != "-test-square-font-") return nullptr;
+    auto font_renderer = std::make_unique<SquareFontRenderer>();
+    font_renderer->m_size = int(font_desc.size());
+    return std::make_unique<FontFace>(font_manager->glyph_cache(),
+                                      std::move(font_renderer), font_desc);
+  }
+
+  bool is_scalable() const override { return true; }
+
+  bool RenderGlyph(FontGlyphData* data, utf8::UCS4 cp) override {
+    ++render_count;
+    int side = m_size / 2;
+    m_bitmap.assign(side * side, 255);
+    data->w = data->h = data->stride = side;
+    data->data8 = m_bitmap.data();
+    return true;
+  }
+
+  void GetGlyphMetrics(GlyphMetrics* metrics, utf8::UCS4 cp) override {
+    metrics->advance = int16_t(m_size / 2 + 1);
+    metrics->x = 0;
+    metrics->y = int16_t(-m_size / 2);
+  }
+
+  FontMetrics GetMetrics() override {
+    FontMetrics metrics;
+    metrics.ascent = int16_t(m_size - m_size / 4);
+    metrics.descent = int16_t(m_size / 4);
+    metrics.height = int16_t(m_size);
+    return metrics;
+  }
+
+ private:
+  int m_size = 0;
+  std::vector<uint8_t> m_bitmap;
+};
+int SquareFontRenderer::render_count = 0;
+
+// Creates faces of a few sizes and renders the same glyphs with each.
+// Returns the number of glyphs rasterized by the font renderer.
+int RenderSizes(bool distance_field_glyphs) {
+  FontManager font_manager;
+  font_manager.RegisterRenderer(std::make_unique<SquareFontRenderer>());
+  font_manager.AddFontInfo("-test-square-font-", "SquareFont");
+  font_manager.set_distance_field_glyphs(distance_field_glyphs);
+  SquareFontRenderer::render_count = 0;
+  for (int size : {12, 24, 48, 96}) {
+    FontDescription font_desc;
+    font_desc.set_id(TBID("SquareFont"));
+    font_desc.set_size(size);
+    FontFace* font = font_manager.CreateFontFace(font_desc);
+    if (!font || !font->RenderGlyphs("abc")) {
+      return -1;
+    }
+    // Layout still uses the metrics of each size.
+    if (font->GetStringWidth("abc") != (size / 2 + 1) * 3) {
+      return -1;
+    }
+  }
+  return SquareFontRenderer::render_count;
+}
+
+}  // namespace
+
+EL_TEST_GROUP(tb_distance_field) {
+  EL_TEST(generate) {
+    // An 8x8 square: the field rises from the padding to the center.
+    const int spread = 4;
+    std::vector<uint8_t> coverage(8 * 8, 255);
+    const int w = 8 + spread * 2;
+    std::vector<uint8_t> field(w * w);
+    GenerateDistanceField(coverage.data(), 8, 8, 8, spread, field.data());
+    auto at = [&](int x, int y) { return int(field[x + y * w]); };
+    EL_VERIFY(at(0, 0) <= 1);
+    EL_VERIFY(at(w / 2, w / 2) > 224);
+    // Half a pixel from the outline on either side.
+    EL_VERIFY(at(spread - 1, w / 2) < 128 && at(spread - 1, w / 2) > 96);
+    EL_VERIFY(at(spread, w / 2) > 128 && at(spread, w / 2) < 160);
+    for (int x = 1; x < w / 2; ++x) {
+      EL_VERIFY(at(x, w / 2) >= at(x - 1, w / 2));
+    }
+  }
+  EL_TEST(render) {
+    const int spread = 4;
+    std::vector<uint8_t> coverage(8 * 8, 255);
+    const int w = 8 + spread * 2;
+    std::vector<uint8_t> field(w * w);
+    GenerateDistanceField(coverage.data(), 8, 8, 8, spread, field.data());
+
+    // At the same size the square comes back with crisp edges.
+    std::vector<uint8_t> same(w * w);
+    RenderDistanceField(field.data(), w, w, spread, 1.0f, same.data(), w, w);
+    for (int y = 0; y < w; ++y) {
+      for (int x = 0; x < w; ++x) {
+        bool inside = x >= spread && x < spread + 8 && y >= spread &&
+                      y < spread + 8;
+        EL_VERIFY(same[x + y * w] == (inside ? 255 : 0));
+      }
+    }
+
+    // At twice the size it covers (about) a 16x16 square.
+    std::vector<uint8_t> twice(w * w * 4);
+    RenderDistanceField(field.data(), w, w, spread, 2.0f, twice.data(), w * 2,
+                        w * 2);
+    int covered = 0;
+    for (uint8_t alpha : twice) {
+      covered += alpha;
+    }
+    EL_VERIFY(std::abs(covered / 255 - 16 * 16) < 16);
+  }
+  EL_TEST(shared_glyphs) {
+    // Bitmap glyphs are rasterized for every size, distance field glyphs only
+    // once at the reference size.
+    EL_VERIFY(RenderSizes(false) == 4 * 3);
+    EL_VERIFY(RenderSizes(true) == 3);
+  }
+}
+
+#endif  // EL_UNIT_TESTING
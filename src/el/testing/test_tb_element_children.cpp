@@ -0,0 +1,139 @@
+/**
+ ******************************************************************************
+ * Elemental Forms : a lightweight user interface framework                   *
+ ******************************************************************************
+ * Copyright 2015 Ben Vanik. All rights reserved. Licensed as BSD 3-clause.   *
+ * Portions ©2011-2015 Emil Segerås: https://github.com/fruxo/turbobadger     *
+ ******************************************************************************
+ */
+
+#include "el/element.h"
+#include "el/graphics/renderer.h"
+#include "el/testing/testing.h"
+#include "el/util/debug.h"
+#include "el/util/metrics.h"
+
+#ifdef EL_UNIT_TESTING
+
+using namespace el;
+
+namespace {
+// Adds count children laid out in a column of 10px high rows.
+void AddRows(Element* parent, int count) {
+  for (int i = 0; i < count; ++i) {
+    auto child = new Element();
+    child->set_rect(Rect(0, i * 10, 100, 10));
+    parent->AddChild(child);
+  }
+}
+
+// The list walk that GetIndexFromChild used to do.
+int ListIndexFromChild(Element* parent, Element* child) {
+  int i = 0;
+  for (Element* tmp = parent->first_child(); tmp; tmp = tmp->GetNext(), ++i) {
+    if (tmp == child) {
+      return i;
+    }
+  }
+  return -1;
+}
+}  // namespace
+
+EL_TEST_GROUP(tb_element_children) {
+  EL_TEST(index_sync) {
+    Element parent;
+    AddRows(&parent, 5);
+    Element* third = parent.GetChildFromIndex(2);
+    EL_VERIFY(parent.GetIndexFromChild(third) == 2);
+    // Append keeps the vector, insert and remove rebuild it.
+    auto appended = new Element();
+    parent.AddChild(appended);
+    EL_VERIFY(parent.GetIndexFromChild(appended) == 5);
+    auto first = new Element();
+    parent.AddChild(first, ElementZ::kBottom);
+    EL_VERIFY(parent.GetIndexFromChild(first) == 0);
+    EL_VERIFY(parent.GetIndexFromChild(third) == 3);
+    parent.RemoveChild(first);
+    delete first;
+    EL_VERIFY(parent.GetIndexFromChild(third) == 2);
+    parent.RemoveChild(appended);
+    delete appended;
+    EL_VERIFY(parent.GetChildFromIndex(5) == nullptr);
+    EL_VERIFY(parent.GetChildFromIndex(-1) == nullptr);
+    int i = 0;
+    for (Element* child = parent.first_child(); child;
+         child = child->GetNext(), ++i) {
+      EL_VERIFY(parent.GetChildFromIndex(i) == child);
+      EL_VERIFY(parent.GetIndexFromChild(child) == i);
+    }
+    parent.DeleteAllChildren();
+  }
+  EL_TEST(hit_test_topmost) {
+    Element parent;
+    parent.set_rect(Rect(0, 0, 100, 100));
+    auto bottom = new Element();
+    auto top = new Element();
+    bottom->set_rect(Rect(0, 0, 50, 50));
+    top->set_rect(Rect(25, 25, 50, 50));
+    parent.AddChild(bottom);
+    parent.AddChild(top);
+    EL_VERIFY(parent.GetElementAt(10, 10, true) == bottom);
+    EL_VERIFY(parent.GetElementAt(30, 30, true) == top);
+    EL_VERIFY(parent.GetElementAt(90, 10, true) == nullptr);
+    parent.DeleteAllChildren();
+  }
+  // Benchmarks index lookups, hit testing and painting of a wide tree.
+  EL_TEST(wide_tree_benchmark) {
+    const int kChildCount = 10000;
+    const int kLookups = 1000;
+    Element parent;
+    parent.set_rect(Rect(0, 0, 100, kChildCount * 10));
+    AddRows(&parent, kChildCount);
+
+    uint64_t start = util::GetTimeMS();
+    int list_sum = 0;
+    for (int i = 0; i < kLookups; ++i) {
+      Element* child = parent.GetChildFromIndex(i * (kChildCount / kLookups));
+      list_sum += ListIndexFromChild(&parent, child);
+    }
+    uint64_t list_time = util::GetTimeMS() - start;
+
+    start = util::GetTimeMS();
+    int vector_sum = 0;
+    for (int i = 0; i < kLookups; ++i) {
+      Element* child = parent.GetChildFromIndex(i * (kChildCount / kLookups));
+      vector_sum += parent.GetIndexFromChild(child);
+    }
+    uint64_t vector_time = util::GetTimeMS() - start;
+    EL_VERIFY(list_sum == vector_sum);
+
+    start = util::GetTimeMS();
+    int hits = 0;
+    for (int i = 0; i < kLookups; ++i) {
+      int y = i * 10 * (kChildCount / kLookups) + 5;
+      hits += parent.GetElementAt(50, y, true) ? 1 : 0;
+    }
+    uint64_t hit_time = util::GetTimeMS() - start;
+    EL_VERIFY(hits == kLookups);
+
+    uint64_t paint_time = 0;
+    if (graphics::Renderer::get()) {
+      start = util::GetTimeMS();
+      for (int i = 0; i < 10; ++i) {
+        graphics::Renderer::get()->BeginPaint(100, kChildCount * 10);
+        parent.InvokePaint(Element::PaintProps());
+        graphics::Renderer::get()->EndPaint();
+      }
+      paint_time = util::GetTimeMS() - start;
+    }
+
+    TBDebugOut(
+        "%d children: %d index lookups %dms (list walk %dms), %d hit tests "
+        "%dms, 10 paints %dms\n",
+        kChildCount, kLookups, int(vector_time), int(list_time), kLookups,
+        int(hit_time), int(paint_time));
+    parent.DeleteAllChildren();
+  }
+}
+
+#endif  // EL_UNIT_TESTING
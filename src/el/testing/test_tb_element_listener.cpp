@@ -0,0 +1,69 @@
+/**
+ ******************************************************************************
+ * Elemental Forms : a lightweight user interface framework                   *
+ ******************************************************************************
+ * Copyright 2015 Ben Vanik. All rights reserved. Licensed as BSD 3-clause.   *
+ * Portions ©2011-2015 Emil Segerås: https://github.com/fruxo/turbobadger     *
+ ******************************************************************************
+ */
+
+#include "el/element.h"
+#include "el/element_listener.h"
+#include "el/testing/testing.h"
+
+#ifdef EL_UNIT_TESTING
+
+using namespace el;
+
+namespace {
+class CountingListener : public ElementListener {
+ public:
+  void OnElementAdded(Element* parent, Element* child) override { ++added; }
+  void OnElementRemove(Element* parent, Element* child) override {
+    ++removed;
+    if (remove_on_remove) {
+      ElementListener::RemoveGlobalListener(remove_on_remove);
+    }
+  }
+
+  int added = 0;
+  int removed = 0;
+  ElementListener* remove_on_remove = nullptr;
+};
+}  // namespace
+
+EL_TEST_GROUP(tb_element_listener) {
+  EL_TEST(subscription_mask) {
+    CountingListener listener;
+    ElementListener::AddGlobalListener(&listener,
+                                       ElementListenerEvents::kAdded);
+    Element parent;
+    Element child;
+    parent.AddChild(&child);
+    parent.RemoveChild(&child);
+    ElementListener::RemoveGlobalListener(&listener);
+    EL_VERIFY(listener.added == 1);
+    EL_VERIFY(listener.removed == 0);
+  }
+  EL_TEST(remove_during_dispatch) {
+    CountingListener first;
+    CountingListener second;
+    first.remove_on_remove = &second;
+    ElementListener::AddGlobalListener(&first);
+    ElementListener::AddGlobalListener(&second);
+    Element parent;
+    Element child;
+    parent.AddChild(&child);
+    parent.RemoveChild(&child);
+    // second was removed by first before it got the callback.
+    EL_VERIFY(first.removed == 1);
+    EL_VERIFY(second.added == 1 && second.removed == 0);
+    parent.AddChild(&child);
+    parent.RemoveChild(&child);
+    EL_VERIFY(second.added == 1);
+    ElementListener::RemoveGlobalListener(&first);
+    EL_VERIFY(first.added == 2);
+  }
+}
+
+#endif  // EL_UNIT_TESTING
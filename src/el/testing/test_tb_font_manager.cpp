@@ -0,0 +1,74 @@
+/**
+ ******************************************************************************
+ * Elemental Forms : a lightweight user interface framework                   *
+ ******************************************************************************
+ * Copyright 2015 Ben Vanik. All rights reserved. Licensed as BSD 3-clause.   *
+ * Portions ©2011-2015 Emil Segerås: https://github.com/fruxo/turbobadger     *
+ ******************************************************************************
+ */
+
+#include <memory>
+
+#include "el/testing/testing.h"
+#include "el/text/font_manager.h"
+
+#ifdef EL_UNIT_TESTING
+
+using namespace el;
+using namespace el::text;
+
+EL_TEST_GROUP(tb_font_manager) {
+  EL_TEST(shared_resource) {
+    FontManager* font_manager = FontManager::get();
+    size_t base_count = font_manager->shared_font_resource_count();
+    int load_count = 0;
+    auto loader = [&load_count]() {
+      ++load_count;
+      return std::make_shared<int>(load_count);
+    };
+    auto a = font_manager->GetSharedFontResource<int>("test:a", loader);
+    auto b = font_manager->GetSharedFontResource<int>("test:a", loader);
+    EL_VERIFY(a == b);
+    EL_VERIFY(load_count == 1);
+    EL_VERIFY(font_manager->shared_font_resource_count() == base_count + 1);
+
+    // Released when the last user drops it, and loaded again on next use.
+    a.reset();
+    b.reset();
+    EL_VERIFY(font_manager->shared_font_resource_count() == base_count);
+    auto c = font_manager->GetSharedFontResource<int>("test:a", loader);
+    EL_VERIFY(load_count == 2);
+    EL_VERIFY(*c == 2);
+  }
+  EL_TEST(shared_resource_nested_load) {
+    FontManager* font_manager = FontManager::get();
+    // Leaves a released resource behind to be erased while loading.
+    font_manager->GetSharedFontResource<int>(
+        "test:released", []() { return std::make_shared<int>(0); });
+    std::shared_ptr<int> inner;
+    auto outer = font_manager->GetSharedFontResource<int>(
+        "test:outer", [font_manager, &inner]() {
+          inner = font_manager->GetSharedFontResource<int>(
+              "test:inner", []() { return std::make_shared<int>(1); });
+          return std::make_shared<int>(*inner + 1);
+        });
+    EL_VERIFY(*outer == 2);
+    auto outer_again = font_manager->GetSharedFontResource<int>(
+        "test:outer", []() { return std::make_shared<int>(0); });
+    EL_VERIFY(outer_again == outer);
+    auto inner_again = font_manager->GetSharedFontResource<int>(
+        "test:inner", []() { return std::make_shared<int>(0); });
+    EL_VERIFY(inner_again == inner);
+  }
+  EL_TEST(shared_font_file) {
+    FontManager* font_manager = FontManager::get();
+    auto a = font_manager->GetFontFile(EL_TEST_FILE("data/quickbrown.txt"));
+    auto b = font_manager->GetFontFile(EL_TEST_FILE("data/quickbrown.txt"));
+    EL_VERIFY(a && a == b);
+    EL_VERIFY(a->size() > 0);
+    EL_VERIFY(a->data()[0] != 0);
+    EL_VERIFY(!font_manager->GetFontFile(EL_TEST_FILE("data/missing.ttf")));
+  }
+}
+
+#endif  // EL_UNIT_TESTING
@@ -0,0 +1,65 @@
+/**
+ ******************************************************************************
+ * Elemental Forms : a lightweight user interface framework                   *
+ ******************************************************************************
+ * Copyright 2015 Ben Vanik. All rights reserved. Licensed as BSD 3-clause.   *
+ * Portions ©2011-2015 Emil Segerås: https://github.com/fruxo/turbobadger     *
+ ******************************************************************************
+ */
+
+#include "el/element.h"
+#include "el/frame_scheduler.h"
+#include "el/testing/testing.h"
+#include "el/util/metrics.h"
+
+#ifdef EL_UNIT_TESTING
+
+using namespace el;
+
+EL_TEST_GROUP(tb_frame_scheduler) {
+  EL_TEST(invalidate_makes_dirty) {
+    FrameScheduler::BeginFrame();
+    Element element;
+    element.set_rect(Rect(0, 0, 10, 10));
+    FrameScheduler::BeginFrame();
+    EL_VERIFY(!any(FrameScheduler::GetDueSources(util::GetTimeMS()) &
+                   FrameSource::kInvalidation));
+    element.Invalidate();
+    FrameSource sources;
+    EL_VERIFY(FrameScheduler::GetNextDeadline(&sources) == 0);
+    EL_VERIFY(any(sources & FrameSource::kInvalidation));
+    EL_VERIFY(FrameScheduler::is_dirty());
+    EL_VERIFY(any(FrameScheduler::BeginFrame() & FrameSource::kInvalidation));
+    EL_VERIFY(!any(FrameScheduler::GetDueSources(util::GetTimeMS()) &
+                   FrameSource::kInvalidation));
+  }
+  EL_TEST(layout_attribution) {
+    Element element;
+    element.set_rect(Rect(0, 0, 10, 10));
+    FrameScheduler::BeginFrame();
+    element.InvalidateLayout(Element::InvalidationMode::kTargetOnly);
+    FrameSource sources = FrameScheduler::BeginFrame();
+    EL_VERIFY(any(sources & FrameSource::kLayout));
+    EL_VERIFY(any(sources & FrameSource::kInvalidation));
+  }
+  EL_TEST(deadline) {
+    FrameScheduler::BeginFrame();
+    uint64_t time = util::GetTimeMS() + 100000;
+    FrameScheduler::RequestFrameAt(FrameSource::kCaret, time);
+    FrameSource sources;
+    uint64_t deadline = FrameScheduler::GetNextDeadline(&sources);
+    // Something else (such as a pending message) may be due earlier.
+    EL_VERIFY(deadline <= time);
+    if (deadline == time) {
+      EL_VERIFY(any(sources & FrameSource::kCaret));
+    }
+    EL_VERIFY(!any(FrameScheduler::GetDueSources(time - 1) &
+                   FrameSource::kCaret));
+    EL_VERIFY(any(FrameScheduler::GetDueSources(time) & FrameSource::kCaret));
+    // Not due yet, so it survives the frame.
+    FrameScheduler::BeginFrame();
+    EL_VERIFY(any(FrameScheduler::GetDueSources(time) & FrameSource::kCaret));
+  }
+}
+
+#endif  // EL_UNIT_TESTING
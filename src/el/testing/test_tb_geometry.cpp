@@ -7,14 +7,72 @@
  ******************************************************************************
  */
 
+#include <cstdlib>
+#include <vector>
+
 #include "el/rect.h"
 #include "el/testing/testing.h"
+#include "el/util/debug.h"
+#include "el/util/metrics.h"
 #include "el/util/rect_region.h"
 
 #ifdef EL_UNIT_TESTING
 
 using namespace el;
 
+namespace {
+
+constexpr int kCoverageSize = 64;
+
+// Returns a random rect within kCoverageSize x kCoverageSize.
+Rect RandomRect() {
+  int x = std::rand() % (kCoverageSize - 1);
+  int y = std::rand() % (kCoverageSize - 1);
+  return Rect(x, y, 1 + std::rand() % (kCoverageSize - x),
+              1 + std::rand() % (kCoverageSize - y));
+}
+
+// Sets the pixels covered by rect in coverage to value.
+void FillCoverage(std::vector<bool>* coverage, const Rect& rect, bool value) {
+  for (int y = rect.y; y < rect.y + rect.h; ++y) {
+    for (int x = rect.x; x < rect.x + rect.w; ++x) {
+      (*coverage)[y * kCoverageSize + x] = value;
+    }
+  }
+}
+
+// Returns true if the region covers exactly the pixels set in coverage, with
+// no overlap and in band order.
+bool MatchesCoverage(const util::RectRegion& region,
+                     const std::vector<bool>& coverage) {
+  std::vector<bool> region_coverage(coverage.size(), false);
+  for (size_t i = 0; i < region.size(); ++i) {
+    const Rect& rect = region[i];
+    if (rect.empty()) {
+      return false;
+    }
+    if (i > 0) {
+      const Rect& prev = region[i - 1];
+      bool same_band = prev.y == rect.y;
+      if (same_band ? (prev.h != rect.h || prev.x + prev.w >= rect.x)
+                    : prev.y + prev.h > rect.y) {
+        return false;
+      }
+    }
+    for (int y = rect.y; y < rect.y + rect.h; ++y) {
+      for (int x = rect.x; x < rect.x + rect.w; ++x) {
+        if (region_coverage[y * kCoverageSize + x]) {
+          return false;
+        }
+        region_coverage[y * kCoverageSize + x] = true;
+      }
+    }
+  }
+  return region_coverage == coverage;
+}
+
+}  // namespace
+
 EL_TEST_GROUP(tb_geometry) {
   EL_TEST(RectRegion_include) {
     util::RectRegion region;
@@ -22,8 +80,8 @@ EL_TEST_GROUP(tb_geometry) {
     EL_VERIFY(region.IncludeRect(Rect(10, 10, 100, 100)));
     EL_VERIFY(region.IncludeRect(Rect(50, 50, 100, 100)));
     EL_VERIFY(region.size() == 3);
-    EL_VERIFY(region[0].equals(Rect(10, 10, 100, 100)));
-    EL_VERIFY(region[1].equals(Rect(110, 50, 40, 60)));
+    EL_VERIFY(region[0].equals(Rect(10, 10, 100, 40)));
+    EL_VERIFY(region[1].equals(Rect(10, 50, 140, 60)));
     EL_VERIFY(region[2].equals(Rect(50, 110, 100, 40)));
   }
 
@@ -96,6 +154,104 @@ EL_TEST_GROUP(tb_geometry) {
     EL_VERIFY(region[2].equals(Rect(170, 130, 30, 40)));
     EL_VERIFY(region[3].equals(Rect(100, 170, 100, 30)));
   }
+
+  EL_TEST(RectRegion_intersect) {
+    util::RectRegion region;
+
+    EL_VERIFY(region.Set(Rect(0, 0, 100, 100)));
+    EL_VERIFY(region.ExcludeRect(Rect(40, 0, 20, 100)));
+    EL_VERIFY(region.IntersectRect(Rect(20, 20, 60, 10)));
+    EL_VERIFY(region.size() == 2);
+    EL_VERIFY(region[0].equals(Rect(20, 20, 20, 10)));
+    EL_VERIFY(region[1].equals(Rect(60, 20, 20, 10)));
+
+    EL_VERIFY(region.IntersectRect(Rect(200, 200, 10, 10)));
+    EL_VERIFY(region.empty());
+  }
+
+  EL_TEST(RectRegion_random_operations) {
+    std::srand(1234);
+    util::RectRegion region;
+    std::vector<bool> coverage(kCoverageSize * kCoverageSize, false);
+    for (int i = 0; i < 500; ++i) {
+      Rect rect = RandomRect();
+      if (i % 3 == 2) {
+        EL_VERIFY(region.ExcludeRect(rect));
+        FillCoverage(&coverage, rect, false);
+      } else {
+        EL_VERIFY(region.IncludeRect(rect));
+        FillCoverage(&coverage, rect, true);
+      }
+      EL_VERIFY(MatchesCoverage(region, coverage));
+    }
+
+    // Region against region.
+    util::RectRegion other;
+    std::vector<bool> other_coverage(coverage.size(), false);
+    for (int i = 0; i < 20; ++i) {
+      Rect rect = RandomRect();
+      EL_VERIFY(other.IncludeRect(rect));
+      FillCoverage(&other_coverage, rect, true);
+    }
+    util::RectRegion intersected = region;
+    EL_VERIFY(intersected.IntersectRegion(other));
+    util::RectRegion excluded = region;
+    EL_VERIFY(excluded.ExcludeRegion(other));
+    util::RectRegion included = region;
+    EL_VERIFY(included.IncludeRegion(other));
+    std::vector<bool> expected(coverage.size());
+    for (size_t i = 0; i < coverage.size(); ++i) {
+      expected[i] = coverage[i] && other_coverage[i];
+    }
+    EL_VERIFY(MatchesCoverage(intersected, expected));
+    for (size_t i = 0; i < coverage.size(); ++i) {
+      expected[i] = coverage[i] && !other_coverage[i];
+    }
+    EL_VERIFY(MatchesCoverage(excluded, expected));
+    for (size_t i = 0; i < coverage.size(); ++i) {
+      expected[i] = coverage[i] || other_coverage[i];
+    }
+    EL_VERIFY(MatchesCoverage(included, expected));
+  }
+
+  EL_TEST(RectRegion_benchmark) {
+    // Rows of overlapping rects, like selections over many lines of text.
+    const int kRects = 5000;
+    std::srand(4321);
+    std::vector<Rect> rects;
+    for (int i = 0; i < kRects; ++i) {
+      rects.push_back(Rect(std::rand() % 1000, (i / 4) * 16 + std::rand() % 8,
+                           10 + std::rand() % 200, 16));
+    }
+
+    uint64_t start = util::GetTimeMS();
+    util::RectRegion region;
+    for (const Rect& rect : rects) {
+      region.IncludeRect(rect);
+    }
+    uint64_t include_time = util::GetTimeMS() - start;
+
+    start = util::GetTimeMS();
+    for (int i = 0; i < kRects; i += 4) {
+      region.ExcludeRect(Rect(rects[i].x, rects[i].y, 8, 8));
+    }
+    uint64_t exclude_time = util::GetTimeMS() - start;
+
+    start = util::GetTimeMS();
+    util::RectRegion clip;
+    for (int i = 0; i < 100; ++i) {
+      clip.IncludeRect(Rect(i * 10, i * 200, 500, 100));
+    }
+    region.IntersectRegion(clip);
+    uint64_t intersect_time = util::GetTimeMS() - start;
+
+    EL_VERIFY(!region.empty());
+    TBDebugOut(
+        "RectRegion x%d: include %dms, exclude %dms, intersect %dms (%d "
+        "rects)\n",
+        kRects, int(include_time), int(exclude_time), int(intersect_time),
+        int(region.size()));
+  }
 }
 
 #endif  // EL_UNIT_TESTING
@@ -0,0 +1,162 @@
+/**
+ ******************************************************************************
+ * Elemental Forms : a lightweight user interface framework                   *
+ ******************************************************************************
+ * Copyright 2015 Ben Vanik. All rights reserved. Licensed as BSD 3-clause.   *
+ * Portions ©2011-2015 Emil Segerås: https://github.com/fruxo/turbobadger     *
+ ******************************************************************************
+ */
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "el/color.h"
+#include "el/testing/testing.h"
+#include "el/text/glyph_kernels.h"
+#include "el/util/debug.h"
+#include "el/util/metrics.h"
+
+#ifdef EL_UNIT_TESTING
+
+using namespace el;
+using namespace el::text;
+
+namespace {
+
+// The straightforward blur the kernels replaced, with a bounds check per tap.
+void ReferenceBlurGlyph(const uint8_t* src, int srcw, int srch, int srcStride,
+                        uint8_t* dst, int dstw, int dsth, int dstStride,
+                        float* temp, const float* kernel, int kernelRadius) {
+  for (int y = 0; y < srch; y++) {
+    for (int x = 0; x < dstw; x++) {
+      float val = 0;
+      for (int k_ofs = -kernelRadius; k_ofs <= kernelRadius; k_ofs++) {
+        if (x - kernelRadius + k_ofs >= 0 && x - kernelRadius + k_ofs < srcw) {
+          val += src[y * srcStride + x - kernelRadius + k_ofs] *
+                 kernel[k_ofs + kernelRadius];
+        }
+      }
+      temp[y * dstw + x] = val;
+    }
+  }
+  for (int y = 0; y < dsth; y++) {
+    for (int x = 0; x < dstw; x++) {
+      float val = 0;
+      for (int k_ofs = -kernelRadius; k_ofs <= kernelRadius; k_ofs++) {
+        if (y - kernelRadius + k_ofs >= 0 && y - kernelRadius + k_ofs < srch) {
+          val += temp[(y - kernelRadius + k_ofs) * dstw + x] *
+                 kernel[k_ofs + kernelRadius];
+        }
+      }
+      dst[y * dstStride + x] = (unsigned char)(val + 0.5f);
+    }
+  }
+}
+
+std::vector<float> MakeKernel(int radius) {
+  std::vector<float> kernel(radius * 2 + 1);
+  float sum = 0;
+  for (int k = 0; k < radius * 2 + 1; ++k) {
+    float x = float(k - radius);
+    kernel[k] = std::exp(-(x * x) / (radius * radius * 0.5f));
+    sum += kernel[k];
+  }
+  for (float& k : kernel) {
+    k /= sum;
+  }
+  return kernel;
+}
+
+// A glyph-like test pattern with solid, empty and anti-aliased areas.
+std::vector<uint8_t> MakeGlyph(int w, int h, int stride) {
+  std::vector<uint8_t> glyph(stride * h);
+  for (int y = 0; y < h; ++y) {
+    for (int x = 0; x < w; ++x) {
+      glyph[x + y * stride] = uint8_t((x * 37 + y * 91) % 5 ? 255 : x * 7);
+    }
+  }
+  return glyph;
+}
+
+}  // namespace
+
+EL_TEST_GROUP(tb_glyph_kernels) {
+  EL_TEST(blur_matches_reference) {
+    for (int radius : {1, 2, 3, 6}) {
+      const int w = 23, h = 31, stride = 29;
+      auto glyph = MakeGlyph(w, h, stride);
+      auto kernel = MakeKernel(radius);
+      const int dst_w = w + radius * 2, dst_h = h + radius * 2;
+
+      std::vector<uint8_t> expected(dst_w * dst_h);
+      std::vector<float> reference_temp(dst_w * h);
+      ReferenceBlurGlyph(glyph.data(), w, h, stride, expected.data(), dst_w,
+                         dst_h, dst_w, reference_temp.data(), kernel.data(),
+                         radius);
+
+      std::vector<uint8_t> actual(dst_w * dst_h);
+      std::vector<float> temp(GetBlurGlyphTempSize(w, h, radius));
+      BlurGlyph(glyph.data(), w, h, stride, actual.data(), dst_w, temp.data(),
+                kernel.data(), radius);
+
+      // Summation order differs slightly, so allow off by one rounding.
+      for (size_t i = 0; i < expected.size(); ++i) {
+        EL_VERIFY(std::abs(expected[i] - actual[i]) <= 1);
+      }
+    }
+  }
+  EL_TEST(expand_coverage) {
+    // Wide enough to use vectors, with a scalar tail and row padding.
+    const int w = 37, h = 3, stride = 40;
+    auto glyph = MakeGlyph(w, h, stride);
+    std::vector<uint32_t> pixels(w * h);
+    ExpandCoverageToBGRA(glyph.data(), w, h, stride, pixels.data());
+    for (int y = 0; y < h; ++y) {
+      for (int x = 0; x < w; ++x) {
+        EL_VERIFY(pixels[x + y * w] ==
+                  uint32_t(Color(255, 255, 255, glyph[x + y * stride])));
+      }
+    }
+  }
+  // Microbenchmark of rendering shadowed glyphs (blur + conversion) the first
+  // time.
+  EL_TEST(shadow_benchmark) {
+    const int kGlyphs = 2000;
+    const int w = 16, h = 24, radius = 3;
+    const int dst_w = w + radius * 2, dst_h = h + radius * 2;
+    auto glyph = MakeGlyph(w, h, w);
+    auto kernel = MakeKernel(radius);
+    std::vector<uint8_t> blurred(dst_w * dst_h);
+    std::vector<uint32_t> pixels(dst_w * dst_h);
+    std::vector<float> temp(GetBlurGlyphTempSize(w, h, radius));
+
+    uint32_t reference_check = 0;
+    uint64_t start = util::GetTimeMS();
+    for (int i = 0; i < kGlyphs; ++i) {
+      ReferenceBlurGlyph(glyph.data(), w, h, w, blurred.data(), dst_w, dst_h,
+                         dst_w, temp.data(), kernel.data(), radius);
+      for (size_t j = 0; j < blurred.size(); ++j) {
+        pixels[j] = Color(255, 255, 255, blurred[j]);
+      }
+      reference_check += pixels[i % pixels.size()];
+    }
+    uint64_t reference_time = util::GetTimeMS() - start;
+
+    uint32_t kernel_check = 0;
+    start = util::GetTimeMS();
+    for (int i = 0; i < kGlyphs; ++i) {
+      BlurGlyph(glyph.data(), w, h, w, blurred.data(), dst_w, temp.data(),
+                kernel.data(), radius);
+      ExpandCoverageToBGRA(blurred.data(), dst_w, dst_h, dst_w, pixels.data());
+      kernel_check += pixels[i % pixels.size()];
+    }
+    uint64_t kernel_time = util::GetTimeMS() - start;
+
+    EL_VERIFY(reference_check != 0 && kernel_check != 0);
+    TBDebugOut("Shadowed glyphs x%d: reference %dms, kernels %dms\n", kGlyphs,
+               int(reference_time), int(kernel_time));
+  }
+}
+
+#endif  // EL_UNIT_TESTING
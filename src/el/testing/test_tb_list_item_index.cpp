@@ -0,0 +1,135 @@
+/**
+ ******************************************************************************
+ * Elemental Forms : a lightweight user interface framework                   *
+ ******************************************************************************
+ * Copyright 2015 Ben Vanik. All rights reserved. Licensed as BSD 3-clause.   *
+ * Portions ©2011-2015 Emil Segerås: https://github.com/fruxo/turbobadger     *
+ ******************************************************************************
+ */
+
+#include "el/elements/list_box.h"
+#include "el/testing/testing.h"
+
+#ifdef EL_UNIT_TESTING
+
+using namespace el;
+
+namespace {
+// Forwards item notifications to an index like ListBox does.
+class IndexObserver : public ListItemObserver {
+ public:
+  void OnSourceChanged() override { index.Reset(); }
+  void OnItemChanged(size_t i) override { index.OnItemChanged(m_source, i); }
+  void OnItemAdded(size_t i) override { index.OnItemAdded(m_source, i); }
+  void OnItemRemoved(size_t i) override { index.OnItemRemoved(i); }
+  void OnAllItemsRemoved() override { index.Reset(); }
+
+  // Returns the matching item strings joined with spaces.
+  std::string Filter(const std::string& filter) {
+    std::string result;
+    for (size_t i : index.Filter(m_source, filter)) {
+      if (!result.empty()) {
+        result += ' ';
+      }
+      result += m_source->GetItemString(i);
+    }
+    return result;
+  }
+
+  ListItemIndex index;
+};
+
+// Also matches items by their length.
+class LengthFilterSource : public ListItemSourceList<GenericStringItem> {
+ public:
+  bool Filter(size_t index, const std::string& filter) override {
+    if (ListItemSource::Filter(index, filter)) return true;
+    return std::to_string(strlen(GetItemString(index))) == filter;
+  }
+};
+
+void AddItems(ListItemSourceList<GenericStringItem>* source,
+              std::initializer_list<const char*> items) {
+  for (auto item : items) {
+    source->push_back(std::make_unique<GenericStringItem>(item));
+  }
+}
+}  // namespace
+
+EL_TEST_GROUP(tb_list_item_index) {
+  EL_TEST(filter) {
+    GenericStringItemSource source;
+    AddItems(&source, {"Apple", "banana", "Cherry", "grape"});
+    IndexObserver observer;
+    observer.set_source(&source);
+    EL_VERIFY(observer.Filter("") == "Apple banana Cherry grape");
+    EL_VERIFY(observer.Filter("A") == "Apple banana grape");
+    EL_VERIFY(observer.Filter("ap") == "Apple grape");
+    EL_VERIFY(observer.Filter("APP") == "Apple");
+    EL_VERIFY(observer.Filter("an") == "banana");
+    EL_VERIFY(observer.Filter("x") == "");
+    observer.set_source(nullptr);
+  }
+  EL_TEST(custom_filter) {
+    LengthFilterSource source;
+    AddItems(&source, {"Apple", "banana", "Cherry", "grape", "6"});
+    IndexObserver observer;
+    observer.set_source(&source);
+    EL_VERIFY(observer.Filter("6") == "banana Cherry 6");
+    EL_VERIFY(observer.Filter("5") == "Apple grape");
+    EL_VERIFY(observer.Filter("ap") == "Apple grape");
+    observer.set_source(nullptr);
+  }
+  EL_TEST(sort) {
+    GenericStringItemSource source;
+    AddItems(&source, {"b", "d", "a", "c"});
+    source.set_sort(Sort::kAscending);
+    IndexObserver observer;
+    observer.set_source(&source);
+    EL_VERIFY(observer.Filter("") == "a b c d");
+    source.set_sort(Sort::kDescending);
+    EL_VERIFY(observer.Filter("") == "d c b a");
+    observer.set_source(nullptr);
+  }
+  EL_TEST(add_remove) {
+    GenericStringItemSource source;
+    AddItems(&source, {"b", "d"});
+    source.set_sort(Sort::kAscending);
+    IndexObserver observer;
+    observer.set_source(&source);
+    EL_VERIFY(observer.Filter("") == "b d");
+    AddItems(&source, {"c", "a"});
+    EL_VERIFY(observer.Filter("") == "a b c d");
+    source.insert(0, std::make_unique<GenericStringItem>("e"));
+    EL_VERIFY(observer.Filter("") == "a b c d e");
+    source.erase(1);  // "b"
+    EL_VERIFY(observer.Filter("") == "a c d e");
+    source.at(0)->str = "b";  // "e"
+    source.InvokeItemChanged(0);
+    EL_VERIFY(observer.Filter("") == "a b c d");
+    source.clear();
+    EL_VERIFY(observer.Filter("") == "");
+    observer.set_source(nullptr);
+  }
+  EL_TEST(large_source) {
+    GenericStringItemSource source;
+    for (int i = 0; i < 50000; ++i) {
+      source.push_back(
+          std::make_unique<GenericStringItem>("item" + std::to_string(i)));
+    }
+    IndexObserver observer;
+    observer.set_source(&source);
+    EL_VERIFY(observer.index.Filter(&source, "item").size() == 50000);
+    EL_VERIFY(observer.index.Filter(&source, "item4").size() == 11111);
+    EL_VERIFY(observer.index.Filter(&source, "item49").size() == 1111);
+    EL_VERIFY(observer.index.Filter(&source, "item4999").size() == 11);
+    auto& matches = observer.index.Filter(&source, "7");
+    EL_VERIFY(matches.size() == 17195);
+    for (size_t i = 1; i < matches.size(); ++i) {
+      EL_VERIFY(matches[i - 1] < matches[i]);
+    }
+    observer.set_source(nullptr);
+  }
+}
+
+#endif  // EL_UNIT_TESTING
@@ -0,0 +1,148 @@
+/**
+ ******************************************************************************
+ * Elemental Forms : a lightweight user interface framework                   *
+ ******************************************************************************
+ * Copyright 2015 Ben Vanik. All rights reserved. Licensed as BSD 3-clause.   *
+ * Portions ©2011-2015 Emil Segerås: https://github.com/fruxo/turbobadger     *
+ ******************************************************************************
+ */
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "el/message_handler.h"
+#include "el/testing/testing.h"
+
+#ifdef EL_UNIT_TESTING
+
+using namespace el;
+
+namespace {
+class RecordingHandler : public MessageHandler {
+ public:
+  void OnMessageReceived(Message* msg) override {
+    received.push_back(msg->message_id());
+  }
+
+  std::vector<uint32_t> received;
+};
+
+std::atomic<int> wake_up_count(0);
+void CountWakeUp() { ++wake_up_count; }
+}  // namespace
+
+EL_TEST_GROUP(tb_message_handler) {
+  EL_TEST(delayed_order) {
+    RecordingHandler handler;
+    // Fire times in the past so everything is due immediately.
+    handler.PostMessageOnTime(TBID(3u), nullptr, 30);
+    handler.PostMessageOnTime(TBID(1u), nullptr, 10);
+    handler.PostMessageOnTime(TBID(4u), nullptr, 30);
+    handler.PostMessageOnTime(TBID(2u), nullptr, 20);
+    handler.PostMessageOnTime(TBID(5u), nullptr, 30);
+    handler.PostMessage(TBID(6u), nullptr);
+    MessageHandler::ProcessMessages();
+    EL_VERIFY(handler.received.size() == 6);
+    for (uint32_t i = 0; i < handler.received.size(); ++i) {
+      EL_VERIFY(handler.received[i] == i + 1);
+    }
+  }
+  EL_TEST(get_and_delete) {
+    RecordingHandler handler;
+    handler.PostMessageOnTime(TBID(1u), nullptr, 10);
+    handler.PostMessageOnTime(TBID(2u), nullptr, 20);
+    handler.PostMessageOnTime(TBID(2u), nullptr, 5);
+    handler.PostMessageOnTime(TBID(3u), nullptr, 30);
+    handler.PostMessage(TBID(4u), nullptr);
+    EL_VERIFY(!handler.GetMessageById(TBID(5u)));
+    // The first posted message with the id is returned.
+    Message* msg = handler.GetMessageById(TBID(2u));
+    EL_VERIFY(msg && msg->fire_time_millis() == 20);
+    handler.DeleteMessage(msg);
+    handler.DeleteMessage(handler.GetMessageById(TBID(4u)));
+    EL_VERIFY(!handler.GetMessageById(TBID(4u)));
+    MessageHandler::ProcessMessages();
+    EL_VERIFY(handler.received.size() == 3);
+    EL_VERIFY(handler.received[0] == 2);
+    EL_VERIFY(handler.received[1] == 1);
+    EL_VERIFY(handler.received[2] == 3);
+    EL_VERIFY(!handler.GetMessageById(TBID(2u)));
+  }
+  EL_TEST(delete_all) {
+    size_t depth = MessageHandler::stats().delayed_queue_depth;
+    {
+      RecordingHandler handler;
+      for (uint32_t i = 0; i < 100; ++i) {
+        handler.PostMessageDelayed(TBID(i % 7), nullptr, 100000 + i);
+      }
+      EL_VERIFY(MessageHandler::stats().delayed_queue_depth == depth + 100);
+    }
+    EL_VERIFY(MessageHandler::stats().delayed_queue_depth == depth);
+  }
+  EL_TEST(post_from_any_thread) {
+    const uint32_t kThreadCount = 4;
+    const uint32_t kMessagesPerThread = 1000;
+    RecordingHandler handler;
+    // TBIDs are created up front since creating them isn't thread safe in
+    // debug builds.
+    std::vector<TBID> ids;
+    for (uint32_t i = 0; i < kThreadCount * kMessagesPerThread; ++i) {
+      ids.emplace_back(i);
+    }
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < kThreadCount; ++t) {
+      threads.emplace_back([&handler, &ids, t, kMessagesPerThread] {
+        for (uint32_t i = 0; i < kMessagesPerThread; ++i) {
+          handler.PostMessageFromAnyThread(ids[t * kMessagesPerThread + i],
+                                           nullptr);
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    EL_VERIFY(MessageHandler::GetNextMessageFireTime() == 0);
+    MessageHandler::ProcessMessages();
+    EL_VERIFY(handler.received.size() == kThreadCount * kMessagesPerThread);
+    // Messages from each thread arrive in the order they were posted.
+    std::vector<uint32_t> next(kThreadCount, 0);
+    for (uint32_t id : handler.received) {
+      uint32_t t = id / kMessagesPerThread;
+      EL_VERIFY(id % kMessagesPerThread == next[t]);
+      ++next[t];
+    }
+  }
+  EL_TEST(post_from_any_thread_then_delete) {
+    auto handler = std::make_unique<RecordingHandler>();
+    TBID id(1u);
+    std::thread([&handler, &id] {
+      handler->PostMessageFromAnyThread(id, nullptr);
+    }).join();
+    // Pending inbox messages are dropped with their handler.
+    handler.reset();
+    MessageHandler::ProcessMessages();
+  }
+  EL_TEST(post_from_any_thread_wakes_up) {
+    RecordingHandler handler;
+    TBID id(1u);
+    wake_up_count = 0;
+    MessageHandler::set_wake_up_callback(CountWakeUp);
+    std::thread([&handler, &id] {
+      handler.PostMessageFromAnyThread(id, nullptr);
+      handler.PostMessageFromAnyThread(id, nullptr);
+    }).join();
+    // Only the post to an empty inbox wakes up the host.
+    EL_VERIFY(wake_up_count == 1);
+    MessageHandler::ProcessMessages();
+    EL_VERIFY(handler.received.size() == 2);
+    std::thread([&handler, &id] {
+      handler.PostMessageFromAnyThread(id, nullptr);
+    }).join();
+    EL_VERIFY(wake_up_count == 2);
+    MessageHandler::set_wake_up_callback(nullptr);
+    MessageHandler::ProcessMessages();
+  }
+}
+
+#endif  // EL_UNIT_TESTING
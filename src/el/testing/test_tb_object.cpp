@@ -7,7 +7,11 @@
  ******************************************************************************
  */
 
+#include <cstring>
+
 #include "el/testing/testing.h"
+#include "el/util/debug.h"
+#include "el/util/metrics.h"
 #include "el/util/object.h"
 
 #ifdef EL_UNIT_TESTING
@@ -52,6 +56,110 @@ EL_TEST_GROUP(tb_object) {
     EL_VERIFY(!SafeCast<Car>(&apple));
     EL_VERIFY(SafeCast<Car>(&car));
   }
+
+  EL_TEST(type_name) {
+    Apple apple;
+    TypedObject* obj = &apple;
+    EL_VERIFY(strcmp(obj->GetTypeName(), "Apple") == 0);
+    EL_VERIFY(obj->GetTypeInfo()->parent() == Fruit::GetStaticTypeInfo());
+  }
+
+  // Registered after the types above have been numbered and queried.
+  class GreenApple : public Apple {
+   public:
+    TBOBJECT_SUBCLASS(GreenApple, Apple);
+  };
+
+  EL_TEST(late_registration) {
+    Apple apple;
+    EL_VERIFY(SafeCast<Fruit>(&apple));
+    GreenApple green_apple;
+    EL_VERIFY(SafeCast<Apple>(&green_apple));
+    EL_VERIFY(SafeCast<Fruit>(&green_apple));
+    EL_VERIFY(!SafeCast<Car>(&green_apple));
+    EL_VERIFY(!SafeCast<GreenApple>(&apple));
+    EL_VERIFY(SafeCast<Fruit>(&apple));
+  }
+
+  // The virtual IsOfTypeId chain that TBOBJECT_SUBCLASS used to implement,
+  // kept here to benchmark the range check against.
+  template <class T>
+  const void* GetChainTypeId() {
+    static char type_id;
+    return &type_id;
+  }
+
+  class ChainObject : public TypedObject {
+   public:
+    TBOBJECT_SUBCLASS(ChainObject, TypedObject);
+    virtual bool IsOfChainTypeId(const void* type_id) const {
+      return type_id == GetChainTypeId<ChainObject>();
+    }
+  };
+
+#define CHAIN_SUBCLASS(clazz, baseclazz)                     \
+  TBOBJECT_SUBCLASS(clazz, baseclazz);                       \
+  bool IsOfChainTypeId(const void* type_id) const override { \
+    return GetChainTypeId<clazz>() == type_id                \
+               ? true                                        \
+               : baseclazz::IsOfChainTypeId(type_id);        \
+  }
+
+  class Chain1 : public ChainObject {
+   public:
+    CHAIN_SUBCLASS(Chain1, ChainObject);
+  };
+  class Chain2 : public Chain1 {
+   public:
+    CHAIN_SUBCLASS(Chain2, Chain1);
+  };
+  class Chain3 : public Chain2 {
+   public:
+    CHAIN_SUBCLASS(Chain3, Chain2);
+  };
+  class Chain4 : public Chain3 {
+   public:
+    CHAIN_SUBCLASS(Chain4, Chain3);
+  };
+  class Chain5 : public Chain4 {
+   public:
+    CHAIN_SUBCLASS(Chain5, Chain4);
+  };
+  class ChainOther : public ChainObject {
+   public:
+    CHAIN_SUBCLASS(ChainOther, ChainObject);
+  };
+
+  // Microbenchmark of casting deep objects to a shallow base (the worst case
+  // for the chain) and to an unrelated type.
+  EL_TEST(is_of_type_benchmark) {
+    const int kIterations = 2000000;
+    Chain5 chain5;
+    Chain1 chain1;
+    ChainOther other;
+    ChainObject* objects[] = {&chain5, &chain1, &other, &chain5};
+    const void* chain_type = GetChainTypeId<Chain1>();
+
+    int chain_count = 0;
+    uint64_t start = util::GetTimeMS();
+    for (int i = 0; i < kIterations; ++i) {
+      chain_count += objects[i & 3]->IsOfChainTypeId(chain_type) ? 1 : 0;
+    }
+    uint64_t chain_time = util::GetTimeMS() - start;
+
+    int range_count = 0;
+    start = util::GetTimeMS();
+    for (int i = 0; i < kIterations; ++i) {
+      range_count += objects[i & 3]->IsOfType<Chain1>() ? 1 : 0;
+    }
+    uint64_t range_time = util::GetTimeMS() - start;
+
+    EL_VERIFY(chain_count == kIterations / 4 * 3);
+    EL_VERIFY(range_count == chain_count);
+    TBDebugOut("IsOfType x%d: virtual chain %dms, type range %dms\n",
+               kIterations, int(chain_time), int(range_time));
+  }
+#undef CHAIN_SUBCLASS
 }
 
 #endif  // EL_UNIT_TESTING
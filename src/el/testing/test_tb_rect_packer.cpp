@@ -0,0 +1,69 @@
+/**
+ ******************************************************************************
+ * Elemental Forms : a lightweight user interface framework                   *
+ ******************************************************************************
+ * Copyright 2015 Ben Vanik. All rights reserved. Licensed as BSD 3-clause.   *
+ * Portions ©2011-2015 Emil Segerås: https://github.com/fruxo/turbobadger     *
+ ******************************************************************************
+ */
+
+#include "el/testing/testing.h"
+#include "el/util/rect_packer.h"
+
+#ifdef EL_UNIT_TESTING
+
+using namespace el;
+using el::util::MaxRectsPacker;
+
+EL_TEST_GROUP(tb_rect_packer) {
+  EL_TEST(fill_exactly) {
+    MaxRectsPacker packer(32, 32);
+    Rect r1, r2, r3, r4;
+    EL_VERIFY(packer.Insert(16, 16, &r1));
+    EL_VERIFY(packer.Insert(16, 16, &r2));
+    EL_VERIFY(packer.Insert(16, 16, &r3));
+    EL_VERIFY(packer.Insert(16, 16, &r4));
+    EL_VERIFY(!packer.HasSpace(1, 1));
+    EL_VERIFY(!r1.intersects(r2) && !r1.intersects(r3) && !r1.intersects(r4));
+    EL_VERIFY(!r2.intersects(r3) && !r2.intersects(r4));
+    EL_VERIFY(!r3.intersects(r4));
+  }
+  EL_TEST(mixed_heights) {
+    // Rows would waste the space below the short rects; MaxRects fills it.
+    MaxRectsPacker packer(32, 32);
+    Rect tall, short1, short2, short3;
+    EL_VERIFY(packer.Insert(16, 32, &tall));
+    EL_VERIFY(packer.Insert(16, 10, &short1));
+    EL_VERIFY(packer.Insert(16, 10, &short2));
+    EL_VERIFY(packer.Insert(16, 12, &short3));
+    EL_VERIFY(!packer.HasSpace(1, 1));
+  }
+  EL_TEST(free) {
+    MaxRectsPacker packer(32, 32);
+    Rect r1, r2;
+    EL_VERIFY(packer.Insert(32, 16, &r1));
+    EL_VERIFY(packer.Insert(32, 16, &r2));
+    EL_VERIFY(!packer.HasSpace(32, 16));
+
+    // Free one and reuse its space.
+    packer.Free(r1);
+    EL_VERIFY(packer.HasSpace(32, 16));
+    EL_VERIFY(!packer.HasSpace(32, 17));
+    EL_VERIFY(packer.Insert(32, 16, &r1));
+
+    // Free all; the whole area is available again.
+    packer.Free(r1);
+    packer.Free(r2);
+    EL_VERIFY(packer.empty());
+    EL_VERIFY(packer.HasSpace(32, 32));
+  }
+  EL_TEST(too_large) {
+    MaxRectsPacker packer(32, 32);
+    Rect r;
+    EL_VERIFY(!packer.Insert(33, 1, &r));
+    EL_VERIFY(!packer.Insert(1, 33, &r));
+    EL_VERIFY(packer.empty());
+  }
+}
+
+#endif  // EL_UNIT_TESTING
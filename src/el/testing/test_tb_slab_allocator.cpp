@@ -0,0 +1,72 @@
+/**
+ ******************************************************************************
+ * Elemental Forms : a lightweight user interface framework                   *
+ ******************************************************************************
+ * Copyright 2015 Ben Vanik. All rights reserved. Licensed as BSD 3-clause.   *
+ * Portions ©2011-2015 Emil Segerås: https://github.com/fruxo/turbobadger     *
+ ******************************************************************************
+ */
+
+#include <cstdint>
+#include <vector>
+
+#include "el/testing/testing.h"
+#include "el/util/slab_allocator.h"
+
+#ifdef EL_UNIT_TESTING
+
+using namespace el;
+using namespace el::util;
+
+EL_TEST_GROUP(tb_slab_allocator) {
+  EL_TEST(reuse_and_alignment) {
+    SlabAllocator allocator(256);
+    void* a = allocator.Allocate(40);
+    void* b = allocator.Allocate(48);
+    EL_VERIFY(a && b && a != b);
+    EL_VERIFY(reinterpret_cast<uintptr_t>(a) % 16 == 0);
+    EL_VERIFY(reinterpret_cast<uintptr_t>(b) % 16 == 0);
+    EL_VERIFY(allocator.stats().live_blocks == 2);
+    EL_VERIFY(allocator.stats().chunk_count == 1);
+    allocator.Free(a, 40);
+    // The freed block is reused by the next allocation of the same class.
+    EL_VERIFY(allocator.Allocate(33) == a);
+    allocator.Free(a, 33);
+    allocator.Free(b, 48);
+    EL_VERIFY(allocator.stats().live_blocks == 0);
+  }
+  EL_TEST(oversize) {
+    SlabAllocator allocator(64);
+    void* ptr = allocator.Allocate(65);
+    EL_VERIFY(ptr);
+    EL_VERIFY(allocator.stats().oversize_allocations == 1);
+    EL_VERIFY(allocator.stats().chunk_count == 0);
+    allocator.Free(ptr, 65);
+  }
+  EL_TEST(trim_releases_empty_chunks) {
+    SlabAllocator allocator(128);
+    std::vector<void*> blocks;
+    for (int i = 0; i < 1000; ++i) {
+      blocks.push_back(allocator.Allocate(100));
+    }
+    size_t chunk_count = allocator.stats().chunk_count;
+    EL_VERIFY(chunk_count > 1);
+    // Keep the first block alive so its chunk survives.
+    for (size_t i = 1; i < blocks.size(); ++i) {
+      allocator.Free(blocks[i], 100);
+    }
+    allocator.Trim();
+    EL_VERIFY(allocator.stats().chunk_count == 1);
+    EL_VERIFY(allocator.stats().released_chunks == chunk_count - 1);
+    // The surviving chunk still serves allocations.
+    void* ptr = allocator.Allocate(100);
+    EL_VERIFY(allocator.stats().chunk_count == 1);
+    allocator.Free(ptr, 100);
+    allocator.Free(blocks[0], 100);
+    allocator.Trim();
+    EL_VERIFY(allocator.stats().chunk_count == 0);
+    EL_VERIFY(allocator.stats().chunk_bytes == 0);
+  }
+}
+
+#endif  // EL_UNIT_TESTING
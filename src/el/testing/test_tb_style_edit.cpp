@@ -7,6 +7,7 @@
  ******************************************************************************
  */
 
+#include "el/element_listener.h"
 #include "el/elements/text_box.h"
 #include "el/testing/testing.h"
 
@@ -16,6 +17,82 @@ using namespace el;
 using namespace el::elements;
 using namespace el::text;
 
+namespace {
+
+// Styles text between { and } (which may span multiple blocks).
+class BraceStyler : public TextStyler {
+ public:
+  uint32_t StyleBlock(const char* text, size_t len, uint32_t start_state,
+                      std::vector<TextStyleRun>* out_runs) override {
+    ++style_count;
+    uint32_t state = start_state;
+    size_t run_start = 0;
+    for (size_t i = 0; i < len; ++i) {
+      if (text[i] == '{' && !state) {
+        state = 1;
+        run_start = i;
+      } else if (text[i] == '}' && state) {
+        state = 0;
+        out_runs->push_back({run_start, i + 1 - run_start, Color(255, 0, 0)});
+      }
+    }
+    if (state) {
+      out_runs->push_back({run_start, len - run_start, Color(255, 0, 0)});
+    }
+    return state;
+  }
+
+  int style_count = 0;
+};
+
+// Records the text changes of all EventType::kChanged.
+class ChangeRecorder : public ElementListener {
+ public:
+  bool OnElementInvokeEvent(Element* element, const Event& ev) override {
+    if (ev.type == EventType::kChanged && ev.text_change) {
+      changes.push_back(*ev.text_change);
+    }
+    return false;
+  }
+
+  std::vector<TextChange> changes;
+};
+
+// Gets the layout of all blocks and fragments.
+std::vector<int> GetLayout(TextView* view) {
+  std::vector<int> layout;
+  for (TextBlock* block = view->blocks.GetFirst(); block;
+       block = block->GetNext()) {
+    layout.push_back(block->ypos);
+    layout.push_back(block->height);
+    layout.push_back(block->line_width_max);
+    for (TextFragment* fragment = block->fragments.GetFirst(); fragment;
+         fragment = fragment->GetNext()) {
+      layout.push_back(fragment->xpos);
+      layout.push_back(fragment->ypos);
+      layout.push_back(fragment->line_height);
+    }
+  }
+  return layout;
+}
+
+// Paragraphs of varying length, some with tabs and indentation.
+std::string MakeParagraphs(int count) {
+  std::string text;
+  for (int i = 0; i < count; ++i) {
+    if (i % 7 == 0) {
+      text += "\t- ";
+    }
+    for (int word = 0; word < i % 23; ++word) {
+      text += word % 5 ? "lorem " : "ipsum, dolor ";
+    }
+    text += "end.\n";
+  }
+  return text;
+}
+
+}  // namespace
+
 EL_TEST_GROUP(tb_text_box) {
   TextBox* edit;
   TextView* sedit;
@@ -254,6 +331,190 @@ EL_TEST_GROUP(tb_text_box) {
         CaretPosition::kEnd);
     EL_VERIFY(sedit->GetContentHeight() == font_size * 2);
   }
+
+  EL_TEST(style_runs_incremental) {
+    BraceStyler styler;
+    sedit->set_styler(&styler);
+    edit->set_text("a\n{b\nc\nd}\ne", CaretPosition::kEnd);
+    sedit->UpdateStyles();
+    EL_VERIFY(styler.style_count == 5);
+    TextBlock* first_block = sedit->blocks.GetFirst();
+    TextBlock* brace_block = first_block->GetNext();
+    TextBlock* block = brace_block->GetNext();
+    EL_VERIFY(block->style_start_state == 1 && block->style_end_state == 1);
+    EL_VERIFY(block->style_runs.size() == 1);
+    EL_VERIFY(block->FindStyleRun(0));
+    EL_VERIFY(!first_block->FindStyleRun(0));
+
+    // Nothing changed, nothing to style.
+    sedit->UpdateStyles();
+    EL_VERIFY(styler.style_count == 5);
+
+    // Editing a block only styles that block if its end state is unchanged.
+    styler.style_count = 0;
+    block->InsertText(0, "x", 1, false);
+    sedit->UpdateStyles();
+    EL_VERIFY(styler.style_count == 1);
+
+    // Removing the opening brace styles the following blocks until one ends
+    // in the same state as before.
+    styler.style_count = 0;
+    brace_block->RemoveContent(0, 1);
+    EL_VERIFY_STR(edit->text(), "a\nb\nxc\nd}\ne");
+    sedit->UpdateStyles();
+    EL_VERIFY(styler.style_count == 3);
+    EL_VERIFY(block->style_runs.empty());
+
+    // Styling can stop at a given block, f.ex the last visible one.
+    styler.style_count = 0;
+    sedit->set_styler(&styler);
+    sedit->UpdateStyles(first_block);
+    EL_VERIFY(styler.style_count == 1);
+    EL_VERIFY(sedit->styles_dirty);
+    sedit->UpdateStyles();
+    EL_VERIFY(styler.style_count == 5);
+    EL_VERIFY(!sedit->styles_dirty);
+
+    sedit->set_styler(nullptr);
+  }
+
+  EL_TEST(style_runs_resume) {
+    BraceStyler styler;
+    edit->set_text("a\nb\nc\nd\ne\nf", CaretPosition::kEnd);
+    sedit->set_styler(&styler);
+    TextBlock* first_block = sedit->blocks.GetFirst();
+    TextBlock* last_visible = first_block->GetNext()->GetNext();
+    sedit->UpdateStyles(last_visible);
+    EL_VERIFY(styler.style_count == 3);
+    EL_VERIFY(sedit->first_style_dirty_block == last_visible->GetNext());
+
+    // Painting again doesn't walk or style anything.
+    sedit->UpdateStyles(last_visible);
+    EL_VERIFY(styler.style_count == 3);
+
+    // Edits below the last visible block are left for later, edits above it
+    // only style from the edited block.
+    last_visible->GetNext()->InsertText(0, "x", 1, false);
+    first_block->GetNext()->InsertText(0, "x", 1, false);
+    EL_VERIFY(sedit->first_style_dirty_block == first_block->GetNext());
+    styler.style_count = 0;
+    sedit->UpdateStyles(last_visible);
+    EL_VERIFY(styler.style_count == 1);
+
+    sedit->UpdateStyles();
+    EL_VERIFY(styler.style_count == 4);
+    EL_VERIFY(!sedit->styles_dirty);
+
+    sedit->set_styler(nullptr);
+  }
+
+  EL_TEST(wrap_layout_cache) {
+    sedit->set_wrapping(true);
+    edit->set_text(MakeParagraphs(50));
+    for (int width : {900, 300, 301, 120, 800, 40, 1000}) {
+      sedit->SetLayoutSize(width, 1000, false);
+      std::vector<int> cached = GetLayout(sedit);
+      // Laying out from scratch should give the same result.
+      sedit->Reformat(true);
+      EL_VERIFY(GetLayout(sedit) == cached);
+    }
+    sedit->set_alignment(TextAlign::kCenter);
+    sedit->SetLayoutSize(500, 1000, false);
+    std::vector<int> cached = GetLayout(sedit);
+    sedit->Reformat(true);
+    EL_VERIFY(GetLayout(sedit) == cached);
+
+    // The last line can't be broken after the quote, so its line width ends
+    // before "bar". Narrowing below the full width must still wrap it.
+    sedit->set_alignment(TextAlign::kLeft);
+    edit->set_text(MakeParagraphs(10) + "foo \"bar\"");
+    for (int width = 300; width > 0; --width) {
+      sedit->SetLayoutSize(width, 1000, false);
+      std::vector<int> cached = GetLayout(sedit);
+      sedit->Reformat(true);
+      EL_VERIFY(GetLayout(sedit) == cached);
+    }
+  }
+
+  EL_TEST(log_append) {
+    sedit->set_log_mode(true);
+    EL_VERIFY(edit->is_read_only());
+    sedit->AppendLog("one\ntw");
+    sedit->AppendLog("o\nthree\n");
+    // Nothing is laid out until flushed.
+    EL_VERIFY(sedit->blocks.CountLinks() == 1);
+    EL_VERIFY(sedit->FlushLog());
+    EL_VERIFY(!sedit->FlushLog());
+    EL_VERIFY(sedit->blocks.CountLinks() == 3);
+    EL_VERIFY_STR(edit->text(), "one\ntwo\nthree\n");
+    EL_VERIFY(!sedit->CanUndo());
+
+    // Lines exceeding the limit are dropped from the front.
+    sedit->set_log_max_lines(3);
+    sedit->AppendLog("four\nfive");
+    EL_VERIFY_STR(edit->text(), "three\nfour\nfive");
+    // The remaining lines aren't moved, the view starts at the first one.
+    TextBlock* first = sedit->blocks.GetFirst();
+    EL_VERIFY(first->ypos > 0);
+    EL_VERIFY(sedit->ypos_origin == first->ypos);
+    EL_VERIFY(sedit->GetContentHeight() == sedit->blocks.GetLast()->ypos +
+                                               sedit->blocks.GetLast()->height -
+                                               first->ypos);
+    EL_VERIFY(sedit->FindBlock(0) == first);
+    EL_VERIFY(sedit->FindBlock(first->height) == first->GetNext());
+    sedit->caret.Place(Point(0, 0));
+    EL_VERIFY(sedit->caret.pos.block == first && sedit->caret.y == 0);
+
+    // Positions are moved back to 0 before they can overflow.
+    const int32_t kNearMaxYposOrigin = (1 << 30) - 1;
+    for (TextBlock* block = first; block; block = block->GetNext()) {
+      block->ypos += kNearMaxYposOrigin;
+    }
+    sedit->ypos_origin += kNearMaxYposOrigin;
+    sedit->AppendLog("\nsix");
+    EL_VERIFY_STR(edit->text(), "four\nfive\nsix");
+    EL_VERIFY(sedit->ypos_origin == 0);
+    EL_VERIFY(sedit->blocks.GetFirst()->ypos == 0);
+    EL_VERIFY(sedit->FindBlock(0) == sedit->blocks.GetFirst());
+
+    sedit->set_log_mode(false);
+    sedit->set_read_only(false);
+    edit->set_text("");
+    EL_VERIFY(sedit->ypos_origin == 0);
+
+    // Appending is the same as AppendText outside log mode.
+    sedit->AppendLog("six");
+    EL_VERIFY_STR(edit->text(), "six");
+    EL_VERIFY(sedit->CanUndo());
+  }
+
+  EL_TEST(log_change_ranges) {
+    sedit->set_log_mode(true);
+    sedit->set_log_max_lines(100);
+    for (int i = 0; i < 150; ++i) {
+      sedit->AppendLog("line\n");
+    }
+    EL_VERIFY(sedit->FlushLog());
+    EL_VERIFY(sedit->text_length() == 500);
+
+    // The append and the dropped lines are separate changes, so neither
+    // covers the lines kept.
+    ChangeRecorder recorder;
+    ElementListener::AddGlobalListener(&recorder);
+    sedit->AppendLog("one\ntwo\n");
+    EL_VERIFY(sedit->FlushLog());
+    ElementListener::RemoveGlobalListener(&recorder);
+    EL_VERIFY(recorder.changes.size() == 2);
+    EL_VERIFY(recorder.changes[0].offset == 500);
+    EL_VERIFY(recorder.changes[0].removed_length == 0);
+    EL_VERIFY_STR(recorder.changes[0].inserted_text, "one\ntwo\n");
+    EL_VERIFY(recorder.changes[1].offset == 0);
+    EL_VERIFY(recorder.changes[1].removed_length == 10);
+    EL_VERIFY(sedit->last_change().inserted_length == 0);
+    EL_VERIFY(sedit->text_length() == 498);
+
+    sedit->set_log_mode(false);
+  }
 }
 
 #endif  // EL_UNIT_TESTING
@@ -0,0 +1,115 @@
+/**
+ ******************************************************************************
+ * Elemental Forms : a lightweight user interface framework                   *
+ ******************************************************************************
+ * Copyright 2015 Ben Vanik. All rights reserved. Licensed as BSD 3-clause.   *
+ * Portions ©2011-2015 Emil Segerås: https://github.com/fruxo/turbobadger     *
+ ******************************************************************************
+ */
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "el/testing/testing.h"
+#include "el/text/utf8.h"
+
+#ifdef EL_UNIT_TESTING
+
+using namespace el;
+using namespace el::text;
+
+namespace {
+
+// Decodes one character at a time, like the callers did before decode_chunk.
+std::vector<utf8::UCS4> ReferenceDecode(const char* str, size_t len) {
+  std::vector<utf8::UCS4> chars;
+  size_t i = 0;
+  while (str[i] && i < len) {
+    chars.push_back(utf8::decode_next(str, &i, len));
+  }
+  return chars;
+}
+
+std::vector<utf8::UCS4> ChunkDecode(const char* str, size_t len) {
+  std::vector<utf8::UCS4> chars;
+  utf8::ChunkDecoder decoder(str, len);
+  utf8::UCS4 cp;
+  while (decoder.Next(&cp)) {
+    chars.push_back(cp);
+  }
+  return chars;
+}
+
+// ASCII text mixed with multibyte characters, and invalid bytes if requested.
+std::string MakeText(size_t len, uint32_t seed, bool with_invalid) {
+  std::string text;
+  char buf[8];
+  while (text.size() < len) {
+    seed = seed * 1103515245 + 12345;
+    uint32_t r = (seed >> 8) % 100;
+    if (r < 80) {
+      text += char('a' + r % 26);
+    } else if (r < 88) {
+      text.append(buf, utf8::encode(0xE5, buf));
+    } else if (r < 94) {
+      text.append(buf, utf8::encode(0x2022, buf));
+    } else if (r < 97) {
+      text.append(buf, utf8::encode(0x1F600, buf));
+    } else if (with_invalid) {
+      text += r % 2 ? '\x80' : '\xC3';
+    }
+  }
+  return text;
+}
+
+}  // namespace
+
+EL_TEST_GROUP(tb_utf8) {
+  EL_TEST(ascii_run_length) {
+    EL_VERIFY(utf8::ascii_run_length("hello", 5) == 5);
+    EL_VERIFY(utf8::ascii_run_length("hello", 3) == 3);
+    EL_VERIFY(utf8::ascii_run_length("hel\xC3\xA5", 5) == 3);
+    EL_VERIFY(utf8::ascii_run_length("ab\0cd", 5) == 2);
+    EL_VERIFY(utf8::ascii_run_length("hello", std::string::npos) == 5);
+    // Long enough to check many bytes at a time.
+    for (size_t stop = 0; stop < 70; ++stop) {
+      std::string text(100, 'a');
+      text[stop] = '\xE2';
+      EL_VERIFY(utf8::ascii_run_length(text.c_str(), text.size()) == stop);
+      text[stop] = '\0';
+      EL_VERIFY(utf8::ascii_run_length(text.c_str(), text.size()) == stop);
+    }
+  }
+  EL_TEST(decode_chunk_matches_decode_next) {
+    for (uint32_t seed = 1; seed < 40; ++seed) {
+      std::string text = MakeText(seed * 13, seed, seed % 2 == 0);
+      EL_VERIFY(ChunkDecode(text.c_str(), text.size()) ==
+                ReferenceDecode(text.c_str(), text.size()));
+      EL_VERIFY(utf8::count_characters(text.c_str(), text.size()) ==
+                ReferenceDecode(text.c_str(), text.size()).size());
+      // Stopping in the middle of a character or at a null byte.
+      size_t len = text.size() / 2;
+      EL_VERIFY(ChunkDecode(text.c_str(), len) ==
+                ReferenceDecode(text.c_str(), len));
+      text[len] = '\0';
+      EL_VERIFY(ChunkDecode(text.c_str(), text.size()) ==
+                ReferenceDecode(text.c_str(), text.size()));
+      EL_VERIFY(ChunkDecode(text.c_str(), std::string::npos) ==
+                ReferenceDecode(text.c_str(), text.size()));
+    }
+  }
+  EL_TEST(validate) {
+    std::string text = MakeText(500, 7, false);
+    EL_VERIFY(utf8::validate(text.c_str(), text.size()));
+    EL_VERIFY(utf8::validate("", 0));
+    EL_VERIFY(utf8::validate("a\0b", 3));
+    // U+FFFF is valid even though decode_next uses it for errors.
+    EL_VERIFY(utf8::validate("\xEF\xBF\xBF", 3));
+    EL_VERIFY(!utf8::validate("a\x80", 2));
+    EL_VERIFY(!utf8::validate("\xC3", 1));
+    EL_VERIFY(!utf8::validate("\xC3\xA5\xC3", 3));
+  }
+}
+
+#endif  // EL_UNIT_TESTING
@@ -0,0 +1,52 @@
+/**
+ ******************************************************************************
+ * Elemental Forms : a lightweight user interface framework                   *
+ ******************************************************************************
+ * Copyright 2015 Ben Vanik. All rights reserved. Licensed as BSD 3-clause.   *
+ * Portions ©2011-2015 Emil Segerås: https://github.com/fruxo/turbobadger     *
+ ******************************************************************************
+ */
+
+#include "el/element.h"
+#include "el/element_listener.h"
+#include "el/testing/testing.h"
+
+#ifdef EL_UNIT_TESTING
+
+using namespace el;
+
+EL_TEST_GROUP(tb_weak_element_pointer) {
+  EL_TEST(reset_on_delete) {
+    Element* element = new Element();
+    WeakElementPointer a(element);
+    WeakElementPointer b = a;
+    EL_VERIFY(a.get() == element && b.get() == element);
+    delete element;
+    EL_VERIFY(!a.get() && !b.get());
+    EL_VERIFY(!a && !b);
+  }
+  EL_TEST(children) {
+    Element* parent = new Element();
+    Element* child = new Element();
+    parent->AddChild(child);
+    WeakElementPointer child_pointer(child);
+    delete parent;
+    EL_VERIFY(!child_pointer.get());
+  }
+  EL_TEST(slot_reuse) {
+    // A new element reusing the slot of a deleted one must not be returned by
+    // pointers to the deleted one.
+    Element* first = new Element();
+    WeakElementPointer first_pointer(first);
+    delete first;
+    Element* second = new Element();
+    WeakElementPointer second_pointer(second);
+    EL_VERIFY(!first_pointer.get());
+    EL_VERIFY(second_pointer.get() == second);
+    second_pointer.reset();
+    EL_VERIFY(!second_pointer.get());
+    delete second;
+  }
+}
+
+#endif  // EL_UNIT_TESTING
@@ -7,6 +7,7 @@
  ******************************************************************************
  */
 
+#include "el/element_listener.h"
 #include "el/element_value.h"
 #include "el/elements/check_box.h"
 #include "el/elements/slider.h"
@@ -18,6 +19,19 @@
 
 using namespace el;
 using namespace el::elements;
+using namespace el::text;
+
+namespace {
+
+// Consumes all EventType::kChanged, so connected values aren't synced.
+class ChangeBlocker : public ElementListener {
+ public:
+  bool OnElementInvokeEvent(Element* element, const Event& ev) override {
+    return ev.type == EventType::kChanged;
+  }
+};
+
+}  // namespace
 
 EL_TEST_GROUP(tb_widget_value_text) {
   ElementValue element_val(TBIDC("test value text"));
@@ -70,6 +84,66 @@ EL_TEST_GROUP(tb_widget_value_text) {
     EL_VERIFY_STR(element_val.text(), "C");
   }
 
+  EL_TEST(change_element_range) {
+    // Edits in a text box patch only the changed range of the value.
+    static_cast<TextBox*>(a)->set_multiline(true);
+    static_cast<TextBox*>(b)->set_multiline(true);
+    static_cast<TextBox*>(c)->set_multiline(true);
+    TextView* view = static_cast<TextBox*>(a)->text_view();
+    a->set_text("hello\nworld");
+    EL_VERIFY(view->last_change().replaced_all);
+
+    // Edits without a change notification are merged into the next one.
+    view->caret.Place(view->blocks.GetFirst(), 2);
+    view->InsertText("X");
+    EL_VERIFY_STR(element_val.text(), "hello\nworld");
+
+    view->selection.start.Set(view->blocks.GetFirst(), 1);
+    view->selection.stop.Set(view->blocks.GetLast(), 2);
+    view->Delete();
+    const TextChangeRange& change = view->last_change();
+    EL_VERIFY(!change.replaced_all);
+    EL_VERIFY(change.offset == 1);
+    EL_VERIFY(change.removed_length == 7);
+    EL_VERIFY(change.inserted_length == 0);
+    EL_VERIFY_STR(element_val.text(), "hrld");
+    EL_VERIFY_STR(b->text(), "hrld");
+    EL_VERIFY_STR(c->text(), "hrld");
+
+    // After a missed change the next one can't be applied to the value.
+    ChangeBlocker blocker;
+    ElementListener::AddGlobalListener(&blocker);
+    view->selection.start.Set(view->blocks.GetFirst(), 0);
+    view->selection.stop.Set(view->blocks.GetFirst(), 1);
+    view->Delete();
+    ElementListener::RemoveGlobalListener(&blocker);
+    EL_VERIFY_STR(element_val.text(), "hrld");
+
+    view->selection.start.Set(view->blocks.GetFirst(), 0);
+    view->selection.stop.Set(view->blocks.GetFirst(), 1);
+    view->Delete();
+    EL_VERIFY_STR(element_val.text(), "ld");
+    EL_VERIFY_STR(b->text(), "ld");
+  }
+
+  EL_TEST(visit_text) {
+    TextView* view = static_cast<TextBox*>(a)->text_view();
+    a->set_text("one\ntwo\nthree");
+    EL_VERIFY(view->text_length() == 13);
+
+    std::string visited;
+    int span_count = 0;
+    view->VisitText([&](const char* str, size_t len) {
+      visited.append(str, len);
+      ++span_count;
+      return true;
+    });
+    EL_VERIFY_STR(visited, "one\ntwo\nthree");
+    EL_VERIFY(span_count == 3);
+    EL_VERIFY_STR(view->GetText(2, 5), "e\ntwo");
+    EL_VERIFY_STR(view->GetText(8, 100), "three");
+  }
+
   EL_TEST(Shutdown) {
     delete a;
     delete b;
@@ -18,18 +18,33 @@
 // Reference at least one group in each test file, to force
 // linking the object file. This is needed if TB is compiled
 // as an library.
+EL_FORCE_LINK_TEST_GROUP(tb_animation_manager);
+EL_FORCE_LINK_TEST_GROUP(tb_archive);
+EL_FORCE_LINK_TEST_GROUP(tb_bitmap_fragment);
 EL_FORCE_LINK_TEST_GROUP(tb_color);
 EL_FORCE_LINK_TEST_GROUP(tb_dimension_converter);
+EL_FORCE_LINK_TEST_GROUP(tb_distance_field);
+EL_FORCE_LINK_TEST_GROUP(tb_element_children);
+EL_FORCE_LINK_TEST_GROUP(tb_element_listener);
+EL_FORCE_LINK_TEST_GROUP(tb_font_manager);
+EL_FORCE_LINK_TEST_GROUP(tb_frame_scheduler);
 EL_FORCE_LINK_TEST_GROUP(tb_geometry);
+EL_FORCE_LINK_TEST_GROUP(tb_glyph_kernels);
 EL_FORCE_LINK_TEST_GROUP(tb_linklist);
+EL_FORCE_LINK_TEST_GROUP(tb_list_item_index);
+EL_FORCE_LINK_TEST_GROUP(tb_message_handler);
 EL_FORCE_LINK_TEST_GROUP(tb_node_ref_tree);
 EL_FORCE_LINK_TEST_GROUP(tb_object);
 EL_FORCE_LINK_TEST_GROUP(tb_parser);
+EL_FORCE_LINK_TEST_GROUP(tb_rect_packer);
+EL_FORCE_LINK_TEST_GROUP(tb_slab_allocator);
 EL_FORCE_LINK_TEST_GROUP(tb_space_allocator);
 EL_FORCE_LINK_TEST_GROUP(tb_text_box);
 EL_FORCE_LINK_TEST_GROUP(tb_string_builder);
 EL_FORCE_LINK_TEST_GROUP(tb_test);
+EL_FORCE_LINK_TEST_GROUP(tb_utf8);
 EL_FORCE_LINK_TEST_GROUP(tb_value);
+EL_FORCE_LINK_TEST_GROUP(tb_weak_element_pointer);
 EL_FORCE_LINK_TEST_GROUP(tb_widget_value_text);
 #endif
 
@@ -28,11 +28,11 @@ void Caret::UpdatePos() {
   TextFragment* fragment = this->fragment();
   x = fragment->xpos +
       fragment->GetCharX(style_edit->font, pos.ofs - fragment->ofs);
-  y = fragment->ypos + pos.block->ypos;
+  y = fragment->ypos + pos.block->ypos - style_edit->ypos_origin;
   height = fragment->GetHeight(style_edit->font);
   if (!height) {
     // If we don't have height, we're probably inside a style switch embed.
-    y = fragment->line_ypos + pos.block->ypos;
+    y = fragment->line_ypos + pos.block->ypos - style_edit->ypos_origin;
     height = fragment->line_height;
   }
   Invalidate();
@@ -89,7 +89,8 @@ bool Caret::Move(bool forward, bool word) {
 
 bool Caret::Place(const Point& point) {
   TextBlock* block = style_edit->FindBlock(point.y);
-  TextFragment* fragment = block->FindFragment(point.x, point.y - block->ypos);
+  TextFragment* fragment = block->FindFragment(
+      point.x, point.y + style_edit->ypos_origin - block->ypos);
   size_t ofs = fragment->ofs +
                fragment->GetCharOfs(style_edit->font, point.x - fragment->xpos);
 
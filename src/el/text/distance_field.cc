@@ -0,0 +1,99 @@
+/**
+ ******************************************************************************
+ * Elemental Forms : a lightweight user interface framework                   *
+ ******************************************************************************
+ * Copyright 2015 Ben Vanik. All rights reserved. Licensed as BSD 3-clause.   *
+ * Portions ©2011-2015 Emil Segerås: https://github.com/fruxo/turbobadger     *
+ ******************************************************************************
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "el/text/distance_field.h"
+
+namespace el {
+namespace text {
+
+namespace {
+
+// Coverage at x, y or 0 outside the bitmap.
+inline int CoverageAt(const uint8_t* coverage, int w, int h, int stride, int x,
+                      int y) {
+  if (x < 0 || y < 0 || x >= w || y >= h) {
+    return 0;
+  }
+  return coverage[x + y * stride];
+}
+
+}  // namespace
+
+void GenerateDistanceField(const uint8_t* coverage, int w, int h, int stride,
+                           int spread, uint8_t* out) {
+  const int out_w = w + spread * 2;
+  const int out_h = h + spread * 2;
+  const int radius = spread + 1;
+  const float value_scale = 127.0f / spread;
+  for (int y = 0; y < out_h; ++y) {
+    for (int x = 0; x < out_w; ++x) {
+      const int sx = x - spread;
+      const int sy = y - spread;
+      const int a = CoverageAt(coverage, w, h, stride, sx, sy);
+      float distance;
+      if (a > 0 && a < 255) {
+        // Anti-aliased pixels are within half a pixel of the outline.
+        distance = a / 255.0f - 0.5f;
+      } else {
+        // Find the closest pixel that isn't entirely on the same side of the
+        // outline as this one. Its coverage tells how far past its center the
+        // outline is.
+        const bool inside = a == 255;
+        float closest = float(spread);
+        for (int j = -radius; j <= radius; ++j) {
+          for (int i = -radius; i <= radius; ++i) {
+            const int b = CoverageAt(coverage, w, h, stride, sx + i, sy + j);
+            if (inside ? b == 255 : b == 0) {
+              continue;
+            }
+            const float offset = inside ? b / 255.0f - 0.5f : 0.5f - b / 255.0f;
+            closest =
+                std::min(closest, std::sqrt(float(i * i + j * j)) + offset);
+          }
+        }
+        distance = inside ? closest : -closest;
+      }
+      const int value = int(128.0f + distance * value_scale + 0.5f);
+      out[x + y * out_w] = uint8_t(std::max(0, std::min(255, value)));
+    }
+  }
+}
+
+void RenderDistanceField(const uint8_t* field, int w, int h, int spread,
+                         float scale, uint8_t* out, int out_w, int out_h) {
+  // Field values per destination pixel of distance.
+  const float value_to_pixels = spread / 127.0f * scale;
+  const float inv_scale = 1.0f / scale;
+  for (int y = 0; y < out_h; ++y) {
+    const float fy = std::max(0.0f, (y + 0.5f) * inv_scale - 0.5f);
+    const int y0 = std::min(int(fy), h - 1);
+    const int y1 = std::min(y0 + 1, h - 1);
+    const float ty = fy - y0;
+    for (int x = 0; x < out_w; ++x) {
+      const float fx = std::max(0.0f, (x + 0.5f) * inv_scale - 0.5f);
+      const int x0 = std::min(int(fx), w - 1);
+      const int x1 = std::min(x0 + 1, w - 1);
+      const float tx = fx - x0;
+      const float top =
+          field[x0 + y0 * w] * (1.0f - tx) + field[x1 + y0 * w] * tx;
+      const float bottom =
+          field[x0 + y1 * w] * (1.0f - tx) + field[x1 + y1 * w] * tx;
+      const float value = top * (1.0f - ty) + bottom * ty;
+      const float distance = (value - 128.0f) * value_to_pixels;
+      const float alpha = std::max(0.0f, std::min(1.0f, distance + 0.5f));
+      out[x + y * out_w] = uint8_t(alpha * 255.0f + 0.5f);
+    }
+  }
+}
+
+}  // namespace text
+}  // namespace el
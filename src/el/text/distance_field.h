@@ -0,0 +1,38 @@
+/**
+ ******************************************************************************
+ * Elemental Forms : a lightweight user interface framework                   *
+ ******************************************************************************
+ * Copyright 2015 Ben Vanik. All rights reserved. Licensed as BSD 3-clause.   *
+ * Portions ©2011-2015 Emil Segerås: https://github.com/fruxo/turbobadger     *
+ ******************************************************************************
+ */
+
+#ifndef EL_TEXT_DISTANCE_FIELD_H_
+#define EL_TEXT_DISTANCE_FIELD_H_
+
+#include <cstdint>
+
+namespace el {
+namespace text {
+
+// Generates a signed distance field from an 8-bit coverage bitmap of w*h
+// pixels. The field is written to out, which must hold
+// (w + 2 * spread) * (h + 2 * spread) bytes, with the source centered in it so
+// that the field can extend spread pixels outside the outline.
+// The outline maps to 128, pixels inside it are larger and pixels outside it
+// are smaller, changing 127 / spread per pixel of distance.
+void GenerateDistanceField(const uint8_t* coverage, int w, int h, int stride,
+                           int spread, uint8_t* out);
+
+// Renders coverage from a distance field of w*h pixels (as generated by
+// GenerateDistanceField with the same spread) scaled by scale. The result is
+// written to out, which must hold out_w * out_h bytes.
+// This is the CPU equivalent of the thresholding done by renderers that
+// support drawing distance fields (see Renderer::supports_distance_field).
+void RenderDistanceField(const uint8_t* field, int w, int h, int spread,
+                         float scale, uint8_t* out, int out_w, int out_h);
+
+}  // namespace text
+}  // namespace el
+
+#endif  // EL_TEXT_DISTANCE_FIELD_H_
@@ -11,39 +11,11 @@
 
 #include "el/text/font_effect.h"
 #include "el/text/font_face.h"
+#include "el/text/glyph_kernels.h"
 
 namespace el {
 namespace text {
 
-void BlurGlyph(unsigned char* src, int srcw, int srch, int srcStride,
-               unsigned char* dst, int dstw, int dsth, int dstStride,
-               float* temp, float* kernel, int kernelRadius) {
-  for (int y = 0; y < srch; y++) {
-    for (int x = 0; x < dstw; x++) {
-      float val = 0;
-      for (int k_ofs = -kernelRadius; k_ofs <= kernelRadius; k_ofs++) {
-        if (x - kernelRadius + k_ofs >= 0 && x - kernelRadius + k_ofs < srcw) {
-          val += src[y * srcStride + x - kernelRadius + k_ofs] *
-                 kernel[k_ofs + kernelRadius];
-        }
-      }
-      temp[y * dstw + x] = val;
-    }
-  }
-  for (int y = 0; y < dsth; y++) {
-    for (int x = 0; x < dstw; x++) {
-      float val = 0;
-      for (int k_ofs = -kernelRadius; k_ofs <= kernelRadius; k_ofs++) {
-        if (y - kernelRadius + k_ofs >= 0 && y - kernelRadius + k_ofs < srch) {
-          val += temp[(y - kernelRadius + k_ofs) * dstw + x] *
-                 kernel[k_ofs + kernelRadius];
-        }
-      }
-      dst[y * dstStride + x] = (unsigned char)(val + 0.5f);
-    }
-  }
-}
-
 FontEffect::FontEffect() = default;
 
 FontEffect::~FontEffect() {
@@ -88,16 +60,18 @@ FontGlyphData* FontEffect::Render(GlyphMetrics* metrics,
     effect_glyph_data->w = src->w + m_blur_radius * 2;
     effect_glyph_data->h = src->h + m_blur_radius * 2;
     effect_glyph_data->stride = effect_glyph_data->w;
+    // The result is owned by us and valid until the next Render.
+    m_blur_result.Reserve(effect_glyph_data->w * effect_glyph_data->h);
     effect_glyph_data->data8 =
-        new unsigned char[effect_glyph_data->w * effect_glyph_data->h];
+        reinterpret_cast<uint8_t*>(m_blur_result.data());
 
     // Reserve memory needed for blurring.
-    m_blur_temp.Reserve(effect_glyph_data->w * effect_glyph_data->h *
-                        sizeof(float));
+    m_blur_temp.Reserve(
+        GetBlurGlyphTempSize(src->w, src->h, m_blur_radius) * sizeof(float));
 
     // Blur!
     BlurGlyph(src->data8, src->w, src->h, src->stride, effect_glyph_data->data8,
-              effect_glyph_data->w, effect_glyph_data->h, effect_glyph_data->w,
+              effect_glyph_data->stride,
               reinterpret_cast<float*>(m_blur_temp.data()), m_kernel,
               m_blur_radius);
 
@@ -26,6 +26,7 @@ class FontEffect {
 
   // Sets blur radius. 0 means no blur.
   void SetBlurRadius(int blur_radius);
+  int blur_radius() const { return m_blur_radius; }
 
   // Returns true if the result is in RGB and should not be painted using the
   // color parameter given to DrawString. In other words: It's a color glyph.
@@ -38,6 +39,7 @@ class FontEffect {
   float* m_tempBuffer = nullptr;
   float* m_kernel = nullptr;
   util::StringBuilder m_blur_temp;
+  util::StringBuilder m_blur_result;
 };
 
 }  // namespace text
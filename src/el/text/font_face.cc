@@ -10,7 +10,9 @@
 #include <cmath>
 #include <cstring>
 #include <memory>
+#include <vector>
 
+#include "el/text/distance_field.h"
 #include "el/text/font_face.h"
 #include "el/text/font_manager.h"
 #include "el/text/font_renderer.h"
@@ -22,6 +24,24 @@ namespace text {
 using graphics::Renderer;
 using UCS4 = el::text::utf8::UCS4;
 
+namespace {
+
+// How far (in pixels at the reference size) distance fields extend outside
+// glyph outlines. Limits how far glyphs can be scaled down before thin parts
+// fade out and how large outlines/glows could be made.
+constexpr int kDistanceFieldSpread = 4;
+
+// Mixed into the glyph hash of distance field sources, so they don't share
+// cache entries with bitmap glyphs of the same font size.
+constexpr uint32_t kDistanceFieldHashSalt = 0x5df5df5d;
+
+// Scales a glyph offset of a distance field source to the drawn size.
+int ScaleDistanceFieldOffset(int offset, float scale) {
+  return int(std::floor((offset - kDistanceFieldSpread) * scale + 0.5f));
+}
+
+}  // namespace
+
 FontGlyph::FontGlyph(const TBID& hash_id, UCS4 cp) : hash_id(hash_id), cp(cp) {}
 
 FontFace::FontFace(FontGlyphCache* glyph_cache,
@@ -48,6 +68,17 @@ FontFace::~FontFace() {
   m_font_renderer.reset();
 }
 
+bool FontFace::is_scalable() const {
+  return m_font_renderer && m_font_renderer->is_scalable();
+}
+
+void FontFace::set_distance_field_source(FontFace* source) {
+  assert(source->m_is_distance_field_source);
+  m_distance_field_source = source;
+  m_distance_field_scale =
+      float(m_font_desc.size()) / float(source->m_font_desc.size());
+}
+
 void FontFace::SetBackgroundFont(FontFace* font, const Color& col, int xofs,
                                  int yofs) {
   m_bgFont = font;
@@ -67,9 +98,9 @@ bool FontFace::RenderGlyphs(const char* glyph_str, size_t glyph_str_len) {
   }
 
   bool has_all_glyphs = true;
-  size_t i = 0;
-  while (glyph_str[i] && i < glyph_str_len) {
-    UCS4 cp = utf8::decode_next(glyph_str, &i, glyph_str_len);
+  utf8::ChunkDecoder decoder(glyph_str, glyph_str_len);
+  UCS4 cp;
+  while (decoder.Next(&cp)) {
     if (!GetGlyph(cp, true)) {
       has_all_glyphs = false;
     }
@@ -91,6 +122,14 @@ FontGlyph* FontFace::CreateAndCacheGlyph(UCS4 cp) {
 
 void FontFace::RenderGlyph(FontGlyph* glyph) {
   assert(!glyph->frag);
+  if (m_is_distance_field_source) {
+    RenderDistanceFieldGlyph(glyph);
+    return;
+  }
+  if (uses_distance_field()) {
+    RenderGlyphFromDistanceField(glyph);
+    return;
+  }
   FontGlyphData glyph_data;
   if (m_font_renderer->RenderGlyph(&glyph_data, glyph->cp)) {
     FontGlyphData* effect_glyph_data =
@@ -98,28 +137,20 @@ void FontFace::RenderGlyph(FontGlyph* glyph) {
     FontGlyphData* result_glyph_data =
         effect_glyph_data ? effect_glyph_data : &glyph_data;
 
-    // The glyph data may be in uint8_t format, which we have to convert since
-    // we always create fragments (and Bitmap) in 32bit format.
-    uint32_t* glyph_dsta_src = result_glyph_data->data32;
-    if (!glyph_dsta_src && result_glyph_data->data8) {
-      m_temp_buffer.Reserve(result_glyph_data->w * result_glyph_data->h *
-                            sizeof(uint32_t));
-      glyph_dsta_src = reinterpret_cast<uint32_t*>(m_temp_buffer.data());
-      for (int y = 0; y < result_glyph_data->h; y++) {
-        for (int x = 0; x < result_glyph_data->w; x++) {
-          glyph_dsta_src[x + y * result_glyph_data->w] = Color(
-              255, 255, 255,
-              result_glyph_data->data8[x + y * result_glyph_data->stride]);
-        }
-      }
-    }
-
-    // Finally, the glyph data is ready and we can create a bitmap fragment.
-    if (glyph_dsta_src) {
+    // The glyph cache stores 8-bit coverage in A8 maps if it can, and
+    // converts it to 32bit otherwise.
+    if (result_glyph_data->data32) {
       glyph->has_rgb = result_glyph_data->rgb;
       m_glyph_cache->CreateFragment(glyph, result_glyph_data->w,
                                     result_glyph_data->h,
-                                    result_glyph_data->stride, glyph_dsta_src);
+                                    result_glyph_data->stride,
+                                    result_glyph_data->data32);
+    } else if (result_glyph_data->data8) {
+      glyph->has_rgb = result_glyph_data->rgb;
+      m_glyph_cache->CreateFragment(glyph, result_glyph_data->w,
+                                    result_glyph_data->h,
+                                    result_glyph_data->stride,
+                                    result_glyph_data->data8);
     }
 
     delete effect_glyph_data;
@@ -136,8 +167,55 @@ void FontFace::RenderGlyph(FontGlyph* glyph) {
 #endif  // EL_RUNTIME_DEBUG_INFO
 }
 
+void FontFace::RenderDistanceFieldGlyph(FontGlyph* glyph) {
+  FontGlyphData glyph_data;
+  if (!m_font_renderer->RenderGlyph(&glyph_data, glyph->cp) ||
+      !glyph_data.data8 || glyph_data.w <= 0 || glyph_data.h <= 0) {
+    return;
+  }
+  const int w = glyph_data.w + kDistanceFieldSpread * 2;
+  const int h = glyph_data.h + kDistanceFieldSpread * 2;
+  std::vector<uint8_t> field(w * h);
+  GenerateDistanceField(glyph_data.data8, glyph_data.w, glyph_data.h,
+                        glyph_data.stride, kDistanceFieldSpread, field.data());
+  if (Renderer::get()->supports_distance_field()) {
+    m_glyph_cache->CreateFragment(glyph, w, h, w, field.data());
+  } else {
+    // Keep the field around so faces using it can resample it to coverage.
+    glyph->distance_field = std::move(field);
+    glyph->distance_field_w = int16_t(w);
+    glyph->distance_field_h = int16_t(h);
+  }
+}
+
+void FontFace::RenderGlyphFromDistanceField(FontGlyph* glyph) {
+  FontGlyph* source = m_distance_field_source->GetGlyph(glyph->cp, true);
+  if (!source || source->distance_field.empty()) {
+    // Missing glyph, or drawn directly from the source's fragment.
+    return;
+  }
+  const float scale = m_distance_field_scale;
+  const int w = int(std::ceil(source->distance_field_w * scale));
+  const int h = int(std::ceil(source->distance_field_h * scale));
+  if (w <= 0 || h <= 0) {
+    return;
+  }
+  std::vector<uint8_t> coverage(w * h);
+  RenderDistanceField(source->distance_field.data(), source->distance_field_w,
+                      source->distance_field_h, kDistanceFieldSpread, scale,
+                      coverage.data(), w, h);
+  // Position the bitmap as the source glyph is, keeping our own advance.
+  glyph->metrics.x =
+      int16_t(ScaleDistanceFieldOffset(source->metrics.x, scale));
+  glyph->metrics.y =
+      int16_t(ScaleDistanceFieldOffset(source->metrics.y, scale));
+  m_glyph_cache->CreateFragment(glyph, w, h, w, coverage.data());
+}
+
 TBID FontFace::GetHashId(UCS4 cp) const {
-  return cp * 31 + m_font_desc.font_face_id();
+  uint32_t hash_id = cp * 31 + m_font_desc.font_face_id();
+  return m_is_distance_field_source ? hash_id ^ kDistanceFieldHashSalt
+                                    : hash_id;
 }
 
 FontGlyph* FontFace::GetGlyph(UCS4 cp, bool render_if_needed) {
@@ -145,7 +223,8 @@ FontGlyph* FontFace::GetGlyph(UCS4 cp, bool render_if_needed) {
   if (!glyph) {
     glyph = CreateAndCacheGlyph(cp);
   }
-  if (glyph && !glyph->frag && render_if_needed) {
+  if (glyph && !glyph->frag && glyph->distance_field.empty() &&
+      render_if_needed) {
     RenderGlyph(glyph);
   }
   return glyph;
@@ -161,11 +240,33 @@ void FontFace::DrawString(int x, int y, const Color& color, const char* str,
     Renderer::get()->BeginBatchHint(Renderer::BatchHint::kDrawBitmapFragment);
   }
 
-  size_t i = 0;
-  while (str[i] && i < len) {
-    UCS4 cp = utf8::decode_next(str, &i, len);
+  // Distance field glyphs are drawn from the source glyphs scaled to our size
+  // if the renderer can threshold them. Otherwise our own glyphs have already
+  // been resampled from the fields on the CPU, and are drawn as usual.
+  const bool draw_distance_field =
+      uses_distance_field() && Renderer::get()->supports_distance_field();
+
+  utf8::ChunkDecoder decoder(str, len);
+  UCS4 cp;
+  while (decoder.Next(&cp)) {
     if (cp == 0xFFFF) continue;
-    if (FontGlyph* glyph = GetGlyph(cp, true)) {
+    if (draw_distance_field) {
+      FontGlyph* source = m_distance_field_source->GetGlyph(cp, true);
+      if (source && source->frag) {
+        const float scale = m_distance_field_scale;
+        Rect dst_rect(
+            x + ScaleDistanceFieldOffset(source->metrics.x, scale),
+            y + ScaleDistanceFieldOffset(source->metrics.y, scale) + ascent(),
+            int(source->frag->width() * scale + 0.5f),
+            int(source->frag->height() * scale + 0.5f));
+        Rect src_rect(0, 0, source->frag->width(), source->frag->height());
+        Renderer::get()->DrawBitmapDistanceField(dst_rect, src_rect, color,
+                                                 source->frag);
+      }
+      if (FontGlyph* glyph = GetGlyph(cp, false)) {
+        x += glyph->metrics.advance;
+      }
+    } else if (FontGlyph* glyph = GetGlyph(cp, true)) {
       if (glyph->frag) {
         Rect dst_rect(x + glyph->metrics.x, y + glyph->metrics.y + ascent(),
                       glyph->frag->width(), glyph->frag->height());
@@ -193,9 +294,9 @@ void FontFace::DrawString(int x, int y, const Color& color, const char* str,
 
 int FontFace::GetStringWidth(const char* str, size_t len) {
   int width = 0;
-  size_t i = 0;
-  while (str[i] && i < len) {
-    UCS4 cp = utf8::decode_next(str, &i, len);
+  utf8::ChunkDecoder decoder(str, len);
+  UCS4 cp;
+  while (decoder.Next(&cp)) {
     if (cp == 0xFFFF) {
       continue;
     }
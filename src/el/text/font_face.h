@@ -12,6 +12,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "el/color.h"
 #include "el/font_description.h"
@@ -72,6 +73,11 @@ class FontGlyph : public util::IntrusiveListEntry<FontGlyph> {
   graphics::BitmapFragment* frag =
       nullptr;           // The bitmap fragment, or nullptr if missing.
   bool has_rgb = false;  // if true, drawing should ignore text color.
+  // For glyphs of a distance field source face, a CPU copy of the field when
+  // the renderer can't draw it directly. Sized glyphs are resampled from it.
+  std::vector<uint8_t> distance_field;
+  int16_t distance_field_w = 0;
+  int16_t distance_field_h = 0;
 };
 
 // Represents a loaded font that can measure and render strings.
@@ -99,6 +105,16 @@ class FontFace {
   // Gets the font description that was used to create this font.
   FontDescription font_description() const { return m_font_desc; }
 
+  // Returns true if the glyphs are rendered by an outline font that can be
+  // drawn at any size.
+  bool is_scalable() const;
+
+  // Makes this face draw its glyphs from the distance field glyphs of source,
+  // a face of the same font created at a reference size (that this face must
+  // not outlive). All faces sharing a source share its rasterized glyphs.
+  // Metrics (and thus layout) still come from this face's own size.
+  void set_distance_field_source(FontFace* source);
+
   // Gets the effect object, so the effect can be changed.
   // NOTE: No glyphs are re-rendered. Only new glyphs are affected.
   FontEffect* effect() { return &m_effect; }
@@ -128,17 +144,31 @@ class FontFace {
   void SetBackgroundFont(FontFace* font, const Color& col, int xofs, int yofs);
 
  private:
+  friend class FontManager;
+
   TBID GetHashId(utf8::UCS4 cp) const;
   FontGlyph* GetGlyph(utf8::UCS4 cp, bool render_if_needed);
   FontGlyph* CreateAndCacheGlyph(utf8::UCS4 cp);
   void RenderGlyph(FontGlyph* glyph);
+  // Renders the glyph into a distance field (for distance field sources).
+  void RenderDistanceFieldGlyph(FontGlyph* glyph);
+  // Renders the glyph by resampling the distance field of the source glyph.
+  void RenderGlyphFromDistanceField(FontGlyph* glyph);
+  // Returns true if glyphs should be drawn from the distance field source.
+  bool uses_distance_field() const {
+    return m_distance_field_source && !m_effect.blur_radius();
+  }
 
   FontGlyphCache* m_glyph_cache = nullptr;
   std::unique_ptr<FontRenderer> m_font_renderer;
   FontDescription m_font_desc;
   FontMetrics m_metrics;
   FontEffect m_effect;
-  util::StringBuilder m_temp_buffer;
+
+  // Set on faces created by FontManager to hold distance field glyphs.
+  bool m_is_distance_field_source = false;
+  FontFace* m_distance_field_source = nullptr;
+  float m_distance_field_scale = 1.0f;
 
   FontFace* m_bgFont = nullptr;
   int m_bgX = 0;
@@ -9,18 +9,30 @@
 
 #include <memory>
 
+#include "el/io/file_manager.h"
 #include "el/text/font_manager.h"
 #include "el/text/font_renderer.h"
+#include "el/text/glyph_kernels.h"
 
 namespace el {
 namespace text {
 
+using graphics::BitmapFragment;
+using graphics::BitmapFragmentManager;
+using graphics::PixelFormat;
 using graphics::Renderer;
 using UCS4 = el::text::utf8::UCS4;
 
 // The dimensions of the font glyph cache bitmap. Must be a power of two.
 constexpr int kDefaultGlyphCacheMapWidth = 512;
 constexpr int kDefaultGlyphCacheMapHeight = 512;
+// The dimensions of the A8 glyph cache bitmap, using the same memory as the
+// BGRA32 one.
+constexpr int kAlphaGlyphCacheMapWidth = 1024;
+constexpr int kAlphaGlyphCacheMapHeight = 1024;
+
+// The font size distance field glyphs are rasterized at.
+constexpr int kDistanceFieldReferenceSize = 32;
 
 std::unique_ptr<FontManager> FontManager::font_manager_singleton_;
 
@@ -31,6 +43,16 @@ FontGlyphCache::FontGlyphCache() {
   m_frag_manager.SetDefaultMapSize(kDefaultGlyphCacheMapWidth,
                                    kDefaultGlyphCacheMapHeight);
 
+  // Glyphs rendered from coverage (most glyphs, except colored bitmap fonts)
+  // only need alpha.
+  m_use_alpha_maps = Renderer::get()->supports_pixel_format(PixelFormat::kA8);
+  if (m_use_alpha_maps) {
+    m_alpha_frag_manager.set_pixel_format(PixelFormat::kA8);
+    m_alpha_frag_manager.SetNumMapsLimit(1);
+    m_alpha_frag_manager.SetDefaultMapSize(kAlphaGlyphCacheMapWidth,
+                                           kAlphaGlyphCacheMapHeight);
+  }
+
   Renderer::get()->AddListener(this);
 }
 
@@ -60,23 +82,43 @@ FontGlyph* FontGlyphCache::CreateAndCacheGlyph(const TBID& hash_id, UCS4 cp) {
   return glyph_ptr;
 }
 
-graphics::BitmapFragment* FontGlyphCache::CreateFragment(FontGlyph* glyph,
-                                                         int w, int h,
-                                                         int stride,
-                                                         uint32_t* data) {
+BitmapFragment* FontGlyphCache::CreateFragment(FontGlyph* glyph, int w, int h,
+                                              int stride,
+                                              const uint32_t* data) {
+  return CreateFragmentInManager(&m_frag_manager, glyph, w, h, stride, data);
+}
+
+BitmapFragment* FontGlyphCache::CreateFragment(FontGlyph* glyph, int w, int h,
+                                              int stride,
+                                              const uint8_t* coverage) {
+  if (m_use_alpha_maps) {
+    return CreateFragmentInManager(&m_alpha_frag_manager, glyph, w, h, stride,
+                                   coverage);
+  }
+  m_temp_buffer.Reserve(w * h * sizeof(uint32_t));
+  auto data = reinterpret_cast<uint32_t*>(m_temp_buffer.data());
+  ExpandCoverageToBGRA(coverage, w, h, stride, data);
+  return CreateFragmentInManager(&m_frag_manager, glyph, w, h, w, data);
+}
+
+BitmapFragment* FontGlyphCache::CreateFragmentInManager(
+    BitmapFragmentManager* frag_manager, FontGlyph* glyph, int w, int h,
+    int stride, const void* data) {
   assert(GetGlyph(glyph->hash_id, glyph->cp));
   // Don't bother if the requested glyph is too large.
-  if (w > m_frag_manager.default_map_width() ||
-      h > m_frag_manager.default_map_height()) {
+  if (w > frag_manager->default_map_width() ||
+      h > frag_manager->default_map_height()) {
     return nullptr;
   }
 
+  // Only glyphs in the same maps can make room for this one.
+  const PixelFormat pixel_format = frag_manager->pixel_format();
   bool try_drop_largest = true;
   bool dropped_large_enough_glyph = false;
   do {
     // Attempt creating a fragment for the rendered glyph data.
-    if (auto frag = m_frag_manager.CreateNewFragment(glyph->hash_id, false, w,
-                                                     h, stride, data)) {
+    if (auto frag = frag_manager->CreateNewFragment(glyph->hash_id, false, w,
+                                                    h, stride, data)) {
       glyph->frag = frag;
       m_all_rendered_glyphs.AddLast(glyph);
       return frag;
@@ -87,6 +129,9 @@ graphics::BitmapFragment* FontGlyphCache::CreateFragment(FontGlyph* glyph,
       int check_count = 0;
       for (FontGlyph* oldest = m_all_rendered_glyphs.GetFirst();
            oldest && check_count < check_limit; oldest = oldest->GetNext()) {
+        if (oldest->frag->pixel_format() != pixel_format) {
+          continue;
+        }
         if (oldest->frag->width() >= w &&
             oldest->frag->allocated_height() >= h) {
           DropGlyphFragment(oldest);
@@ -100,7 +145,11 @@ graphics::BitmapFragment* FontGlyphCache::CreateFragment(FontGlyph* glyph,
     // We had no large enough glyph so just drop the oldest one. We will likely
     // spin around the loop, fail and drop again a few times before we succeed.
     if (!dropped_large_enough_glyph) {
-      if (FontGlyph* oldest = m_all_rendered_glyphs.GetFirst()) {
+      FontGlyph* oldest = m_all_rendered_glyphs.GetFirst();
+      while (oldest && oldest->frag->pixel_format() != pixel_format) {
+        oldest = oldest->GetNext();
+      }
+      if (oldest) {
         DropGlyphFragment(oldest);
       } else {
         break;
@@ -110,18 +159,32 @@ graphics::BitmapFragment* FontGlyphCache::CreateFragment(FontGlyph* glyph,
   return nullptr;
 }
 
+BitmapFragmentManager* FontGlyphCache::GetFragmentManager(
+    PixelFormat pixel_format) {
+  return pixel_format == PixelFormat::kA8 ? &m_alpha_frag_manager
+                                          : &m_frag_manager;
+}
+
 void FontGlyphCache::DropGlyphFragment(FontGlyph* glyph) {
   assert(glyph->frag);
-  m_frag_manager.FreeFragment(glyph->frag);
+  GetFragmentManager(glyph->frag->pixel_format())->FreeFragment(glyph->frag);
   glyph->frag = nullptr;
   m_all_rendered_glyphs.Remove(glyph);
 }
 
 #ifdef EL_RUNTIME_DEBUG_INFO
-void FontGlyphCache::Debug() { m_frag_manager.Debug(); }
+void FontGlyphCache::Debug() {
+  m_frag_manager.Debug();
+  Renderer::get()->Translate(0, m_frag_manager.default_map_height() + 5);
+  m_alpha_frag_manager.Debug();
+  Renderer::get()->Translate(0, -(m_frag_manager.default_map_height() + 5));
+}
 #endif  // EL_RUNTIME_DEBUG_INFO
 
-void FontGlyphCache::OnContextLost() { m_frag_manager.DeleteBitmaps(); }
+void FontGlyphCache::OnContextLost() {
+  m_frag_manager.DeleteBitmaps();
+  m_alpha_frag_manager.DeleteBitmaps();
+}
 
 void FontGlyphCache::OnContextRestored() {
   // No need to do anything. The bitmaps will be created when drawing.
@@ -151,6 +214,51 @@ FontInfo* FontManager::GetFontInfo(const TBID& id) const {
   return it != m_font_info.end() ? it->second.get() : nullptr;
 }
 
+std::shared_ptr<const FontFile> FontManager::GetFontFile(
+    const std::string& filename) {
+  return GetSharedFontResource<FontFile>(
+      "file:" + filename, [&filename]() -> std::shared_ptr<FontFile> {
+        auto file = io::FileManager::OpenRead(filename);
+        if (!file) {
+          return nullptr;
+        }
+        auto font_file = std::make_shared<FontFile>();
+        font_file->m_filename = filename;
+        font_file->m_size = file->size();
+        if (file->data()) {
+          font_file->m_data = file->data();
+          font_file->m_file = std::move(file);
+        } else {
+          font_file->m_buffer.resize(font_file->m_size);
+          font_file->m_size =
+              file->Read(font_file->m_buffer.data(), font_file->m_size);
+          font_file->m_data = font_file->m_buffer.data();
+        }
+        return font_file;
+      });
+}
+
+void FontManager::EraseExpiredFontResources() {
+  for (auto it = m_shared_font_resources.begin();
+       it != m_shared_font_resources.end();) {
+    if (it->second.expired()) {
+      it = m_shared_font_resources.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+size_t FontManager::shared_font_resource_count() const {
+  size_t count = 0;
+  for (auto& it : m_shared_font_resources) {
+    if (!it.second.expired()) {
+      ++count;
+    }
+  }
+  return count;
+}
+
 bool FontManager::HasFontFace(const FontDescription& font_desc) const {
   return m_fonts.count(font_desc.font_face_id()) > 0;
 }
@@ -193,6 +301,12 @@ FontFace* FontManager::CreateFontFace(const FontDescription& font_desc) {
   for (auto& font_renderer : m_font_renderers) {
     auto font = font_renderer->Create(this, fi->filename(), font_desc);
     if (font) {
+      if (m_distance_field_glyphs && font->is_scalable()) {
+        if (FontFace* source =
+                GetDistanceFieldSource(font_renderer.get(), fi, font_desc)) {
+          font->set_distance_field_source(source);
+        }
+      }
       auto font_ptr = font.get();
       m_fonts.emplace(font_desc.font_face_id(), std::move(font));
       return font_ptr;
@@ -201,5 +315,26 @@ FontFace* FontManager::CreateFontFace(const FontDescription& font_desc) {
   return nullptr;
 }
 
+FontFace* FontManager::GetDistanceFieldSource(
+    FontRenderer* font_renderer, const FontInfo* font_info,
+    const FontDescription& font_desc) {
+  // Sources are shared by all sizes of the same font and style.
+  FontDescription source_desc = font_desc;
+  source_desc.set_size(kDistanceFieldReferenceSize);
+  auto it = m_distance_field_sources.find(source_desc.font_face_id());
+  if (it != m_distance_field_sources.end()) {
+    return it->second.get();
+  }
+  auto source = font_renderer->Create(this, font_info->filename(), source_desc);
+  if (!source) {
+    return nullptr;
+  }
+  source->m_is_distance_field_source = true;
+  auto source_ptr = source.get();
+  m_distance_field_sources.emplace(source_desc.font_face_id(),
+                                   std::move(source));
+  return source_ptr;
+}
+
 }  // namespace text
 }  // namespace el
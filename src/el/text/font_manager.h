@@ -19,6 +19,7 @@
 #include "el/graphics/bitmap_fragment.h"
 #include "el/graphics/bitmap_fragment_manager.h"
 #include "el/graphics/renderer.h"
+#include "el/io/file_system.h"
 #include "el/text/font_face.h"
 #include "el/text/font_renderer.h"
 #include "el/text/utf8.h"
@@ -45,6 +46,25 @@ class FontInfo {
   TBID m_id;
 };
 
+// The contents of a font file, shared by all font faces (of any size) that are
+// created from it. Obtained with FontManager::GetFontFile.
+class FontFile {
+ public:
+  const std::string& filename() const { return m_filename; }
+  const uint8_t* data() const { return m_data; }
+  size_t size() const { return m_size; }
+
+ private:
+  friend class FontManager;
+  std::string m_filename;
+  // Kept open when the file system already has the contents in memory, so we
+  // can use them without a copy.
+  std::unique_ptr<io::File> m_file;
+  std::vector<uint8_t> m_buffer;
+  const uint8_t* m_data = nullptr;
+  size_t m_size = 0;
+};
+
 // Caches glyphs for font faces.
 // Rendered glyphs use bitmap fragments from its fragment manager.
 class FontGlyphCache : private graphics::RendererListener {
@@ -59,11 +79,18 @@ class FontGlyphCache : private graphics::RendererListener {
   // Returns the glyph, or nullptr on fail.
   FontGlyph* CreateAndCacheGlyph(const TBID& hash_id, utf8::UCS4 cp);
 
-  // Creates a bitmap fragment for the given glyph and render data. This may
-  // drop other rendered glyphs from the fragment map.
+  // Creates a bitmap fragment for the given glyph and render data (in BGRA32
+  // format). This may drop other rendered glyphs from the fragment map.
+  // Returns the fragment, or nullptr on fail.
+  graphics::BitmapFragment* CreateFragment(FontGlyph* glyph, int w, int h,
+                                           int stride, const uint32_t* data);
+
+  // Creates a bitmap fragment for the given glyph from 8-bit coverage. It's
+  // stored as is in A8 maps if the renderer supports them, and expanded to
+  // white BGRA32 otherwise.
   // Returns the fragment, or nullptr on fail.
   graphics::BitmapFragment* CreateFragment(FontGlyph* glyph, int w, int h,
-                                           int stride, uint32_t* data);
+                                           int stride, const uint8_t* coverage);
 
 #ifdef EL_RUNTIME_DEBUG_INFO
   // Renders the glyph bitmaps on screen, to analyze fragment positioning.
@@ -74,9 +101,19 @@ class FontGlyphCache : private graphics::RendererListener {
   void OnContextRestored() override;
 
  private:
+  graphics::BitmapFragment* CreateFragmentInManager(
+      graphics::BitmapFragmentManager* frag_manager, FontGlyph* glyph, int w,
+      int h, int stride, const void* data);
+  graphics::BitmapFragmentManager* GetFragmentManager(
+      graphics::PixelFormat pixel_format);
   void DropGlyphFragment(FontGlyph* glyph);
 
   graphics::BitmapFragmentManager m_frag_manager;
+  // Holds glyphs rendered from coverage if the renderer supports A8 bitmaps.
+  // Its map uses as much memory as the BGRA32 one but fits 4x the glyphs.
+  graphics::BitmapFragmentManager m_alpha_frag_manager;
+  bool m_use_alpha_maps = false;
+  util::StringBuilder m_temp_buffer;
   std::unordered_map<uint32_t, std::unique_ptr<FontGlyph>> m_glyphs;
   util::IntrusiveList<FontGlyph> m_all_rendered_glyphs;
 };
@@ -138,15 +175,72 @@ class FontManager {
     m_default_font_desc = font_desc;
   }
 
+  // Gets the contents of the given font file, loading it if no font face is
+  // currently using it. All sizes created from the same file share the data.
+  // Returns nullptr if the file can't be read.
+  std::shared_ptr<const FontFile> GetFontFile(const std::string& filename);
+
+  // Gets a resource shared between font renderers, such as a parsed font file
+  // or a decoded glyph bitmap. If no renderer currently holds the resource
+  // with the given key, it is created by calling loader, which should return a
+  // std::shared_ptr<T> (or nullptr on fail). The resource is released when the
+  // last reference to it is dropped.
+  // Keys must identify both the resource type and its source, so renderers
+  // should prefix them (f.ex "tbbf:" + filename).
+  template <typename T, typename Loader>
+  std::shared_ptr<T> GetSharedFontResource(const std::string& key,
+                                           Loader loader) {
+    auto it = m_shared_font_resources.find(key);
+    if (it != m_shared_font_resources.end()) {
+      if (auto resource = it->second.lock()) {
+        return std::static_pointer_cast<T>(resource);
+      }
+    }
+    EraseExpiredFontResources();
+    // The loader may get other resources, so the map is looked up again.
+    std::shared_ptr<T> resource = loader();
+    m_shared_font_resources[key] = resource;
+    return resource;
+  }
+
+  // Returns the number of shared font resources that are currently alive.
+  size_t shared_font_resource_count() const;
+
+  // Enables distance field glyphs for scalable font faces created after this
+  // call. Their glyphs are rasterized once per font at a reference size and
+  // drawn at any size from the same glyph cache entries, instead of being
+  // rasterized again for every size.
+  void set_distance_field_glyphs(bool enabled) {
+    m_distance_field_glyphs = enabled;
+  }
+  bool distance_field_glyphs() const { return m_distance_field_glyphs; }
+
   // Returns the glyph cache used for fonts created by this font manager.
   FontGlyphCache* glyph_cache() { return &m_glyph_cache; }
 
  private:
   static std::unique_ptr<FontManager> font_manager_singleton_;
 
+  // Removes the shared font resources that have been released.
+  void EraseExpiredFontResources();
+
+  // Gets or creates the distance field source face for the font.
+  FontFace* GetDistanceFieldSource(FontRenderer* font_renderer,
+                                   const FontInfo* font_info,
+                                   const FontDescription& font_desc);
+
   std::unordered_map<uint32_t, std::unique_ptr<FontInfo>> m_font_info;
   std::unordered_map<uint32_t, std::unique_ptr<FontFace>> m_fonts;
+  // Reference size faces providing distance field glyphs, by the face id of
+  // the font and style at the reference size.
+  std::unordered_map<uint32_t, std::unique_ptr<FontFace>>
+      m_distance_field_sources;
+  bool m_distance_field_glyphs = false;
   std::vector<std::unique_ptr<FontRenderer>> m_font_renderers;
+  // Keyed by the full key, as the values are cast back to the type the key
+  // implies.
+  std::unordered_map<std::string, std::weak_ptr<void>>
+      m_shared_font_resources;
   FontGlyphCache m_glyph_cache;
   FontDescription m_default_font_desc;
   FontDescription m_test_font_desc;
@@ -38,6 +38,10 @@ class FontRenderer {
       FontManager* font_manager, const std::string& filename,
       const FontDescription& font_desc) = 0;
 
+  // Returns true if the font is an outline font that renders well at any size,
+  // so it can be used for distance field glyphs.
+  virtual bool is_scalable() const { return false; }
+
   virtual bool RenderGlyph(FontGlyphData* data, utf8::UCS4 cp) = 0;
   virtual void GetGlyphMetrics(GlyphMetrics* metrics, utf8::UCS4 cp) = 0;
   virtual FontMetrics GetMetrics() = 0;
@@ -7,7 +7,12 @@
  ******************************************************************************
  */
 
+#include <memory>
+#include <string>
+
 #include "el/graphics/renderer.h"
+#include "el/text/font_face.h"
+#include "el/text/font_manager.h"
 #include "el/text/font_renderer.h"
 
 #ifdef EL_FONT_RENDERER_FREETYPE
@@ -16,91 +21,79 @@
 #include FT_FREETYPE_H
 #include FT_SIZES_H
 
-int num_fonts = 0;
-bool ft_initialized = false;
-static FT_Library g_freetype = nullptr;
+namespace el {
+namespace text {
 
-using namespace el;
-using namespace el::resources;
 using UCS4 = el::text::utf8::UCS4;
 
-/** Cache of truetype file data, so it isn't loaded multiple times for each font
- * size */
+namespace {
 
-class FreetypeFace;
-static util::HashTableOf<FreetypeFace> ft_face_cache;
+// The freetype library, alive as long as any face is.
+class FreetypeLibrary {
+ public:
+  ~FreetypeLibrary() {
+    if (library) FT_Done_FreeType(library);
+  }
+  FT_Library library = nullptr;
+};
 
+// A freetype face shared by all font sizes created from the same file. Each
+// size gets its own FT_Size on the face.
 class FreetypeFace {
  public:
-  FreetypeFace() : hashID(0), ttf_buffer(nullptr), m_face(0), refCount(1) {}
   ~FreetypeFace() {
-    if (hashID) ft_face_cache.Remove(hashID);
-    FT_Done_Face(m_face);
-    delete[] ttf_buffer;
-  }
-  void Release() {
-    --refCount;
-    if (!refCount) delete this;
+    if (face) FT_Done_Face(face);
   }
-
-  uint32_t hashID;
-  unsigned char* ttf_buffer;
-  FT_Face m_face;
-  unsigned int refCount;
+  std::shared_ptr<FreetypeLibrary> library;
+  std::shared_ptr<const FontFile> font_file;
+  FT_Face face = nullptr;
 };
 
-/** FreetypeFontRenderer renders fonts using the freetype library. */
+}  // namespace
+
+// FreetypeFontRenderer renders fonts using the freetype library.
 class FreetypeFontRenderer : public FontRenderer {
  public:
   FreetypeFontRenderer();
   ~FreetypeFontRenderer();
 
-  virtual FontFace* Create(FontManager* font_manager,
-                           const std::string& filename,
-                           const FontDescription& font_desc);
+  std::unique_ptr<FontFace> Create(FontManager* font_manager,
+                                   const std::string& filename,
+                                   const FontDescription& font_desc) override;
 
-  virtual FontMetrics GetMetrics();
-  virtual bool RenderGlyph(FontGlyphData* dst_bitmap, UCS4 cp);
-  virtual void GetGlyphMetrics(GlyphMetrics* metrics, UCS4 cp);
+  FontMetrics GetMetrics() override;
+  bool is_scalable() const override { return true; }
+  bool RenderGlyph(FontGlyphData* dst_bitmap, UCS4 cp) override;
+  void GetGlyphMetrics(GlyphMetrics* metrics, UCS4 cp) override;
 
  private:
-  bool Load(FreetypeFace* face, int size);
-  bool Load(const char* filename, int size);
+  bool Load(std::shared_ptr<FreetypeFace> face, int size);
 
   FT_Size m_size;
-  FreetypeFace* m_face;
+  std::shared_ptr<FreetypeFace> m_face;
 };
 
-FreetypeFontRenderer::FreetypeFontRenderer()
-    : m_size(nullptr), m_face(nullptr) {
-  num_fonts++;
-}
+FreetypeFontRenderer::FreetypeFontRenderer() : m_size(nullptr) {}
 
 FreetypeFontRenderer::~FreetypeFontRenderer() {
-  FT_Done_Size(m_size);
-  if (m_face) m_face->Release();
-
-  num_fonts--;
-  if (num_fonts == 0 && ft_initialized) {
-    FT_Done_FreeType(g_freetype);
-    ft_initialized = false;
-  }
+  if (m_size) FT_Done_Size(m_size);
 }
 
 FontMetrics FreetypeFontRenderer::GetMetrics() {
   FontMetrics metrics;
-  metrics.ascent = (int16_t)(m_size->metrics.ascender >> 6);
-  metrics.descent = (int16_t) - (m_size->metrics.descender >> 6);
-  metrics.height = (int16_t)(m_size->metrics.height >> 6);
+  metrics.ascent = int16_t(m_size->metrics.ascender >> 6);
+  metrics.descent = int16_t(-(m_size->metrics.descender >> 6));
+  metrics.height = int16_t(m_size->metrics.height >> 6);
   return metrics;
 }
 
 bool FreetypeFontRenderer::RenderGlyph(FontGlyphData* data, UCS4 cp) {
   FT_Activate_Size(m_size);
-  FT_GlyphSlot slot = m_face->m_face->glyph;
-  if (FT_Load_Char(m_face->m_face, cp, FT_LOAD_RENDER) ||
-      slot->bitmap.pixel_mode != FT_PIXEL_MODE_GRAY)
+  FT_GlyphSlot slot = m_face->face->glyph;
+  if (FT_Load_Char(m_face->face, cp, FT_LOAD_RENDER) ||
+      slot->bitmap.pixel_mode != FT_PIXEL_MODE_GRAY) {
     return false;
+  }
   data->w = slot->bitmap.width;
   data->h = slot->bitmap.rows;
   data->stride = slot->bitmap.pitch;
@@ -110,70 +103,68 @@ bool FreetypeFontRenderer::RenderGlyph(FontGlyphData* data, UCS4 cp) {
 
 void FreetypeFontRenderer::GetGlyphMetrics(GlyphMetrics* metrics, UCS4 cp) {
   FT_Activate_Size(m_size);
-  FT_GlyphSlot slot = m_face->m_face->glyph;
-  if (FT_Load_Char(m_face->m_face, cp, FT_LOAD_RENDER)) return;
-  metrics->advance = (int16_t)(slot->advance.x >> 6);
-  metrics->x = slot->bitmap_left;
-  metrics->y = -slot->bitmap_top;
+  // Only load the outline metrics. The glyph is rasterized later, and only if
+  // it's drawn, by RenderGlyph.
+  if (FT_Load_Char(m_face->face, cp, FT_LOAD_DEFAULT)) {
+    return;
+  }
+  const FT_Glyph_Metrics& glyph_metrics = m_face->face->glyph->metrics;
+  metrics->advance = int16_t(m_face->face->glyph->advance.x >> 6);
+  // Same rounding as the bitmap_left/bitmap_top of a rendered glyph.
+  metrics->x = int16_t(glyph_metrics.horiBearingX >> 6);
+  metrics->y = int16_t(-((glyph_metrics.horiBearingY + 63) >> 6));
 }
 
-bool FreetypeFontRenderer::Load(FreetypeFace* face, int size) {
-  // Should not be possible to have a face if freetype is not initialized
-  assert(ft_initialized);
-  m_face = face;
-  if (FT_New_Size(m_face->m_face, &m_size) || FT_Activate_Size(m_size) ||
-      FT_Set_Pixel_Sizes(m_face->m_face, 0, size))
+bool FreetypeFontRenderer::Load(std::shared_ptr<FreetypeFace> face, int size) {
+  m_face = std::move(face);
+  if (FT_New_Size(m_face->face, &m_size) || FT_Activate_Size(m_size) ||
+      FT_Set_Pixel_Sizes(m_face->face, 0, size)) {
     return false;
+  }
   return true;
 }
 
-bool FreetypeFontRenderer::Load(const std::string& filename, int size) {
-  if (!ft_initialized) ft_initialized = !FT_Init_FreeType(&g_freetype);
-  if (!ft_initialized) return false;
-
-  m_face = new FreetypeFace();
-
-  auto file = util::File::Open(filename, util::File::Mode::kRead);
-  if (!file) return false;
-
-  size_t ttf_buf_size = file->Size();
-  m_face->ttf_buffer = new unsigned char[ttf_buf_size];
-  ttf_buf_size = file->Read(m_face->ttf_buffer, 1, ttf_buf_size);
-
-  if (FT_New_Memory_Face(g_freetype, m_face->ttf_buffer, ttf_buf_size, 0,
-                         &m_face->m_face))
-    return false;
-  return Load(m_face, size);
-}
-
-FontFace* FreetypeFontRenderer::Create(FontManager* font_manager,
-                                       const std::string& filename,
-                                       const FontDescription& font_desc) {
-  if (FreetypeFontRenderer* fr = new FreetypeFontRenderer()) {
-    TBID face_cache_id(filename);
-    FreetypeFace* f = ft_face_cache.Get(face_cache_id);
-    if (f) {
-      ++f->refCount;
-      if (fr->Load(f, static_cast<int>(font_desc.size())))
-        if (FontFace* font =
-                new FontFace(font_manager->glyph_cache(), fr, font_desc))
-          return font;
-    } else if (fr->Load(filename, static_cast<int>(font_desc.size()))) {
-      if (ft_face_cache.Add(face_cache_id, fr->m_face))
-        fr->m_face->hashID = face_cache_id;
-      if (FontFace* font =
-              new FontFace(font_manager->glyph_cache(), fr, font_desc))
-        return font;
-    }
-
-    delete fr;
+std::unique_ptr<FontFace> FreetypeFontRenderer::Create(
+    FontManager* font_manager, const std::string& filename,
+    const FontDescription& font_desc) {
+  auto face = font_manager->GetSharedFontResource<FreetypeFace>(
+      "freetype:" + filename,
+      [font_manager, &filename]() -> std::shared_ptr<FreetypeFace> {
+        auto library = font_manager->GetSharedFontResource<FreetypeLibrary>(
+            "freetype-library", []() -> std::shared_ptr<FreetypeLibrary> {
+              auto library = std::make_shared<FreetypeLibrary>();
+              if (FT_Init_FreeType(&library->library)) return nullptr;
+              return library;
+            });
+        auto font_file = font_manager->GetFontFile(filename);
+        if (!library || !font_file) return nullptr;
+        auto face = std::make_shared<FreetypeFace>();
+        face->library = std::move(library);
+        face->font_file = std::move(font_file);
+        if (FT_New_Memory_Face(face->library->library, face->font_file->data(),
+                               FT_Long(face->font_file->size()), 0,
+                               &face->face)) {
+          return nullptr;
+        }
+        return face;
+      });
+  if (!face) return nullptr;
+
+  auto font_renderer = std::make_unique<FreetypeFontRenderer>();
+  if (!font_renderer->Load(std::move(face),
+                           static_cast<int>(font_desc.size()))) {
+    return nullptr;
   }
-  return nullptr;
+  return std::make_unique<FontFace>(font_manager->glyph_cache(),
+                                    std::move(font_renderer), font_desc);
 }
 
+}  // namespace text
+}  // namespace el
+
 void register_freetype_font_renderer() {
-  FontManager::get()->RegisterRenderer(
-      std::make_unique<FreetypeFontRenderer>());
+  el::text::FontManager::get()->RegisterRenderer(
+      std::make_unique<el::text::FreetypeFontRenderer>());
 }
 
 #endif  // EL_FONT_RENDERER_FREETYPE
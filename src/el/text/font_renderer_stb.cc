@@ -30,30 +30,29 @@ class SFontRenderer : public FontRenderer {
   SFontRenderer();
   ~SFontRenderer();
 
-  bool Load(const char* filename, int size);
+  bool Load(std::shared_ptr<const FontFile> font_file, int size);
 
   std::unique_ptr<FontFace> Create(FontManager* font_manager,
                                    const std::string& filename,
                                    const FontDescription& font_desc) override;
 
+  bool is_scalable() const override { return true; }
   bool RenderGlyph(FontGlyphData* dst_bitmap, UCS4 cp) override;
   void GetGlyphMetrics(GlyphMetrics* metrics, UCS4 cp) override;
   FontMetrics GetMetrics() override;
 
  private:
+  // File data shared with all other sizes created from the same file.
+  std::shared_ptr<const FontFile> font_file;
   stbtt_fontinfo font;
-  unsigned char* ttf_buffer;
   unsigned char* render_data;
   int font_size;
   float scale;
 };
 
-SFontRenderer::SFontRenderer() : ttf_buffer(nullptr), render_data(nullptr) {}
+SFontRenderer::SFontRenderer() : render_data(nullptr) {}
 
-SFontRenderer::~SFontRenderer() {
-  delete[] ttf_buffer;
-  delete[] render_data;
-}
+SFontRenderer::~SFontRenderer() { delete[] render_data; }
 
 bool SFontRenderer::RenderGlyph(FontGlyphData* data, UCS4 cp) {
   delete[] render_data;
@@ -66,11 +65,14 @@ bool SFontRenderer::RenderGlyph(FontGlyphData* data, UCS4 cp) {
 }
 
 void SFontRenderer::GetGlyphMetrics(GlyphMetrics* metrics, UCS4 cp) {
+  // Look up the glyph once and query its metrics without rasterizing it.
+  int glyph_index = stbtt_FindGlyphIndex(&font, cp);
   int advanceWidth, leftSideBearing;
-  stbtt_GetCodepointHMetrics(&font, cp, &advanceWidth, &leftSideBearing);
+  stbtt_GetGlyphHMetrics(&font, glyph_index, &advanceWidth, &leftSideBearing);
   metrics->advance = static_cast<int>(advanceWidth * scale + 0.5f);
   int ix0, iy0, ix1, iy1;
-  stbtt_GetCodepointBitmapBox(&font, cp, 0, scale, &ix0, &iy0, &ix1, &iy1);
+  stbtt_GetGlyphBitmapBox(&font, glyph_index, 0, scale, &ix0, &iy0, &ix1,
+                          &iy1);
   metrics->x = ix0;
   metrics->y = iy0;
 }
@@ -86,15 +88,14 @@ FontMetrics SFontRenderer::GetMetrics() {
   return metrics;
 }
 
-bool SFontRenderer::Load(const char* filename, int size) {
-  auto file = util::File::Open(filename, util::File::Mode::kRead);
-  if (!file) return false;
-
-  size_t ttf_buf_size = file->Size();
-  ttf_buffer = new unsigned char[ttf_buf_size];
-  ttf_buf_size = file->Read(ttf_buffer, 1, ttf_buf_size);
-
-  stbtt_InitFont(&font, ttf_buffer, stbtt_GetFontOffsetForIndex(ttf_buffer, 0));
+bool SFontRenderer::Load(std::shared_ptr<const FontFile> file, int size) {
+  font_file = std::move(file);
+  // stb_truetype never writes to the font data.
+  auto ttf_buffer = const_cast<unsigned char*>(font_file->data());
+  if (!stbtt_InitFont(&font, ttf_buffer,
+                      stbtt_GetFontOffsetForIndex(ttf_buffer, 0))) {
+    return false;
+  }
 
   font_size =
       static_cast<int>(size * 1.3f);  // FIX: Constant taken out of thin air
@@ -106,8 +107,12 @@ bool SFontRenderer::Load(const char* filename, int size) {
 std::unique_ptr<FontFace> SFontRenderer::Create(
     FontManager* font_manager, const std::string& filename,
     const FontDescription& font_desc) {
+  auto font_file = font_manager->GetFontFile(filename);
+  if (!font_file) {
+    return nullptr;
+  }
   auto font_renderer = std::make_unique<SFontRenderer>();
-  if (font_renderer->Load(filename.c_str(),
+  if (font_renderer->Load(std::move(font_file),
                           static_cast<int>(font_desc.size()))) {
     return std::make_unique<FontFace>(font_manager->glyph_cache(),
                                       std::move(font_renderer), font_desc);
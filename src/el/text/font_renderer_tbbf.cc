@@ -31,6 +31,21 @@ namespace {
 struct GLYPH {
   int x, w;
 };
+
+// The parsed font description, shared by all sizes created from the file.
+struct TBBFFile {
+  ParseNode node;
+};
+
+// A glyph image and the glyphs found in it, shared by all faces that use the
+// same size node.
+struct TBBFBitmap {
+  bool FindGlyphs(const char* glyph_str);
+  std::unique_ptr<GLYPH> FindNext(UCS4 cp, int x);
+
+  std::unique_ptr<graphics::ImageLoader> img;
+  std::unordered_map<uint32_t, std::unique_ptr<GLYPH>> glyph_table;
+};
 }  // namespace
 
 /** TBBFRenderer renders a bitmap font.
@@ -100,9 +115,7 @@ class TBBFRenderer : public FontRenderer {
   TBBFRenderer();
   ~TBBFRenderer();
 
-  bool Load(const std::string& filename, int size);
-  bool FindGlyphs();
-  std::unique_ptr<GLYPH> FindNext(UCS4 cp, int x);
+  bool Load(FontManager* font_manager, const std::string& filename, int size);
 
   std::unique_ptr<FontFace> Create(FontManager* font_manager,
                                    const std::string& filename,
@@ -113,15 +126,14 @@ class TBBFRenderer : public FontRenderer {
   void GetGlyphMetrics(GlyphMetrics* metrics, UCS4 cp) override;
 
  private:
-  ParseNode m_node;
+  std::shared_ptr<TBBFFile> m_file;
+  std::shared_ptr<TBBFBitmap> m_bitmap;
   FontMetrics m_metrics;
-  std::unique_ptr<graphics::ImageLoader> m_img;
   int m_size;
   int m_x_ofs;
   int m_advance_delta;
   int m_space_advance;
   int m_rgb;
-  std::unordered_map<uint32_t, std::unique_ptr<GLYPH>> m_glyph_table;
 };
 
 TBBFRenderer::TBBFRenderer()
@@ -136,18 +148,19 @@ bool TBBFRenderer::RenderGlyph(FontGlyphData* data, UCS4 cp) {
     return false;
   }
 
-  auto it = m_glyph_table.find(cp);
-  if (it == m_glyph_table.end()) {
-    it = m_glyph_table.find('?');
+  auto& glyph_table = m_bitmap->glyph_table;
+  auto it = glyph_table.find(cp);
+  if (it == glyph_table.end()) {
+    it = glyph_table.find('?');
   }
-  if (it == m_glyph_table.end()) {
+  if (it == glyph_table.end()) {
     return false;
   }
   auto glyph = it->second.get();
   data->w = glyph->w;
-  data->h = m_img->height();
-  data->stride = m_img->width();
-  data->data32 = m_img->data() + glyph->x;
+  data->h = m_bitmap->img->height();
+  data->stride = m_bitmap->img->width();
+  data->data32 = m_bitmap->img->data() + glyph->x;
   data->rgb = m_rgb ? true : false;
   return true;
 }
@@ -158,12 +171,13 @@ void TBBFRenderer::GetGlyphMetrics(GlyphMetrics* metrics, UCS4 cp) {
   if (cp == ' ') {
     metrics->advance = m_space_advance;
   } else {
-    auto it = m_glyph_table.find(cp);
-    if (it != m_glyph_table.end()) {
+    auto& glyph_table = m_bitmap->glyph_table;
+    auto it = glyph_table.find(cp);
+    if (it != glyph_table.end()) {
       metrics->advance = it->second->w + m_advance_delta;
     } else {
-      it = m_glyph_table.find('?');
-      if (it != m_glyph_table.end()) {
+      it = glyph_table.find('?');
+      if (it != glyph_table.end()) {
         metrics->advance = it->second->w + m_advance_delta;
       } else {
         metrics->advance = 0;
@@ -172,13 +186,21 @@ void TBBFRenderer::GetGlyphMetrics(GlyphMetrics* metrics, UCS4 cp) {
   }
 }
 
-bool TBBFRenderer::Load(const std::string& filename, int size) {
+bool TBBFRenderer::Load(FontManager* font_manager, const std::string& filename,
+                        int size) {
   m_size = size;
-  if (!m_node.ReadFile(filename)) return false;
+  m_file = font_manager->GetSharedFontResource<TBBFFile>(
+      "tbbf:" + filename, [&filename]() -> std::shared_ptr<TBBFFile> {
+        auto file = std::make_shared<TBBFFile>();
+        if (!file->node.ReadFile(filename)) return nullptr;
+        return file;
+      });
+  if (!m_file) return false;
+  ParseNode* node = &m_file->node;
 
   // Check for size nodes and get the one closest to the size we want.
   ParseNode* size_node = nullptr;
-  for (ParseNode* n = m_node.first_child(); n; n = n->GetNext()) {
+  for (ParseNode* n = node->first_child(); n; n = n->GetNext()) {
     if (strcmp(n->name(), "size") == 0) {
       if (!size_node ||
           std::abs(m_size - n->value().as_integer()) <
@@ -199,7 +221,7 @@ bool TBBFRenderer::Load(const std::string& filename, int size) {
   m_x_ofs = size_node->GetValueInt("x_ofs", 0);
 
   // Info
-  m_rgb = m_node.GetValueInt("info>rgb", 0);
+  m_rgb = node->GetValueInt("info>rgb", 0);
 
   // Get the path for the bitmap file.
   util::StringBuilder bitmap_filename;
@@ -208,39 +230,46 @@ bool TBBFRenderer::Load(const std::string& filename, int size) {
   // Append the bitmap filename for the given size.
   bitmap_filename.AppendString(size_node->GetValueString("bitmap", ""));
 
-  m_img = graphics::ImageLoader::CreateFromFile(bitmap_filename.c_str());
-
-  return FindGlyphs();
+  // Sizes that resolve to the same size node share the decoded image.
+  const char* glyph_str = node->GetValueString("info>glyph_str", nullptr);
+  m_bitmap = font_manager->GetSharedFontResource<TBBFBitmap>(
+      "tbbf-bitmap:" + std::string(bitmap_filename.c_str()),
+      [&bitmap_filename, glyph_str]() -> std::shared_ptr<TBBFBitmap> {
+        auto bitmap = std::make_shared<TBBFBitmap>();
+        bitmap->img =
+            graphics::ImageLoader::CreateFromFile(bitmap_filename.c_str());
+        if (!bitmap->FindGlyphs(glyph_str)) return nullptr;
+        return bitmap;
+      });
+  return m_bitmap != nullptr;
 }
 
 inline unsigned char GetAlpha(uint32_t color) {
   return (color & 0xff000000) >> 24;
 }
 
-bool TBBFRenderer::FindGlyphs() {
-  if (!m_img) return false;
-
-  const char* glyph_str = m_node.GetValueString("info>glyph_str", nullptr);
+bool TBBFBitmap::FindGlyphs(const char* glyph_str) {
+  if (!img) return false;
   if (!glyph_str) return false;
 
-  size_t glyph_str_len = strlen(glyph_str);
-  size_t i = 0;
+  utf8::ChunkDecoder decoder(glyph_str, strlen(glyph_str));
   int x = 0;
-  while (UCS4 uc = utf8::decode_next(glyph_str, &i, glyph_str_len)) {
+  UCS4 uc;
+  while (decoder.Next(&uc)) {
     auto glyph = FindNext(uc, x);
     if (!glyph) {
       break;
     }
     x = glyph->x + glyph->w + 1;
-    m_glyph_table.emplace(uc, std::move(glyph));
+    glyph_table.emplace(uc, std::move(glyph));
   }
   return true;
 }
 
-std::unique_ptr<GLYPH> TBBFRenderer::FindNext(UCS4 cp, int x) {
-  int width = m_img->width();
-  int height = m_img->height();
-  uint32_t* data32 = m_img->data();
+std::unique_ptr<GLYPH> TBBFBitmap::FindNext(UCS4 cp, int x) {
+  int width = img->width();
+  int height = img->height();
+  uint32_t* data32 = img->data();
 
   if (x >= width) {
     return nullptr;
@@ -285,7 +314,7 @@ std::unique_ptr<FontFace> TBBFRenderer::Create(
     const FontDescription& font_desc) {
   if (!strstr(filename.c_str(), ".tb.txt")) return nullptr;
   auto fr = std::make_unique<TBBFRenderer>();
-  if (!fr->Load(filename, static_cast<int>(font_desc.size()))) {
+  if (!fr->Load(font_manager, filename, static_cast<int>(font_desc.size()))) {
     return nullptr;
   }
   return std::make_unique<FontFace>(font_manager->glyph_cache(), std::move(fr),
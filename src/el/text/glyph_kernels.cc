@@ -0,0 +1,144 @@
+/**
+ ******************************************************************************
+ * Elemental Forms : a lightweight user interface framework                   *
+ ******************************************************************************
+ * Copyright 2015 Ben Vanik. All rights reserved. Licensed as BSD 3-clause.   *
+ * Portions ©2011-2015 Emil Segerås: https://github.com/fruxo/turbobadger     *
+ ******************************************************************************
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "el/config.h"
+#include "el/text/glyph_kernels.h"
+
+#ifdef EL_SIMD_SSE2
+#include <emmintrin.h>
+#endif  // EL_SIMD_SSE2
+
+namespace el {
+namespace text {
+
+namespace {
+
+// Rows of the horizontal pass are padded to a multiple of 4 floats so the
+// kernels can always work on whole vectors.
+inline int PaddedWidth(int w) { return (w + 3) & ~3; }
+
+}  // namespace
+
+size_t GetBlurGlyphTempSize(int src_w, int src_h, int kernel_radius) {
+  const int padded_w = PaddedWidth(src_w + kernel_radius * 2);
+  // One zero padded source row, and the result of the horizontal pass.
+  return size_t(padded_w + kernel_radius * 2) + size_t(padded_w) * src_h;
+}
+
+void BlurGlyph(const uint8_t* src, int src_w, int src_h, int src_stride,
+               uint8_t* dst, int dst_stride, float* temp, const float* kernel,
+               int kernel_radius) {
+  const int taps = kernel_radius * 2 + 1;
+  const int dst_w = src_w + kernel_radius * 2;
+  const int dst_h = src_h + kernel_radius * 2;
+  const int padded_w = PaddedWidth(dst_w);
+  float* row = temp;
+  float* horizontal = temp + padded_w + kernel_radius * 2;
+
+  // Horizontal pass. Each source row is copied to a float row with enough
+  // zeros around it that every output pixel can read all taps unconditionally.
+  const int row_size = padded_w + kernel_radius * 2;
+  std::fill(row, row + row_size, 0.0f);
+  for (int y = 0; y < src_h; ++y) {
+    const uint8_t* src_row = src + y * src_stride;
+    for (int x = 0; x < src_w; ++x) {
+      row[kernel_radius * 2 + x] = src_row[x];
+    }
+    float* out = horizontal + y * padded_w;
+#ifdef EL_SIMD_SSE2
+    for (int x = 0; x < padded_w; x += 4) {
+      __m128 sum = _mm_setzero_ps();
+      for (int k = 0; k < taps; ++k) {
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(row + x + k),
+                                         _mm_set1_ps(kernel[k])));
+      }
+      _mm_storeu_ps(out + x, sum);
+    }
+#else
+    for (int x = 0; x < padded_w; ++x) {
+      float sum = 0.0f;
+      for (int k = 0; k < taps; ++k) {
+        sum += row[x + k] * kernel[k];
+      }
+      out[x] = sum;
+    }
+#endif  // EL_SIMD_SSE2
+  }
+
+  // Vertical pass. Only taps that hit source rows contribute.
+  for (int y = 0; y < dst_h; ++y) {
+    const int first_tap = std::max(0, kernel_radius * 2 - y);
+    const int last_tap = std::min(taps - 1, src_h - 1 + kernel_radius * 2 - y);
+    // Horizontal pass row that tap 0 reads (only dereferenced from first_tap).
+    const int first_row = y - kernel_radius * 2;
+    uint8_t* out = dst + y * dst_stride;
+#ifdef EL_SIMD_SSE2
+    const __m128 half = _mm_set1_ps(0.5f);
+    for (int x = 0; x < dst_w; x += 4) {
+      __m128 sum = half;
+      for (int k = first_tap; k <= last_tap; ++k) {
+        const float* in = horizontal + (first_row + k) * padded_w;
+        sum = _mm_add_ps(
+            sum, _mm_mul_ps(_mm_loadu_ps(in + x), _mm_set1_ps(kernel[k])));
+      }
+      __m128i value = _mm_cvttps_epi32(sum);
+      value = _mm_packs_epi32(value, value);
+      value = _mm_packus_epi16(value, value);
+      uint32_t pixels = uint32_t(_mm_cvtsi128_si32(value));
+      std::memcpy(out + x, &pixels, std::min(4, dst_w - x));
+    }
+#else
+    for (int x = 0; x < dst_w; ++x) {
+      float sum = 0.5f;
+      for (int k = first_tap; k <= last_tap; ++k) {
+        sum += horizontal[(first_row + k) * padded_w + x] * kernel[k];
+      }
+      out[x] = uint8_t(std::min(255.0f, sum));
+    }
+#endif  // EL_SIMD_SSE2
+  }
+}
+
+void ExpandCoverageToBGRA(const uint8_t* src, int w, int h, int src_stride,
+                          uint32_t* dst) {
+  for (int y = 0; y < h; ++y) {
+    const uint8_t* in = src + y * src_stride;
+    uint32_t* out = dst + y * w;
+    int x = 0;
+#ifdef EL_SIMD_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i white = _mm_set1_epi32(0x00FFFFFF);
+    for (; x + 16 <= w; x += 16) {
+      // Interleaving zeros below each byte twice moves it to the top byte of
+      // a 32-bit lane, which is alpha in BGRA.
+      __m128i alpha = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + x));
+      __m128i lo = _mm_unpacklo_epi8(zero, alpha);
+      __m128i hi = _mm_unpackhi_epi8(zero, alpha);
+      __m128i* out_vec = reinterpret_cast<__m128i*>(out + x);
+      _mm_storeu_si128(out_vec + 0,
+                       _mm_or_si128(_mm_unpacklo_epi16(zero, lo), white));
+      _mm_storeu_si128(out_vec + 1,
+                       _mm_or_si128(_mm_unpackhi_epi16(zero, lo), white));
+      _mm_storeu_si128(out_vec + 2,
+                       _mm_or_si128(_mm_unpacklo_epi16(zero, hi), white));
+      _mm_storeu_si128(out_vec + 3,
+                       _mm_or_si128(_mm_unpackhi_epi16(zero, hi), white));
+    }
+#endif  // EL_SIMD_SSE2
+    for (; x < w; ++x) {
+      out[x] = 0x00FFFFFF | (uint32_t(in[x]) << 24);
+    }
+  }
+}
+
+}  // namespace text
+}  // namespace el
@@ -0,0 +1,39 @@
+/**
+ ******************************************************************************
+ * Elemental Forms : a lightweight user interface framework                   *
+ ******************************************************************************
+ * Copyright 2015 Ben Vanik. All rights reserved. Licensed as BSD 3-clause.   *
+ * Portions ©2011-2015 Emil Segerås: https://github.com/fruxo/turbobadger     *
+ ******************************************************************************
+ */
+
+#ifndef EL_TEXT_GLYPH_KERNELS_H_
+#define EL_TEXT_GLYPH_KERNELS_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace el {
+namespace text {
+
+// Returns the number of floats of temporary memory BlurGlyph needs.
+size_t GetBlurGlyphTempSize(int src_w, int src_h, int kernel_radius);
+
+// Blurs an 8-bit glyph bitmap with the normalized separable kernel of
+// kernel_radius * 2 + 1 taps. The result is kernel_radius pixels larger than
+// the source on each side, so dst must hold (src_w + kernel_radius * 2) x
+// (src_h + kernel_radius * 2) pixels. temp must hold GetBlurGlyphTempSize
+// floats.
+void BlurGlyph(const uint8_t* src, int src_w, int src_h, int src_stride,
+               uint8_t* dst, int dst_stride, float* temp, const float* kernel,
+               int kernel_radius);
+
+// Expands 8-bit coverage to white BGRA32 pixels with coverage as alpha, as
+// used for glyph bitmap fragments. dst is written tightly packed (w * h).
+void ExpandCoverageToBGRA(const uint8_t* src, int w, int h, int src_stride,
+                          uint32_t* dst);
+
+}  // namespace text
+}  // namespace el
+
+#endif  // EL_TEXT_GLYPH_KERNELS_H_
@@ -151,13 +151,19 @@ el::text::FontFace* TextProps::computed_font() {
 TextBlock::TextBlock(TextView* style_edit)
     : style_edit(style_edit), align(int8_t(style_edit->align)) {}
 
-TextBlock::~TextBlock() { Clear(); }
+TextBlock::~TextBlock() {
+  if (style_edit->first_style_dirty_block == this) {
+    style_edit->first_style_dirty_block = nullptr;
+  }
+  Clear();
+}
 
 void TextBlock::Clear() { fragments.DeleteAll(); }
 
 void TextBlock::Set(const char* newstr, size_t len) {
   str.assign(newstr, len);
   str_len = len;
+  InvalidateStyle();
   Split();
   Layout(true, true);
 }
@@ -185,6 +191,7 @@ size_t TextBlock::InsertText(size_t ofs, const char* text, size_t len,
   size_t inserted_len = first_line_len;
   str.insert(ofs, text, first_line_len);
   str_len += first_line_len;
+  InvalidateStyle();
 
   Split();
   Layout(true, true);
@@ -217,6 +224,7 @@ void TextBlock::RemoveContent(size_t ofs, size_t len) {
   if (!len) return;
   str.erase(ofs, len);
   str_len -= len;
+  InvalidateStyle();
   Layout(true, true);
 }
 
@@ -245,6 +253,7 @@ void TextBlock::Split() {
       block->Set(str.c_str() + i, len);
       str.erase(i, len);
       str_len -= len;
+      InvalidateStyle();
       break;
     }
   }
@@ -255,6 +264,7 @@ void TextBlock::Merge() {
   if (next_block && !fragments.GetLast()->IsBreak()) {
     str.append(GetNext()->str);
     str_len = str.size();
+    InvalidateStyle();
 
     style_edit->blocks.Delete(next_block);
 
@@ -320,6 +330,7 @@ void TextBlock::Layout(bool update_fragments, bool propagate_height) {
   // Create fragments from the word fragments.
   if (update_fragments || !fragments.GetFirst()) {
     Clear();
+    fit_width = -1;
 
     size_t ofs = 0;
     const char* text = str.c_str();
@@ -354,6 +365,33 @@ void TextBlock::Layout(bool update_fragments, bool propagate_height) {
     return;
   }
 
+  // Word widths only need to be measured again if the font has changed, since
+  // the fragments are recreated when the text changes.
+  if (measured_font != style_edit->font) {
+    measured_font = style_edit->font;
+    fit_width = -1;
+    for (TextFragment* fragment = fragments.GetFirst(); fragment;
+         fragment = fragment->GetNext()) {
+      fragment->measured_width = -1;
+    }
+  }
+
+  // If only the layout width changed and we still fit on one line, the
+  // fragments stay where they are.
+  if (!update_fragments && fit_width >= 0 &&
+      fit_width <= style_edit->layout_width &&
+      TextAlign(align) == TextAlign::kLeft) {
+    ypos = GetPrev() ? GetPrev()->ypos + GetPrev()->height
+                     : style_edit->ypos_origin;
+    return;
+  }
+  fit_width = -1;
+  bool has_content = false;
+  int line_count = 0;
+  // Width of all fragments measured for the last line, including any after
+  // its last allowed break. For a single line that's all of the fragments.
+  int unwrapped_width = 0;
+
   int old_line_width_max = line_width_max;
   line_width_max = 0;
   int line_ypos = 0;
@@ -401,6 +439,7 @@ void TextBlock::Layout(bool update_fragments, bool propagate_height) {
       if (!allowed_last_fragment) {
         line_width = line_xpos;
       }
+      unwrapped_width = line_xpos;
     } else {
       // When wrapping is off, just measure and set pos.
       line_width = first_line_indentation;
@@ -409,6 +448,7 @@ void TextBlock::Layout(bool update_fragments, bool propagate_height) {
         fragment->xpos = line_width;
         line_width += fragment->GetWidth(style_edit->font);
       }
+      unwrapped_width = line_width;
     }
 
     // Commit line - Layout each fragment on the line.
@@ -444,6 +484,7 @@ void TextBlock::Layout(bool update_fragments, bool propagate_height) {
     int adjusted_line_height = line_height;
     fragment = first_fragment_on_line;
     while (fragment) {
+      has_content |= fragment->IsEmbedded();
       // The fragment need to know these later.
       fragment->line_ypos = line_ypos;
       fragment->line_height = line_height;
@@ -489,11 +530,21 @@ void TextBlock::Layout(bool update_fragments, bool propagate_height) {
 
     // Consume line.
     line_ypos += adjusted_line_height;
+    ++line_count;
 
     first_fragment_on_line = last_fragment_on_line->GetNext();
   }
 
-  ypos = GetPrev() ? GetPrev()->ypos + GetPrev()->height : 0;
+  // Embedded content may change size without the text changing, so such
+  // blocks are always laid out again. The line width may end before a
+  // fragment that can't be broken before, so the unwrapped width is used.
+  if (line_count == 1 && TextAlign(align) == TextAlign::kLeft &&
+      !has_content) {
+    fit_width = unwrapped_width;
+  }
+
+  ypos = GetPrev() ? GetPrev()->ypos + GetPrev()->height
+                   : style_edit->ypos_origin;
   SetSize(old_line_width_max, line_width_max, line_ypos, propagate_height);
 
   Invalidate();
@@ -526,8 +577,9 @@ void TextBlock::SetSize(int32_t old_w, int32_t new_w, int32_t new_h,
     style_edit->packed.calculate_content_width_needed = 1;
   }
 
-  style_edit->content_height =
-      style_edit->blocks.GetLast()->ypos + style_edit->blocks.GetLast()->height;
+  style_edit->content_height = style_edit->blocks.GetLast()->ypos -
+                               style_edit->ypos_origin +
+                               style_edit->blocks.GetLast()->height;
 
   if (style_edit->listener && style_edit->packed.lock_scrollbars_counter == 0 &&
       propagate_height) {
@@ -564,9 +616,26 @@ TextFragment* TextBlock::FindFragment(int32_t x, int32_t y) const {
 
 void TextBlock::Invalidate() {
   if (style_edit->listener) {
-    style_edit->listener->Invalidate(Rect(0, -style_edit->scroll_y + ypos,
-                                          style_edit->layout_width, height));
+    style_edit->listener->Invalidate(
+        Rect(0, ypos - style_edit->ypos_origin - style_edit->scroll_y,
+             style_edit->layout_width, height));
+  }
+}
+
+void TextBlock::InvalidateStyle() {
+  style_dirty = true;
+  style_edit->InvalidateStyle(this);
+}
+
+const TextStyleRun* TextBlock::FindStyleRun(size_t ofs) const {
+  auto it = std::upper_bound(
+      style_runs.begin(), style_runs.end(), ofs,
+      [](size_t ofs, const TextStyleRun& run) { return ofs < run.ofs; });
+  if (it == style_runs.begin()) {
+    return nullptr;
   }
+  --it;
+  return ofs < it->ofs + it->len ? &*it : nullptr;
 }
 
 void TextBlock::BuildSelectionRegion(int32_t translate_x, int32_t translate_y,
@@ -653,6 +722,13 @@ void TextFragment::Paint(int32_t translate_x, int32_t translate_y,
     content->Paint(this, translate_x, translate_y, props);
     return;
   }
+  const bool has_style_runs = !block->style_runs.empty() &&
+                              !block->style_edit->packed.password_on;
+  if (has_style_runs) {
+    if (const TextStyleRun* run = block->FindStyleRun(ofs)) {
+      color = run->color;
+    }
+  }
   TMPDEBUG(listener->DrawRect(Rect(x, y, GetWidth(font), GetHeight(font)),
                               Color(255, 255, 255, 128)));
 
@@ -676,6 +752,8 @@ void TextFragment::Paint(int32_t translate_x, int32_t translate_y,
     } else {
       listener->DrawString(x, y, font, color, Str(), len);
     }
+  } else if (has_style_runs && !IsTab() && !IsBreak() && !IsSpace()) {
+    PaintStyleRuns(x, y, font, props->data->text_color);
   } else if (!IsTab() && !IsBreak() && !IsSpace()) {
     listener->DrawString(x, y, font, color, Str(), len);
   }
@@ -688,6 +766,37 @@ void TextFragment::Paint(int32_t translate_x, int32_t translate_y,
   }
 }
 
+void TextFragment::PaintStyleRuns(int32_t x, int32_t y,
+                                  el::text::FontFace* font,
+                                  const Color& default_color) {
+  TextViewListener* listener = block->style_edit->listener;
+  // Draw each part of the fragment that is covered by a different run (or no
+  // run) separately.
+  size_t part_ofs = ofs;
+  const size_t end_ofs = size_t(ofs) + len;
+  while (part_ofs < end_ofs) {
+    Color color = default_color;
+    size_t part_end = end_ofs;
+    if (const TextStyleRun* run = block->FindStyleRun(part_ofs)) {
+      color = run->color;
+      part_end = std::min(part_end, run->ofs + run->len);
+    } else {
+      // Stop at the start of the next run, if any.
+      auto next_run = std::upper_bound(
+          block->style_runs.begin(), block->style_runs.end(), part_ofs,
+          [](size_t ofs, const TextStyleRun& run) { return ofs < run.ofs; });
+      if (next_run != block->style_runs.end()) {
+        part_end = std::min(part_end, next_run->ofs);
+      }
+    }
+    int32_t part_x =
+        x + block->CalculateStringWidth(font, Str(), part_ofs - ofs);
+    listener->DrawString(part_x, y, font, color, block->str.c_str() + part_ofs,
+                         part_end - part_ofs);
+    part_ofs = part_end;
+  }
+}
+
 void TextFragment::Click(int button, ModifierKeys modifierkeys) {
   if (content) {
     content->Click(this, button, modifierkeys);
@@ -698,7 +807,14 @@ int32_t TextFragment::GetWidth(el::text::FontFace* font) {
   if (content) return content->GetWidth(font, this);
   if (IsBreak()) return 0;
   if (IsTab()) return block->CalculateTabWidth(font, xpos);
-  return block->CalculateStringWidth(font, block->str.c_str() + ofs, len);
+  if (font != block->measured_font) {
+    return block->CalculateStringWidth(font, block->str.c_str() + ofs, len);
+  }
+  if (measured_width < 0) {
+    measured_width =
+        block->CalculateStringWidth(font, block->str.c_str() + ofs, len);
+  }
+  return measured_width;
 }
 
 int32_t TextFragment::GetHeight(el::text::FontFace* font) {
@@ -11,6 +11,7 @@
 #define EL_TEXT_TEXT_FRAGMENT_H_
 
 #include <string>
+#include <vector>
 
 #include "el/color.h"
 #include "el/element.h"
@@ -50,6 +51,14 @@ class TextProps {
   Data* data;
 };
 
+// A run of text in a TextBlock that should be drawn in the given color, as
+// produced by a TextStyler.
+struct TextStyleRun {
+  size_t ofs;
+  size_t len;
+  Color color;
+};
+
 // A block of text (a line, that might be wrapped).
 class TextBlock : public el::util::IntrusiveListEntry<TextBlock> {
  public:
@@ -95,6 +104,13 @@ class TextBlock : public el::util::IntrusiveListEntry<TextBlock> {
   int32_t CalculateBaseline(el::text::FontFace* font) const;
 
   void Invalidate();
+
+  // Marks the style runs as needing update by the TextStyler of the TextView,
+  // when the text has changed.
+  void InvalidateStyle();
+  // Gets the style run containing ofs, or nullptr if there's none.
+  const TextStyleRun* FindStyleRun(size_t ofs) const;
+
   void BuildSelectionRegion(int32_t translate_x, int32_t translate_y,
                             TextProps* props, el::util::RectRegion* bg_region,
                             el::util::RectRegion* fg_region);
@@ -112,6 +128,20 @@ class TextBlock : public el::util::IntrusiveListEntry<TextBlock> {
   std::string str;
   size_t str_len = 0;
 
+  // Style runs sorted by offset, and the TextStyler state before and after
+  // this block they were made with.
+  std::vector<TextStyleRun> style_runs;
+  uint32_t style_start_state = 0;
+  uint32_t style_end_state = 0;
+  bool style_dirty = true;
+
+  // Font the fragment widths are cached for (see TextFragment::GetWidth).
+  el::text::FontFace* measured_font = nullptr;
+  // If the block was laid out as one left aligned line, the width it needs.
+  // Layouts for any width at least this wide give the same result, so they
+  // can be skipped. -1 otherwise.
+  int32_t fit_width = -1;
+
  private:
   int GetStartIndentation(text::FontFace* font, size_t first_line_len) const;
 };
@@ -134,6 +164,9 @@ class TextFragment : public el::util::IntrusiveListEntry<TextFragment> {
                             TextProps* props, el::util::RectRegion* bg_region,
                             el::util::RectRegion* fg_region);
   void Paint(int32_t translate_x, int32_t translate_y, TextProps* props);
+  // Draws the text with the colors of the style runs of the block.
+  void PaintStyleRuns(int32_t x, int32_t y, el::text::FontFace* font,
+                      const Color& default_color);
   void Click(int button, ModifierKeys modifierkeys);
 
   bool IsText() const { return !IsEmbedded(); }
@@ -163,6 +196,8 @@ class TextFragment : public el::util::IntrusiveListEntry<TextFragment> {
   uint16_t ofs = 0, len = 0;
   uint16_t line_ypos = 0;
   uint16_t line_height = 0;
+  // Cached text width for TextBlock::measured_font, or -1 if not measured.
+  int32_t measured_width = -1;
   TextBlock* block = nullptr;
   TextFragmentContent* content = nullptr;
 };
@@ -141,19 +141,21 @@ bool TextSelection::IsSelected() const { return start.block ? true : false; }
 void TextSelection::RemoveContent() {
   if (!IsSelected()) return;
   style_edit->BeginLockScrollbars();
+  size_t start_gofs = start.GetGlobalOffset(style_edit);
+  size_t removed_length = 0;
   if (start.block == stop.block) {
+    removed_length = stop.ofs - start.ofs;
     if (!style_edit->undo_stack.applying) {
-      style_edit->undo_stack.Commit(
-          style_edit, start.GetGlobalOffset(style_edit), stop.ofs - start.ofs,
-          start.block->str.c_str() + start.ofs, false);
+      style_edit->undo_stack.Commit(style_edit, start_gofs, removed_length,
+                                    start.block->str.c_str() + start.ofs,
+                                    false);
     }
-    start.block->RemoveContent(start.ofs, stop.ofs - start.ofs);
+    start.block->RemoveContent(start.ofs, removed_length);
   } else {
     // Remove text in first block.
     util::StringBuilder commit_string;
-    size_t start_gofs = 0;
+    removed_length = start.block->str_len - start.ofs;
     if (!style_edit->undo_stack.applying) {
-      start_gofs = start.GetGlobalOffset(style_edit);
       commit_string.Append(start.block->str.c_str() + start.ofs,
                            start.block->str_len - start.ofs);
     }
@@ -162,6 +164,7 @@ void TextSelection::RemoveContent() {
     // Remove text in all block in between start and stop.
     TextBlock* block = start.block->GetNext();
     while (block != stop.block) {
+      removed_length += block->str_len;
       if (!style_edit->undo_stack.applying) {
         commit_string.Append(block->str, block->str_len);
       }
@@ -172,6 +175,7 @@ void TextSelection::RemoveContent() {
     }
 
     // Remove text in last block.
+    removed_length += stop.ofs;
     if (!style_edit->undo_stack.applying) {
       commit_string.Append(stop.block->str, stop.ofs);
       style_edit->undo_stack.Commit(style_edit, start_gofs,
@@ -182,6 +186,7 @@ void TextSelection::RemoveContent() {
   }
   stop.block->Merge();
   start.block->Merge();
+  style_edit->RecordChange(start_gofs, removed_length, 0);
   style_edit->caret.Place(start.block, start.ofs);
   style_edit->caret.UpdateWantedX();
   SelectNothing();
@@ -21,6 +21,10 @@ namespace text {
 // TODO(benvanik): make a runtime per-textbox option.
 const bool kShowWhitespace = false;
 
+// Above this ypos_origin the blocks are moved back to 0, long before their
+// positions overflow.
+const int32_t kMaxYposOrigin = 1 << 30;
+
 TextView::TextView() {
   caret.style_edit = this;
   selection.style_edit = this;
@@ -63,9 +67,84 @@ void TextView::SetFont(const FontDescription& new_font_desc) {
   Reformat(true);
 }
 
+void TextView::set_styler(TextStyler* new_styler) {
+  styler = new_styler;
+  for (TextBlock* block = blocks.GetFirst(); block; block = block->GetNext()) {
+    block->style_runs.clear();
+    block->style_dirty = true;
+    block->Invalidate();
+  }
+  styles_dirty = true;
+  first_style_dirty_block = nullptr;
+}
+
+void TextView::UpdateStyles(TextBlock* last_block) {
+  if (!styler || !styles_dirty) {
+    return;
+  }
+  TextBlock* block = first_style_dirty_block;
+  if (!block) {
+    block = blocks.GetFirst();
+  } else if (last_block && block->ypos > last_block->ypos) {
+    // Everything up to last_block is already styled.
+    return;
+  }
+  uint32_t state = block && block->GetPrev() ? block->GetPrev()->style_end_state
+                                             : 0;
+  for (; block; block = block->GetNext()) {
+    if (block->style_dirty || block->style_start_state != state) {
+      block->style_runs.clear();
+      block->style_start_state = state;
+      block->style_end_state = styler->StyleBlock(
+          block->str.c_str(), block->str_len, state, &block->style_runs);
+      block->style_dirty = false;
+      block->Invalidate();
+    }
+    state = block->style_end_state;
+    if (block == last_block) {
+      block = block->GetNext();
+      break;
+    }
+  }
+  // If we stopped early the remaining blocks might still need styling.
+  styles_dirty = block != nullptr;
+  first_style_dirty_block = block;
+}
+
+void TextView::InvalidateStyle(TextBlock* block) {
+  if (!styles_dirty) {
+    styles_dirty = true;
+    first_style_dirty_block = block;
+    return;
+  }
+  if (!first_style_dirty_block || first_style_dirty_block == block ||
+      !block->GetNext()) {
+    return;
+  }
+  // Walk outwards from block until we find the current first dirty block, so
+  // that edits near it (the common case) are cheap.
+  TextBlock* next = block->GetNext();
+  TextBlock* prev = block->GetPrev();
+  while (next || prev) {
+    if (next == first_style_dirty_block) {
+      first_style_dirty_block = block;
+      return;
+    }
+    if (prev == first_style_dirty_block) {
+      return;
+    }
+    next = next ? next->GetNext() : nullptr;
+    prev = prev ? prev->GetPrev() : nullptr;
+  }
+  first_style_dirty_block = nullptr;
+}
+
 void TextView::Clear(bool init_new) {
   undo_stack.Clear(true, true);
   selection.SelectNothing();
+  log_pending_.clear();
+  log_block_count_ = 0;
+  RecordReplaceAll();
 
   if (init_new && blocks.GetFirst() && empty()) {
     return;
@@ -75,6 +154,7 @@ void TextView::Clear(bool init_new) {
     block->Invalidate();
   }
   blocks.DeleteAll();
+  ypos_origin = 0;
 
   if (init_new) {
     blocks.AddLast(new TextBlock(this));
@@ -166,6 +246,7 @@ bool TextView::GetSizeAffectsLayout() const {
 
 void TextView::Reformat(bool update_fragments) {
   int ypos = 0;
+  ypos_origin = 0;
   BeginLockScrollbars();
   TextBlock* block = blocks.GetFirst();
   while (block) {
@@ -199,27 +280,41 @@ int32_t TextView::GetContentHeight() const { return content_height; }
 void TextView::Paint(const Rect& rect, const FontDescription& font_desc,
                      const Color& text_color) {
   TextProps props(font_desc, text_color);
+  const int32_t translate_y = -scroll_y - ypos_origin;
 
   // Find the first visible block.
   TextBlock* first_visible_block = blocks.GetFirst();
   while (first_visible_block) {
-    if (first_visible_block->ypos + first_visible_block->height - scroll_y >=
+    if (first_visible_block->ypos + first_visible_block->height +
+            translate_y >=
         0) {
       break;
     }
     first_visible_block = first_visible_block->GetNext();
   }
 
+  // Style the blocks up to the last visible one. Blocks below are styled when
+  // scrolled into view.
+  if (styler && styles_dirty) {
+    TextBlock* last_visible_block = first_visible_block;
+    while (last_visible_block && last_visible_block->GetNext() &&
+           last_visible_block->GetNext()->ypos + translate_y <=
+               rect.y + rect.h) {
+      last_visible_block = last_visible_block->GetNext();
+    }
+    UpdateStyles(last_visible_block);
+  }
+
   // Get the selection region for all visible blocks.
   util::RectRegion bg_region;
   util::RectRegion fg_region;
   if (selection.IsSelected()) {
     TextBlock* block = first_visible_block;
     while (block) {
-      if (block->ypos - scroll_y > rect.y + rect.h) {
+      if (block->ypos + translate_y > rect.y + rect.h) {
         break;
       }
-      block->BuildSelectionRegion(-scroll_x, -scroll_y, &props, &bg_region,
+      block->BuildSelectionRegion(-scroll_x, translate_y, &props, &bg_region,
                                   &fg_region);
       block = block->GetNext();
     }
@@ -233,10 +328,10 @@ void TextView::Paint(const Rect& rect, const FontDescription& font_desc,
   // Paint the content.
   TextBlock* block = first_visible_block;
   while (block) {
-    if (block->ypos - scroll_y > rect.y + rect.h) {
+    if (block->ypos + translate_y > rect.y + rect.h) {
       break;
     }
-    block->Paint(-scroll_x, -scroll_y, &props);
+    block->Paint(-scroll_x, translate_y, &props);
     block = block->GetNext();
   }
 
@@ -287,11 +382,13 @@ void TextView::InsertText(const char* text, size_t len, bool after_last,
 
   size_t len_inserted =
       caret.pos.block->InsertText(caret.pos.ofs, text, len, true);
+  size_t gofs = caret.global_offset();
   if (clear_undo_redo) {
     undo_stack.Clear(true, true);
   } else {
-    undo_stack.Commit(this, caret.global_offset(), len_inserted, text, true);
+    undo_stack.Commit(this, gofs, len_inserted, text, true);
   }
+  RecordChange(gofs, 0, len_inserted);
 
   caret.Place(caret.pos.block, caret.pos.ofs + len, false);
   caret.UpdatePos();
@@ -299,6 +396,7 @@ void TextView::InsertText(const char* text, size_t len, bool after_last,
 }
 
 TextBlock* TextView::FindBlock(int32_t y) const {
+  y += ypos_origin;
   TextBlock* block = blocks.GetFirst();
   while (block) {
     if (y < block->ypos + block->height) {
@@ -340,11 +438,13 @@ bool TextView::KeyDown(int key, SpecialKey special_key,
     caret.Move(true, any(modifierkeys & ModifierKeys::kCtrl));
   } else if (special_key == SpecialKey::kUp) {
     handled =
-        caret.Place(Point(caret.wanted_x, old_caret_pos.block->ypos +
+        caret.Place(Point(caret.wanted_x, old_caret_pos.block->ypos -
+                                              ypos_origin +
                                               old_caret_elm->line_ypos - 1));
   } else if (special_key == SpecialKey::kDown) {
     handled = caret.Place(Point(
-        caret.wanted_x, old_caret_pos.block->ypos + old_caret_elm->line_ypos +
+        caret.wanted_x, old_caret_pos.block->ypos - ypos_origin +
+                            old_caret_elm->line_ypos +
                             old_caret_elm->line_height + 1));
   } else if (special_key == SpecialKey::kPageUp) {
     caret.Place(Point(caret.wanted_x, caret.y - layout_height));
@@ -357,7 +457,8 @@ bool TextView::KeyDown(int key, SpecialKey special_key,
   } else if (special_key == SpecialKey::kEnd &&
              any(modifierkeys & ModifierKeys::kCtrl)) {
     caret.Place(
-        Point(32000, blocks.GetLast()->ypos + blocks.GetLast()->height));
+        Point(32000, blocks.GetLast()->ypos - ypos_origin +
+                         blocks.GetLast()->height));
   } else if (special_key == SpecialKey::kHome) {
     caret.Place(Point(0, caret.y));
   } else if (special_key == SpecialKey::kEnd) {
@@ -404,7 +505,7 @@ bool TextView::KeyDown(int key, SpecialKey special_key,
 
   // Hooks.
   if (!move_caret && handled) {
-    listener->OnChange();
+    NotifyChange();
   }
   if (special_key == SpecialKey::kEnter &&
       !any(modifierkeys & ModifierKeys::kCtrl)) {
@@ -435,28 +536,28 @@ void TextView::Paste() {
     auto text = util::Clipboard::GetText();
     InsertText(text, text.size());
     ScrollIfNeeded(true, true);
-    listener->OnChange();
+    NotifyChange();
   }
 }
 
 void TextView::Delete() {
   if (selection.IsSelected()) {
     selection.RemoveContent();
-    listener->OnChange();
+    NotifyChange();
   }
 }
 
 void TextView::Undo() {
   if (CanUndo()) {
     undo_stack.Undo(this);
-    listener->OnChange();
+    NotifyChange();
   }
 }
 
 void TextView::Redo() {
   if (CanRedo()) {
     undo_stack.Redo(this);
-    listener->OnChange();
+    NotifyChange();
   }
 }
 
@@ -483,7 +584,8 @@ bool TextView::MouseDown(const Point& point, int button, int clicks,
 
       if (caret.pos.block) {
         mousedown_fragment = caret.pos.block->FindFragment(
-            mousedown_point.x, mousedown_point.y - caret.pos.block->ypos);
+            mousedown_point.x,
+            mousedown_point.y + ypos_origin - caret.pos.block->ypos);
       }
     }
     caret.ResetBlink();
@@ -505,7 +607,8 @@ bool TextView::MouseUp(const Point& point, int button,
   select_state = 0;
   if (caret.pos.block && !Element::cancel_click) {
     TextFragment* fragment = caret.pos.block->FindFragment(
-        point.x + scroll_x, point.y + scroll_y - caret.pos.block->ypos);
+        point.x + scroll_x,
+        point.y + scroll_y + ypos_origin - caret.pos.block->ypos);
     if (fragment && fragment == mousedown_fragment) {
       fragment->Click(button, modifierkeys);
     }
@@ -567,6 +670,7 @@ void TextView::set_text(const char* text, size_t text_len, CaretPosition pos) {
 
   Clear(true);
   blocks.GetFirst()->InsertText(0, text, text_len, true);
+  log_block_count_ = 0;
 
   caret.Place(blocks.GetFirst(), 0);
   caret.UpdateWantedX();
@@ -576,13 +680,81 @@ void TextView::set_text(const char* text, size_t text_len, CaretPosition pos) {
     caret.Place(blocks.GetLast(), blocks.GetLast()->str_len);
   }
 
-  listener->OnChange();
+  NotifyChange();
 }
 
 std::string TextView::text() {
-  TextSelection tmp_selection(this);
-  tmp_selection.SelectAll();
-  return tmp_selection.text();
+  FlushLog();
+  std::string result;
+  result.reserve(text_length());
+  VisitText([&result](const char* str, size_t len) {
+    result.append(str, len);
+    return true;
+  });
+  return result;
+}
+
+size_t TextView::text_length() const {
+  size_t len = 0;
+  for (TextBlock* block = blocks.GetFirst(); block; block = block->GetNext()) {
+    len += block->str_len;
+  }
+  return len;
+}
+
+std::string TextView::GetText(size_t offset, size_t len) const {
+  std::string result;
+  VisitText(offset, len, [&result](const char* str, size_t span_len) {
+    result.append(str, span_len);
+    return true;
+  });
+  return result;
+}
+
+void TextView::RecordChange(size_t offset, size_t removed_length,
+                            size_t inserted_length) {
+  // The log bookkeeping only follows log appends.
+  log_block_count_ = 0;
+  MergeChange(offset, removed_length, inserted_length);
+}
+
+void TextView::MergeChange(size_t offset, size_t removed_length,
+                           size_t inserted_length) {
+  if (!has_pending_change_) {
+    has_pending_change_ = true;
+    pending_change_.offset = offset;
+    pending_change_.removed_length = removed_length;
+    pending_change_.inserted_length = inserted_length;
+    pending_change_.replaced_all = false;
+    return;
+  }
+  if (pending_change_.replaced_all) {
+    return;
+  }
+  // Grow the pending range to cover the new edit. Offsets of the new edit are
+  // in the text after the pending change, so text after the pending inserted
+  // range maps back to the original text shifted by the length difference.
+  TextChangeRange& change = pending_change_;
+  size_t start = std::min(change.offset, offset);
+  size_t old_end = change.offset + change.inserted_length;
+  size_t new_end = std::max(old_end, offset + removed_length);
+  change.removed_length =
+      change.offset + change.removed_length + (new_end - old_end) - start;
+  change.inserted_length = new_end + inserted_length - removed_length - start;
+  change.offset = start;
+}
+
+void TextView::RecordReplaceAll() {
+  has_pending_change_ = true;
+  pending_change_ = TextChangeRange();
+  pending_change_.replaced_all = true;
+}
+
+void TextView::NotifyChange() {
+  last_change_ = has_pending_change_ ? pending_change_ : TextChangeRange();
+  last_change_.sequence = ++change_sequence_;
+  has_pending_change_ = false;
+  listener->OnChange();
 }
 
 bool TextView::empty() const {
@@ -614,6 +786,151 @@ void TextView::set_read_only(bool new_read_only) {
   packed.read_only = new_read_only;
 }
 
+void TextView::set_log_mode(bool log_mode) {
+  packed.log_mode = log_mode;
+  if (log_mode) {
+    packed.read_only = 1;
+    undo_stack.Clear(true, true);
+  } else {
+    FlushLog();
+  }
+}
+
+void TextView::AppendLog(const char* text, size_t len) {
+  if (!packed.log_mode) {
+    AppendText(text, len);
+    return;
+  }
+  if (len == std::string::npos) {
+    len = strlen(text);
+  }
+  if (!len) {
+    return;
+  }
+  if (log_pending_.empty() && listener) {
+    // Make sure we get processed and painted.
+    listener->Invalidate(Rect(0, 0, layout_width, layout_height));
+  }
+  log_pending_.append(text, len);
+}
+
+bool TextView::FlushLog() {
+  if (log_pending_.empty()) {
+    return false;
+  }
+  if (!log_block_count_) {
+    log_block_count_ = blocks.CountLinks();
+    log_length_ = text_length();
+  }
+
+  // Stay at the bottom if we were there, so new lines are shown.
+  const bool pinned = scroll_y >= content_height - layout_height;
+
+  BeginLockScrollbars();
+  const char* text = log_pending_.c_str();
+  const size_t len = log_pending_.size();
+  MergeChange(log_length_, 0, len);
+  log_length_ += len;
+  size_t ofs = 0;
+  while (ofs < len) {
+    size_t line_end = ofs;
+    while (line_end < len && !util::is_linebreak(text[line_end])) {
+      ++line_end;
+    }
+    if (line_end < len) {
+      if (text[line_end] == '\r' && line_end + 1 < len &&
+          text[line_end + 1] == '\n') {
+        ++line_end;
+      }
+      ++line_end;
+    }
+    // Continue the last line unless it's already ended.
+    TextBlock* block = blocks.GetLast();
+    if (block->str_len && util::is_linebreak(block->str[block->str_len - 1])) {
+      block = new TextBlock(this);
+      blocks.AddLast(block);
+      ++log_block_count_;
+    }
+    block->str.append(text + ofs, line_end - ofs);
+    block->str_len = block->str.size();
+    block->InvalidateStyle();
+    // This is the last block so there's nothing to propagate the height to.
+    block->Layout(true, false);
+    ofs = line_end;
+  }
+  log_pending_.clear();
+  // The append and the lines dropped from the front are notified as separate
+  // changes, as a range covering both would span all the lines kept.
+  if (listener) {
+    NotifyChange();
+  }
+  DropLogLines();
+  EndLockScrollbars();
+
+  if (pinned) {
+    SetScrollPos(scroll_x, content_height - layout_height);
+  }
+  if (listener && has_pending_change_) {
+    NotifyChange();
+  }
+  return true;
+}
+
+void TextView::DropLogLines() {
+  if (!log_max_lines_ || log_block_count_ <= log_max_lines_) {
+    return;
+  }
+  size_t removed_length = 0;
+  while (log_block_count_ > log_max_lines_ && blocks.GetFirst()->GetNext()) {
+    TextBlock* block = blocks.GetFirst();
+    removed_length += block->str_len;
+    // Nothing may refer to the dropped block.
+    if (selection.start.block == block || selection.stop.block == block) {
+      selection.SelectNothing();
+    }
+    if (caret.pos.block == block) {
+      caret.pos.Set(block->GetNext(), 0);
+    }
+    if (mousedown_fragment && mousedown_fragment->block == block) {
+      mousedown_fragment = nullptr;
+    }
+    blocks.Delete(block);
+    --log_block_count_;
+  }
+  MergeChange(0, removed_length, 0);
+  log_length_ -= removed_length;
+
+  // Move the origin down to the new first block instead of moving all the
+  // remaining blocks up, and the scroll position with it so the view doesn't
+  // jump.
+  int32_t dy = blocks.GetFirst()->ypos - ypos_origin;
+  ypos_origin = blocks.GetFirst()->ypos;
+  content_height =
+      blocks.GetLast()->ypos - ypos_origin + blocks.GetLast()->height;
+  // The widest line might have been dropped.
+  packed.calculate_content_width_needed = 1;
+  scroll_y = std::max(scroll_y - dy, 0);
+
+  // Positions keep growing as lines are appended and dropped, so move the
+  // blocks back up once in a while before they overflow.
+  if (ypos_origin > kMaxYposOrigin) {
+    for (TextBlock* block = blocks.GetFirst(); block;
+         block = block->GetNext()) {
+      block->ypos -= ypos_origin;
+      for (TextFragment* fragment = block->fragments.GetFirst(); fragment;
+           fragment = fragment->GetNext()) {
+        fragment->UpdateContentPos();
+      }
+    }
+    ypos_origin = 0;
+  }
+  caret.UpdatePos();
+  if (listener) {
+    listener->Scroll(0, dy);
+    listener->Invalidate(Rect(0, 0, layout_width, layout_height));
+  }
+}
+
 void TextView::set_selection(bool new_selection) {
   packed.selection_on = new_selection;
 }
@@ -57,6 +57,37 @@ class TextViewListener {
   virtual void OnBreak() {}
 };
 
+// Splits the text of a TextView into colored runs, f.ex for syntax
+// highlighting. Blocks are only tokenized again when their text has changed or
+// when the state they start with has changed (f.ex when a multiline comment is
+// opened in an earlier block), so the state change propagates forward only
+// until a block ends in the same state as before.
+class TextStyler {
+ public:
+  virtual ~TextStyler() = default;
+
+  // Tokenizes the text of one block (including its line break, if any).
+  // start_state is the state returned for the previous block, or 0 for the
+  // first block. Appends runs sorted by offset to out_runs, and text not
+  // covered by any run is drawn in the default color.
+  // Returns the state at the end of the block.
+  virtual uint32_t StyleBlock(const char* text, size_t len,
+                              uint32_t start_state,
+                              std::vector<TextStyleRun>* out_runs) = 0;
+};
+
+// The range of the text affected by edits, in bytes. removed_length bytes at
+// offset were replaced by the inserted_length bytes now found at offset.
+struct TextChangeRange {
+  size_t offset = 0;
+  size_t removed_length = 0;
+  size_t inserted_length = 0;
+  // Set if the whole text was replaced, in which case the range is unused.
+  bool replaced_all = false;
+  // Incremented for each TextViewListener::OnChange.
+  uint32_t sequence = 0;
+};
+
 // Edits and formats TextFragment's.
 class TextView {
  public:
@@ -68,6 +99,16 @@ class TextView {
 
   void SetFont(const FontDescription& new_font_desc);
 
+  // Sets the styler used to color the text, or nullptr for none.
+  // Does not take ownership.
+  void set_styler(TextStyler* new_styler);
+  // Updates the style runs of all blocks up to and including last_block (or
+  // all blocks if nullptr) that need it. Called automatically when painting.
+  void UpdateStyles(TextBlock* last_block = nullptr);
+  // Marks block as needing its style runs updated. Called by
+  // TextBlock::InvalidateStyle.
+  void InvalidateStyle(TextBlock* block);
+
   void Paint(const Rect& rect, const FontDescription& font_desc,
              const Color& text_color);
   bool KeyDown(int key, SpecialKey special_key, ModifierKeys modifierkeys);
@@ -87,6 +128,45 @@ class TextView {
                 CaretPosition pos = CaretPosition::kBeginning);
   bool empty() const;
 
+  // Calls visitor(const char* str, size_t len) with each block of the text in
+  // order without copying it. Stops if the visitor returns false.
+  template <typename Visitor>
+  void VisitText(Visitor visitor) const {
+    VisitText(0, std::string::npos, visitor);
+  }
+  // Same as VisitText, but only for len bytes of the text starting at offset.
+  template <typename Visitor>
+  void VisitText(size_t offset, size_t len, Visitor visitor) const {
+    for (TextBlock* block = blocks.GetFirst(); block && len;
+         block = block->GetNext()) {
+      if (offset >= block->str_len) {
+        offset -= block->str_len;
+        continue;
+      }
+      size_t span_len = std::min(len, block->str_len - offset);
+      if (!visitor(block->str.c_str() + offset, span_len)) {
+        return;
+      }
+      len -= span_len;
+      offset = 0;
+    }
+  }
+  // Gets the length of the text in bytes.
+  size_t text_length() const;
+  // Gets len bytes of the text starting at offset.
+  std::string GetText(size_t offset, size_t len) const;
+
+  // Gets the range changed by all edits since the previous
+  // TextViewListener::OnChange. Valid during OnChange.
+  const TextChangeRange& last_change() const { return last_change_; }
+  // Records that removed_length bytes at offset were replaced by
+  // inserted_length bytes. Edits between two OnChange calls are merged into
+  // one range covering all of them.
+  void RecordChange(size_t offset, size_t removed_length,
+                    size_t inserted_length);
+  // Records that the whole text was replaced.
+  void RecordReplaceAll();
+
   // Sets the default text alignment and all currently selected blocks, or the
   // block of the current caret position if nothing is selected.
   void set_alignment(TextAlign new_align);
@@ -128,6 +208,30 @@ class TextView {
   }
   void InsertBreak();
 
+  bool log_mode() const { return packed.log_mode; }
+  // Sets if the view is a log, f.ex a console that is appended to in bulk.
+  // Log mode is read only, and appended text skips the undo stack, caret and
+  // selection updates (see AppendLog).
+  void set_log_mode(bool log_mode = true);
+
+  size_t log_max_lines() const { return log_max_lines_; }
+  // Sets the maximum number of lines (blocks) to keep in log mode. Lines
+  // exceeding it are dropped from the front when flushing. Set to 0 for
+  // unlimited (default).
+  void set_log_max_lines(size_t max_lines) { log_max_lines_ = max_lines; }
+
+  // Queues text to append in log mode. It's not laid out until FlushLog, so
+  // any number of lines can be appended per frame at the cost of one layout.
+  // Outside log mode this is the same as AppendText.
+  void AppendLog(const char* text, size_t len = std::string::npos);
+  void AppendLog(const std::string& text) {
+    AppendLog(text.c_str(), text.size());
+  }
+  // Lays out all queued log text, drops lines exceeding log_max_lines and
+  // keeps the view scrolled to the bottom if it was there before.
+  // Returns true if there was anything to flush.
+  bool FlushLog();
+
   TextBlock* FindBlock(int32_t y) const;
 
   void ScrollIfNeeded(bool x = true, bool y = true);
@@ -149,6 +253,12 @@ class TextView {
   TextViewListener* listener = nullptr;
   TextFragmentContentFactory default_content_factory;
   TextFragmentContentFactory* content_factory = &default_content_factory;
+  TextStyler* styler = nullptr;
+  // Whether any block might need its style runs updated.
+  bool styles_dirty = false;
+  // While styles_dirty, the first block that might need its style runs
+  // updated. All blocks before it are up to date. nullptr means the first.
+  TextBlock* first_style_dirty_block = nullptr;
   int32_t layout_width = 0;
   int32_t layout_height = 0;
   int32_t content_width = 0;
@@ -162,6 +272,9 @@ class TextView {
 
   int32_t scroll_x = 0;
   int32_t scroll_y = 0;
+  // The ypos of the first block, which is at the top of the view. Dropping
+  // log lines moves it instead of every remaining block.
+  int32_t ypos_origin = 0;
 
   int8_t select_state = 0;
   Point mousedown_point;
@@ -187,6 +300,7 @@ class TextView {
       uint32_t calculate_content_width_needed : 1;
       // Incremental counter for if UpdateScrollbar should be probhited.
       uint32_t lock_scrollbars_counter : 5;
+      uint32_t log_mode : 1;
     } packed;
     uint32_t packed_init = 0;
   };
@@ -200,6 +314,29 @@ class TextView {
   // Returns true if changing layout_width and layout_height requires
   // relayouting.
   bool GetSizeAffectsLayout() const;
+
+ private:
+  // Drops blocks from the front until there are no more than log_max_lines.
+  void DropLogLines();
+  // Merges an edit into the pending change, without invalidating the log
+  // bookkeeping like RecordChange.
+  void MergeChange(size_t offset, size_t removed_length,
+                   size_t inserted_length);
+  // Publishes the recorded change as last_change and calls
+  // TextViewListener::OnChange.
+  void NotifyChange();
+
+  TextChangeRange pending_change_;
+  bool has_pending_change_ = false;
+  TextChangeRange last_change_;
+  uint32_t change_sequence_ = 0;
+
+  std::string log_pending_;
+  size_t log_max_lines_ = 0;
+  // Number of blocks, maintained in log mode. 0 if it must be counted.
+  size_t log_block_count_ = 0;
+  // Length of the text, valid while log_block_count_ is.
+  size_t log_length_ = 0;
 };
 
 }  // namespace text
@@ -7,8 +7,16 @@
  ******************************************************************************
  */
 
+#include <algorithm>
+#include <cstring>
+
+#include "el/config.h"
 #include "el/text/utf8.h"
 
+#ifdef EL_SIMD_SSE2
+#include <emmintrin.h>
+#endif  // EL_SIMD_SSE2
+
 namespace el {
 namespace text {
 namespace utf8 {
@@ -119,12 +127,124 @@ void move_dec(const char* str, size_t* i) {
 }
 
 size_t count_characters(const char* str, size_t i_max) {
+  if (i_max == size_t(-1)) {
+    i_max = strlen(str);
+  }
   size_t count = 0;
   size_t i = 0;
-  while (i < i_max && decode_next(str, &i, i_max)) count++;
+  while (i < i_max) {
+    size_t run = ascii_run_length(str + i, i_max - i);
+    count += run;
+    i += run;
+    if (i >= i_max || !str[i]) {
+      break;
+    }
+    decode_next(str, &i, i_max);
+    count++;
+  }
+  return count;
+}
+
+size_t ascii_run_length(const char* str, size_t len) {
+  if (len == size_t(-1)) {
+    len = strlen(str);
+  }
+  size_t i = 0;
+#ifdef EL_SIMD_SSE2
+  // Null bytes compare to 0xFF, so they get the high bit set like non-ASCII
+  // bytes.
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 16 <= len; i += 16) {
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + i));
+    if (_mm_movemask_epi8(_mm_or_si128(bytes, _mm_cmpeq_epi8(bytes, zero)))) {
+      break;
+    }
+  }
+#else
+  // Check 8 bytes at a time for high bits and null bytes.
+  const uint64_t kOnes = 0x0101010101010101ull;
+  const uint64_t kHighs = 0x8080808080808080ull;
+  for (; i + 8 <= len; i += 8) {
+    uint64_t bytes;
+    memcpy(&bytes, str + i, 8);
+    if ((bytes | ((bytes - kOnes) & ~bytes)) & kHighs) {
+      break;
+    }
+  }
+#endif  // EL_SIMD_SSE2
+  while (i < len && uint8_t(str[i] - 1) < 0x7F) {
+    ++i;
+  }
+  return i;
+}
+
+namespace {
+
+// Widens count ASCII bytes to UCS4.
+void widen_ascii(const char* src, size_t count, UCS4* dst) {
+  size_t i = 0;
+#ifdef EL_SIMD_SSE2
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 16 <= count; i += 16) {
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+    __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+    __m128i* out = reinterpret_cast<__m128i*>(dst + i);
+    _mm_storeu_si128(out, _mm_unpacklo_epi16(lo, zero));
+    _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(lo, zero));
+    _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(hi, zero));
+    _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(hi, zero));
+  }
+#endif  // EL_SIMD_SSE2
+  for (; i < count; ++i) {
+    dst[i] = uint8_t(src[i]);
+  }
+}
+
+}  // namespace
+
+size_t decode_chunk(const char* str, size_t* i, size_t i_max, UCS4* dst,
+                    size_t dst_size) {
+  if (i_max == size_t(-1)) {
+    i_max = *i + strlen(str + *i);
+  }
+  size_t pos = *i;
+  size_t count = 0;
+  while (count < dst_size && pos < i_max) {
+    size_t run =
+        ascii_run_length(str + pos, std::min(i_max - pos, dst_size - count));
+    widen_ascii(str + pos, run, dst + count);
+    pos += run;
+    count += run;
+    if (count == dst_size || pos >= i_max || !str[pos]) {
+      break;
+    }
+    dst[count++] = decode_next(str, &pos, i_max);
+  }
+  *i = pos;
   return count;
 }
 
+bool validate(const char* str, size_t len) {
+  const char* end = str + len;
+  while (str < end) {
+    str += ascii_run_length(str, end - str);
+    if (str >= end) {
+      break;
+    }
+    if (!*str) {
+      ++str;
+      continue;
+    }
+    const char* start = str;
+    decode(str, end);
+    if (str == start) {
+      return false;
+    }
+  }
+  return true;
+}
+
 }  // namespace utf8
 }  // namespace text
 }  // namespace el
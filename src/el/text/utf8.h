@@ -12,6 +12,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 
 namespace el {
 namespace text {
@@ -19,6 +20,9 @@ namespace utf8 {
 
 typedef uint32_t UCS4;
 
+/** Number of characters callers of decode_chunk typically decode at a time. */
+const size_t kDecodeChunkSize = 64;
+
 /** Decodes UTF-8 from a string input to a UCS4 character.
         @param src buffer in UTF-8 that should be decoded. If the buffer
                represents a valid character, the pointer will be incremented to
@@ -67,6 +71,68 @@ void move_dec(const char* str, size_t* i);
 */
 size_t count_characters(const char* str, size_t i_max);
 
+/** Gets the number of ASCII characters at the start of a string, which
+   decode to themselves. Stops at the first non-ASCII or null byte. Checks many
+   bytes at a time, so len must not exceed the buffer (unless npos).
+        @param str The UTF-8 string.
+        @param len The size of str.
+*/
+size_t ascii_run_length(const char* str, size_t len);
+
+/** Decodes the following characters of a UTF-8 string into a buffer. Same as
+   calling decode_next until the buffer is full, a null character is found or
+   i_max is reached, but ASCII runs are converted many bytes at a time.
+        @param str The UTF-8 string.
+        @param i The index of the current position. This will be increased to
+   the position after the last decoded character.
+        @param i_max The last position (size of str). Must not exceed the
+   buffer (unless npos).
+        @param dst buffer that receives the characters.
+        @param dst_size the number of characters that fit in dst.
+        @return the number of characters decoded, 0 at the end of the string.
+*/
+size_t decode_chunk(const char* str, size_t* i, size_t i_max, UCS4* dst,
+                    size_t dst_size);
+
+/** Checks if a string only consists of valid UTF-8 sequences (as accepted by
+   decode). Null bytes are valid.
+        @param str The UTF-8 string.
+        @param len The size of str.
+*/
+bool validate(const char* str, size_t len);
+
+/** Iterates the characters of a UTF-8 string, decoding them in chunks with
+   decode_chunk. Invalid characters are returned as 0xFFFF. */
+class ChunkDecoder {
+ public:
+  // The length of null terminated strings (npos) is found once here, rather
+  // than by decode_chunk for every chunk.
+  ChunkDecoder(const char* str, size_t len)
+      : m_str(str), m_len(len == size_t(-1) ? strlen(str) : len) {}
+
+  /** Gets the next character. Returns false at the end of the string or at
+     a null character. */
+  bool Next(UCS4* cp) {
+    if (m_pos == m_count) {
+      m_count = decode_chunk(m_str, &m_i, m_len, m_chars, kDecodeChunkSize);
+      m_pos = 0;
+      if (!m_count) {
+        return false;
+      }
+    }
+    *cp = m_chars[m_pos++];
+    return true;
+  }
+
+ private:
+  const char* m_str;
+  size_t m_len;
+  size_t m_i = 0;
+  size_t m_pos = 0;
+  size_t m_count = 0;
+  UCS4 m_chars[kDecodeChunkSize];
+};
+
 }  // namespace utf8
 }  // namespace text
 }  // namespace el
@@ -27,7 +27,7 @@ class TTMsgParam : public util::TypedObject {
  public:
   explicit TTMsgParam(Element* hovered) : m_hovered(hovered) {}
 
-  Element* m_hovered;
+  WeakElementPointer m_hovered;
 };
 
 }  // namespace
@@ -98,7 +98,10 @@ Rect TooltipForm::GetAlignedRect(int x, int y) {
   return Rect(x, y, w, h);
 }
 
-TooltipManager::TooltipManager() { ElementListener::AddGlobalListener(this); }
+TooltipManager::TooltipManager() {
+  ElementListener::AddGlobalListener(this,
+                                     ElementListenerEvents::kInvokeEvent);
+}
 
 TooltipManager::~TooltipManager() {
   ElementListener::RemoveGlobalListener(this);
@@ -107,18 +110,20 @@ TooltipManager::~TooltipManager() {
 bool TooltipManager::OnElementInvokeEvent(Element* element, const Event& ev) {
   if (ev.type == EventType::kPointerMove && !Element::captured_element) {
     Element* tipped_element = GetTippedElement();
-    if (m_last_tipped_element != tipped_element && tipped_element) {
+    Element* last_tipped_element = m_last_tipped_element.get();
+    if (last_tipped_element != tipped_element && tipped_element) {
       auto msg_data = std::make_unique<MessageData>();
       msg_data->v1.set_object(new TTMsgParam(tipped_element));
       PostMessageDelayed(messageShow, std::move(msg_data),
                          tooltip_show_delay_ms);
-    } else if (m_last_tipped_element == tipped_element && tipped_element &&
+    } else if (last_tipped_element == tipped_element && tipped_element &&
                m_tooltip) {
       int x = Element::pointer_move_element_x;
       int y = Element::pointer_move_element_y;
       tipped_element->ConvertToRoot(&x, &y);
       y += tooltip_point_offset_y;
-      Point tt_point = m_tooltip->offset_point();
+      Point tt_point =
+          static_cast<TooltipForm*>(m_tooltip.get())->offset_point();
       if (std::abs(tt_point.x - x) >
               static_cast<int>(tooltip_hide_point_dist) ||
           std::abs(tt_point.y - y) >
@@ -130,7 +135,7 @@ bool TooltipManager::OnElementInvokeEvent(Element* element, const Event& ev) {
       KillToolTip();
       DeleteShowMessages();
     }
-    m_last_tipped_element = tipped_element;
+    m_last_tipped_element.reset(tipped_element);
   } else {
     KillToolTip();
     DeleteShowMessages();
@@ -140,10 +145,10 @@ bool TooltipManager::OnElementInvokeEvent(Element* element, const Event& ev) {
 }
 
 void TooltipManager::KillToolTip() {
-  if (m_tooltip) {
-    m_tooltip->Close();
-    m_tooltip = nullptr;
+  if (auto tooltip = static_cast<TooltipForm*>(m_tooltip.get())) {
+    tooltip->Close();
   }
+  m_tooltip.reset();
 }
 
 void TooltipManager::DeleteShowMessages() {
@@ -165,26 +170,27 @@ void TooltipManager::OnMessageReceived(Message* msg) {
   if (msg->message_id() == messageShow) {
     Element* tipped_element = GetTippedElement();
     TTMsgParam* param = static_cast<TTMsgParam*>(msg->data()->v1.as_object());
-    if (tipped_element == param->m_hovered) {
+    if (tipped_element && tipped_element == param->m_hovered.get()) {
       KillToolTip();
 
-      m_tooltip = new TooltipForm(tipped_element);
+      auto tooltip = new TooltipForm(tipped_element);
+      m_tooltip.reset(tooltip);
 
       int x = Element::pointer_move_element_x;
       int y = Element::pointer_move_element_y;
       Element::hovered_element->ConvertToRoot(&x, &y);
       y += tooltip_point_offset_y;
 
-      m_tooltip->Show(x, y);
+      tooltip->Show(x, y);
 
       auto msg_data = std::make_unique<MessageData>();
-      msg_data->v1.set_object(new TTMsgParam(m_tooltip));
+      msg_data->v1.set_object(new TTMsgParam(tooltip));
       PostMessageDelayed(messageHide, std::move(msg_data),
                          tooltip_show_duration_ms);
     }
   } else if (msg->message_id() == messageHide) {
     TTMsgParam* param = static_cast<TTMsgParam*>(msg->data()->v1.as_object());
-    if (m_tooltip == param->m_hovered) {
+    if (m_tooltip && m_tooltip.get() == param->m_hovered.get()) {
       KillToolTip();
     }
   }
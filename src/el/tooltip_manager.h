@@ -49,8 +49,9 @@ class TooltipManager : private ElementListener, public MessageHandler {
 
   static std::unique_ptr<TooltipManager> tooltip_manager_singleton_;
 
-  TooltipForm* m_tooltip = nullptr;
-  Element* m_last_tipped_element = nullptr;
+  // The currently shown TooltipForm.
+  WeakElementPointer m_tooltip;
+  WeakElementPointer m_last_tipped_element;
 };
 
 }  // namespace el
@@ -63,7 +63,8 @@ class DebugSettingsForm : public elements::Form, public ElementListener {
 
     root->AddChild(this);
 
-    ElementListener::AddGlobalListener(this);
+    ElementListener::AddGlobalListener(this,
+                                       ElementListenerEvents::kInvokeEvent);
   }
 
   ~DebugSettingsForm() { ElementListener::RemoveGlobalListener(this); }
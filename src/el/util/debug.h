@@ -13,6 +13,7 @@
 #include <string>
 
 #include "el/config.h"
+#include "el/util/slab_allocator.h"
 
 #ifdef EL_RUNTIME_DEBUG_INFO
 void TBDebugOut(const char* str, ...);
@@ -61,6 +62,9 @@ class DebugInfo {
   };
   int settings[static_cast<int>(Setting::kSettingCount)] = {0};
 
+  // Statistics of the element allocator (see EL_POOLED_ELEMENTS).
+  SlabAllocator::Stats element_allocator;
+
  private:
   static DebugInfo debug_info_singleton_;
 };
@@ -0,0 +1,53 @@
+/**
+ ******************************************************************************
+ * Elemental Forms : a lightweight user interface framework                   *
+ ******************************************************************************
+ * Copyright 2015 Ben Vanik. All rights reserved. Licensed as BSD 3-clause.   *
+ * Portions ©2011-2015 Emil Segerås: https://github.com/fruxo/turbobadger     *
+ ******************************************************************************
+ */
+
+#include <cassert>
+
+#include "el/util/object.h"
+
+namespace el {
+namespace util {
+
+bool TypeInfo::numbering_dirty = true;
+TypeInfo* TypeInfo::root = nullptr;
+
+TypeInfo::TypeInfo(const char* name, const TypeInfo* parent)
+    : m_name(name), m_parent(parent) {
+  if (parent) {
+    // Only the hierarchy links of the parent change, which aren't visible
+    // through its const interface.
+    auto mutable_parent = const_cast<TypeInfo*>(parent);
+    m_next_sibling = mutable_parent->m_first_child;
+    mutable_parent->m_first_child = this;
+  } else {
+    assert(!root);
+    root = this;
+  }
+  numbering_dirty = true;
+}
+
+// static
+void TypeInfo::Renumber() {
+  numbering_dirty = false;
+  NumberSubtree(root, 0);
+}
+
+// static
+uint32_t TypeInfo::NumberSubtree(TypeInfo* type, uint32_t next_number) {
+  type->m_range_begin = next_number++;
+  for (TypeInfo* child = type->m_first_child; child;
+       child = child->m_next_sibling) {
+    next_number = NumberSubtree(child, next_number);
+  }
+  type->m_range_end = next_number;
+  return next_number;
+}
+
+}  // namespace util
+}  // namespace el
@@ -10,10 +10,54 @@
 #ifndef EL_UTIL_OBJECT_H_
 #define EL_UTIL_OBJECT_H_
 
+#include <cstdint>
+
 namespace el {
 namespace util {
 
-typedef void* tb_type_id_t;
+// Describes a TypedObject class. There is one static instance per class using
+// TBOBJECT_SUBCLASS.
+// Types are numbered in pre-order of the class hierarchy, so that all subtypes
+// of a type have numbers in [range_begin, range_end) of that type. That makes
+// IsA a single range check no matter how deep the hierarchy is.
+// Numbering is redone lazily whenever a new type has been registered (which
+// happens the first time a type is used), and isn't thread safe.
+class TypeInfo {
+ public:
+  TypeInfo(const char* name, const TypeInfo* parent);
+
+  const char* name() const { return m_name; }
+  const TypeInfo* parent() const { return m_parent; }
+
+  // Returns true if this type is the given type or a subtype of it.
+  bool IsA(const TypeInfo* type) const {
+    if (numbering_dirty) {
+      Renumber();
+    }
+    return m_range_begin >= type->m_range_begin &&
+           m_range_begin < type->m_range_end;
+  }
+
+ private:
+  static void Renumber();
+  // Numbers type and its subtypes starting at next_number and returns the
+  // next free number.
+  static uint32_t NumberSubtree(TypeInfo* type, uint32_t next_number);
+
+  // Set when a type has been registered since the last Renumber.
+  static bool numbering_dirty;
+  // The root of the type hierarchy (TypedObject).
+  static TypeInfo* root;
+
+  const char* m_name;
+  const TypeInfo* m_parent;
+  TypeInfo* m_first_child = nullptr;
+  TypeInfo* m_next_sibling = nullptr;
+  uint32_t m_range_begin = 0;
+  uint32_t m_range_end = 0;
+};
+
+typedef const TypeInfo* tb_type_id_t;
 
 // Implements custom RTTI so we can get type safe casts, and the class name at
 // runtime.
@@ -23,16 +67,24 @@ class TypedObject {
  public:
   virtual ~TypedObject() = default;
 
+  // Returns the type info of this class.
+  static const TypeInfo* GetStaticTypeInfo() {
+    static const TypeInfo type_info("TypedObject", nullptr);
+    return &type_info;
+  }
+
   // A static template method that returns a unique id for each type.
   template <class T>
   static tb_type_id_t GetTypeId() {
-    static char type_id;
-    return &type_id;
+    return T::GetStaticTypeInfo();
   }
 
+  // Returns the type info of the dynamic type of this object.
+  virtual const TypeInfo* GetTypeInfo() const { return GetStaticTypeInfo(); }
+
   // Returns true if the class or the base class matches the type id.
-  virtual bool IsOfTypeId(const tb_type_id_t type_id) const {
-    return type_id == GetTypeId<TypedObject>();
+  bool IsOfTypeId(const tb_type_id_t type_id) const {
+    return GetTypeInfo()->IsA(type_id);
   }
 
   // Returns this object as the given type or nullptr if it's not that type.
@@ -48,7 +100,7 @@ class TypedObject {
   }
 
   // Gets the classname of the object.
-  virtual const char* GetTypeName() const { return "TypedObject"; }
+  const char* GetTypeName() const { return GetTypeInfo()->name(); }
 };
 
 // Returns the given object as the given type, or nullptr if it's not that type
@@ -66,12 +118,14 @@ const T* SafeCast(const TypedObject* obj) {
 }
 
 // Implements the methods for safe typecasting without requiring RTTI.
-#define TBOBJECT_SUBCLASS(clazz, baseclazz)                              \
-  const char* GetTypeName() const override { return #clazz; }            \
-  bool IsOfTypeId(const el::util::tb_type_id_t type_id) const override { \
-    return el::util::TypedObject::GetTypeId<clazz>() == type_id          \
-               ? true                                                    \
-               : baseclazz::IsOfTypeId(type_id);                         \
+#define TBOBJECT_SUBCLASS(clazz, baseclazz)                \
+  static const el::util::TypeInfo* GetStaticTypeInfo() {   \
+    static const el::util::TypeInfo type_info(             \
+        #clazz, baseclazz::GetStaticTypeInfo());           \
+    return &type_info;                                     \
+  }                                                        \
+  const el::util::TypeInfo* GetTypeInfo() const override { \
+    return GetStaticTypeInfo();                            \
   }
 
 }  // namespace util
@@ -0,0 +1,58 @@
+/**
+ ******************************************************************************
+ * Elemental Forms : a lightweight user interface framework                   *
+ ******************************************************************************
+ * Copyright 2015 Ben Vanik. All rights reserved. Licensed as BSD 3-clause.   *
+ * Portions ©2011-2015 Emil Segerås: https://github.com/fruxo/turbobadger     *
+ ******************************************************************************
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "el/util/parallel.h"
+
+namespace el {
+namespace util {
+
+size_t GetParallelWorkerCount() {
+  static const size_t worker_count =
+      std::max(1u, std::thread::hardware_concurrency());
+  return worker_count;
+}
+
+void ParallelFor(size_t count, const std::function<void(size_t)>& fn,
+                 size_t min_parallel) {
+  size_t worker_count = std::min(GetParallelWorkerCount(), count);
+  if (count < min_parallel || worker_count <= 1) {
+    for (size_t i = 0; i < count; ++i) {
+      fn(i);
+    }
+    return;
+  }
+
+  // Workers pull indices from a shared counter so that uneven work items
+  // (f.ex images of very different size) balance out. The calling thread
+  // participates as one of the workers.
+  std::atomic<size_t> next_index(0);
+  auto worker = [&]() {
+    size_t i;
+    while ((i = next_index.fetch_add(1)) < count) {
+      fn(i);
+    }
+  };
+  std::vector<std::thread> threads;
+  threads.reserve(worker_count - 1);
+  for (size_t i = 0; i < worker_count - 1; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+}  // namespace util
+}  // namespace el
@@ -0,0 +1,32 @@
+/**
+ ******************************************************************************
+ * Elemental Forms : a lightweight user interface framework                   *
+ ******************************************************************************
+ * Copyright 2015 Ben Vanik. All rights reserved. Licensed as BSD 3-clause.   *
+ * Portions ©2011-2015 Emil Segerås: https://github.com/fruxo/turbobadger     *
+ ******************************************************************************
+ */
+
+#ifndef EL_UTIL_PARALLEL_H_
+#define EL_UTIL_PARALLEL_H_
+
+#include <cstddef>
+#include <functional>
+
+namespace el {
+namespace util {
+
+// Returns the number of worker threads ParallelFor may use.
+size_t GetParallelWorkerCount();
+
+// Invokes fn(i) for every i in [0, count) across worker threads and returns
+// once all invocations have completed. Invocation order is undefined.
+// Work is run inline on the calling thread when count is below min_parallel or
+// only a single worker is available. fn must be safe to call concurrently.
+void ParallelFor(size_t count, const std::function<void(size_t)>& fn,
+                 size_t min_parallel = 2);
+
+}  // namespace util
+}  // namespace el
+
+#endif  // EL_UTIL_PARALLEL_H_
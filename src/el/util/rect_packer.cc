@@ -0,0 +1,142 @@
+/**
+ ******************************************************************************
+ * Elemental Forms : a lightweight user interface framework                   *
+ ******************************************************************************
+ * Copyright 2015 Ben Vanik. All rights reserved. Licensed as BSD 3-clause.   *
+ * Portions ©2011-2015 Emil Segerås: https://github.com/fruxo/turbobadger     *
+ ******************************************************************************
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <climits>
+
+#include "el/util/rect_packer.h"
+
+namespace el {
+namespace util {
+
+namespace {
+inline bool IsContainedIn(const Rect& a, const Rect& b) {
+  return a.x >= b.x && a.y >= b.y && a.x + a.w <= b.x + b.w &&
+         a.y + a.h <= b.y + b.h;
+}
+}  // namespace
+
+MaxRectsPacker::MaxRectsPacker(int width, int height)
+    : width_(width), height_(height) {
+  free_rects_.emplace_back(0, 0, width, height);
+}
+
+bool MaxRectsPacker::HasSpace(int needed_w, int needed_h) const {
+  for (auto& free_rect : free_rects_) {
+    if (needed_w <= free_rect.w && needed_h <= free_rect.h) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool MaxRectsPacker::Insert(int needed_w, int needed_h, Rect* out_rect) {
+  if (needed_w <= 0 || needed_h <= 0) {
+    return false;
+  }
+
+  // Find the free rect leaving the shortest leftover side (ties are broken by
+  // the longest leftover side).
+  int best_short_side = INT_MAX;
+  int best_long_side = INT_MAX;
+  Rect best_rect;
+  for (auto& free_rect : free_rects_) {
+    if (needed_w > free_rect.w || needed_h > free_rect.h) {
+      continue;
+    }
+    int leftover_w = free_rect.w - needed_w;
+    int leftover_h = free_rect.h - needed_h;
+    int short_side = std::min(leftover_w, leftover_h);
+    int long_side = std::max(leftover_w, leftover_h);
+    if (short_side < best_short_side ||
+        (short_side == best_short_side && long_side < best_long_side)) {
+      best_rect.reset(free_rect.x, free_rect.y, needed_w, needed_h);
+      best_short_side = short_side;
+      best_long_side = long_side;
+    }
+  }
+  if (best_rect.empty()) {
+    return false;
+  }
+
+  // Split all free rects overlapping the new rect. New parts are appended, so
+  // only the rects that existed before are visited.
+  size_t free_rect_count = free_rects_.size();
+  for (size_t i = 0; i < free_rect_count;) {
+    if (SplitFreeRect(free_rects_[i], best_rect)) {
+      free_rects_.erase(free_rects_.begin() + i);
+      --free_rect_count;
+    } else {
+      ++i;
+    }
+  }
+  PruneFreeRects();
+
+  ++used_count_;
+  *out_rect = best_rect;
+  return true;
+}
+
+void MaxRectsPacker::Free(const Rect& rect) {
+  assert(used_count_ > 0);
+  if (--used_count_ == 0) {
+    // Everything is free again, so start over without any fragmentation.
+    free_rects_.clear();
+    free_rects_.emplace_back(0, 0, width_, height_);
+    return;
+  }
+  // NOTE: The freed rect is not merged with adjacent free space, so frequent
+  // freeing fragments the packer until it's empty again.
+  free_rects_.push_back(rect);
+  PruneFreeRects();
+}
+
+bool MaxRectsPacker::SplitFreeRect(const Rect& free_rect,
+                                   const Rect& used_rect) {
+  if (!free_rect.intersects(used_rect)) {
+    return false;
+  }
+  // Copy as free_rect references an element of free_rects_.
+  Rect rect = free_rect;
+  if (used_rect.x > rect.x) {
+    free_rects_.emplace_back(rect.x, rect.y, used_rect.x - rect.x, rect.h);
+  }
+  if (used_rect.x + used_rect.w < rect.x + rect.w) {
+    int x = used_rect.x + used_rect.w;
+    free_rects_.emplace_back(x, rect.y, rect.x + rect.w - x, rect.h);
+  }
+  if (used_rect.y > rect.y) {
+    free_rects_.emplace_back(rect.x, rect.y, rect.w, used_rect.y - rect.y);
+  }
+  if (used_rect.y + used_rect.h < rect.y + rect.h) {
+    int y = used_rect.y + used_rect.h;
+    free_rects_.emplace_back(rect.x, y, rect.w, rect.y + rect.h - y);
+  }
+  return true;
+}
+
+void MaxRectsPacker::PruneFreeRects() {
+  for (size_t i = 0; i < free_rects_.size(); ++i) {
+    for (size_t j = i + 1; j < free_rects_.size(); ++j) {
+      if (IsContainedIn(free_rects_[i], free_rects_[j])) {
+        free_rects_.erase(free_rects_.begin() + i);
+        --i;
+        break;
+      }
+      if (IsContainedIn(free_rects_[j], free_rects_[i])) {
+        free_rects_.erase(free_rects_.begin() + j);
+        --j;
+      }
+    }
+  }
+}
+
+}  // namespace util
+}  // namespace el
@@ -0,0 +1,62 @@
+/**
+ ******************************************************************************
+ * Elemental Forms : a lightweight user interface framework                   *
+ ******************************************************************************
+ * Copyright 2015 Ben Vanik. All rights reserved. Licensed as BSD 3-clause.   *
+ * Portions ©2011-2015 Emil Segerås: https://github.com/fruxo/turbobadger     *
+ ******************************************************************************
+ */
+
+#ifndef EL_UTIL_RECT_PACKER_H_
+#define EL_UTIL_RECT_PACKER_H_
+
+#include <vector>
+
+#include "el/rect.h"
+
+namespace el {
+namespace util {
+
+// Packs rectangles into a 2D area using the MaxRects algorithm (best short
+// side fit). It keeps a list of maximal free rectangles, which may overlap,
+// and places each new rectangle in the free rectangle it fits most snugly.
+// This wastes much less space than packing into rows when the rectangles have
+// varying heights, especially if they are inserted tallest first.
+class MaxRectsPacker {
+ public:
+  MaxRectsPacker(int width, int height);
+
+  int width() const { return width_; }
+  int height() const { return height_; }
+
+  // Returns true if no allocations are currently live using this packer.
+  bool empty() const { return used_count_ == 0; }
+
+  // Returns true if a rectangle of the given size currently fits.
+  bool HasSpace(int needed_w, int needed_h) const;
+
+  // Allocates a rectangle of the given size.
+  // Returns false if there is not enough room.
+  bool Insert(int needed_w, int needed_h, Rect* out_rect);
+
+  // Frees a rectangle previously returned from Insert so the space is
+  // available for new allocations.
+  void Free(const Rect& rect);
+
+ private:
+  // Splits free_rect around used_rect and adds the remaining parts to the free
+  // list. Returns false if the rects don't overlap.
+  bool SplitFreeRect(const Rect& free_rect, const Rect& used_rect);
+  // Removes all free rects contained within another free rect.
+  void PruneFreeRects();
+
+  int width_;
+  int height_;
+  int used_count_ = 0;
+  std::vector<Rect> free_rects_;
+};
+
+}  // namespace util
+}  // namespace el
+
+#endif  // EL_UTIL_RECT_PACKER_H_
@@ -7,13 +7,26 @@
  ******************************************************************************
  */
 
+#include <algorithm>
 #include <cassert>
+#include <limits>
 
 #include "el/util/rect_region.h"
 
 namespace el {
 namespace util {
 
+namespace {
+// Returns the end of the band starting at rect.
+const Rect* GetBandEnd(const Rect* rect, const Rect* end) {
+  const Rect* band_end = rect;
+  while (band_end != end && band_end->y == rect->y) {
+    ++band_end;
+  }
+  return band_end;
+}
+}  // namespace
+
 RectRegion::RectRegion() = default;
 
 RectRegion::~RectRegion() = default;
@@ -23,124 +36,269 @@ void RectRegion::RemoveRect(size_t index) {
   rects_.erase(rects_.begin() + index);
 }
 
-void RectRegion::RemoveRectFast(size_t index) {
-  assert(index >= 0 && index < rects_.size());
-  if (index != rects_.size() - 1) {
-    rects_[index] = rects_.back();
-  }
-  rects_.pop_back();
-}
+void RectRegion::RemoveRectFast(size_t index) { RemoveRect(index); }
 
 void RectRegion::Clear() { rects_.clear(); }
 
 bool RectRegion::Set(const Rect& rect) {
   rects_.clear();
-  return AddRect(rect, false);
-}
-
-bool RectRegion::AddRect(const Rect& rect, bool coalesce) {
-  if (!rects_.empty() && coalesce) {
-    // If the rect can coalesce with any existing rect,
-    // just replace it with the union of both, doing coalesce
-    // check again recursively.
-    // Searching backwards is most likely to give a hit quicker
-    // in many usage scenarios.
-    for (intptr_t i = rects_.size() - 1; i >= 0; i--) {
-      if (  // Can coalesce vertically
-          (rect.x == rects_[i].x && rect.w == rects_[i].w &&
-           (rect.y == rects_[i].y + rects_[i].h ||
-            rect.y + rect.h == rects_[i].y)) ||  // Can coalesce horizontally
-          (rect.y == rects_[i].y && rect.h == rects_[i].h &&
-           (rect.x == rects_[i].x + rects_[i].w ||
-            rect.x + rect.w == rects_[i].x))) {
-        Rect union_rect = rects_[i].Union(rect);
-        RemoveRectFast(i);
-        return AddRect(union_rect, true);
-      }
-    }
+  if (!rect.empty()) {
+    rects_.push_back(rect);
   }
-
-  rects_.push_back(std::move(rect));
   return true;
 }
 
+bool RectRegion::AddRect(const Rect& rect, bool /*coalesce*/) {
+  return IncludeRect(rect);
+}
+
 bool RectRegion::IncludeRect(const Rect& include_rect) {
-  for (size_t i = 0; i < rects_.size(); ++i) {
-    if (include_rect.intersects(rects_[i])) {
-      // Make a region containing the non intersecting parts and then include
-      // those recursively (they might still intersect some other part of the
-      // region).
-      RectRegion inclusion_region;
-      if (!inclusion_region.AddExcludingRects(include_rect, rects_[i], false)) {
-        return false;
-      }
-      for (int j = 0; j < inclusion_region.rects_.size(); j++) {
-        if (!IncludeRect(inclusion_region.rects_[j])) {
-          return false;
-        }
-      }
-      return true;
-    }
+  if (!include_rect.empty()) {
+    Combine(&include_rect, 1, Operation::kUnion);
   }
-  // Now we know that the rect can be added without overlap.
-  // Add it with coalesce checking to keep the number of rects down.
-  return AddRect(include_rect, true);
+  return true;
 }
 
 bool RectRegion::ExcludeRect(const Rect& exclude_rect) {
-  size_t num_rects_to_check = rects_.size();
-  for (size_t i = 0; i < num_rects_to_check; ++i) {
-    if (rects_[i].intersects(exclude_rect)) {
-      // Remove the existing rectangle we found we intersect
-      // and add the pieces we don't intersect. New rects
-      // will be added at the end of the list, so we can decrease
-      // num_rects_to_check.
-      Rect rect = rects_[i];
-      RemoveRect(i);
-      num_rects_to_check--;
-      i--;
-
-      if (!AddExcludingRects(rect, exclude_rect, true)) {
-        return false;
-      }
-    }
+  if (!exclude_rect.empty()) {
+    Combine(&exclude_rect, 1, Operation::kSubtract);
+  }
+  return true;
+}
+
+bool RectRegion::IntersectRect(const Rect& intersect_rect) {
+  if (intersect_rect.empty()) {
+    rects_.clear();
+  } else {
+    Combine(&intersect_rect, 1, Operation::kIntersect);
   }
   return true;
 }
 
+bool RectRegion::IncludeRegion(const RectRegion& region) {
+  Combine(region.rects_.data(), region.rects_.size(), Operation::kUnion);
+  return true;
+}
+
+bool RectRegion::ExcludeRegion(const RectRegion& region) {
+  Combine(region.rects_.data(), region.rects_.size(), Operation::kSubtract);
+  return true;
+}
+
+bool RectRegion::IntersectRegion(const RectRegion& region) {
+  Combine(region.rects_.data(), region.rects_.size(), Operation::kIntersect);
+  return true;
+}
+
 bool RectRegion::AddExcludingRects(const Rect& rect, const Rect& exclude_rect,
-                                   bool coalesce) {
+                                   bool /*coalesce*/) {
   assert(rect.intersects(exclude_rect));
   Rect remove = exclude_rect.Clip(rect);
 
+  // The pieces are added in band order: above, left and right of, and below
+  // the removed part.
+  Rect pieces[4];
+  size_t piece_count = 0;
   if (remove.y > rect.y) {
-    if (!AddRect(Rect(rect.x, rect.y, rect.w, remove.y - rect.y), coalesce)) {
-      return false;
-    }
+    pieces[piece_count++] = Rect(rect.x, rect.y, rect.w, remove.y - rect.y);
   }
   if (remove.x > rect.x) {
-    if (!AddRect(Rect(rect.x, remove.y, remove.x - rect.x, remove.h),
-                 coalesce)) {
-      return false;
-    }
+    pieces[piece_count++] =
+        Rect(rect.x, remove.y, remove.x - rect.x, remove.h);
   }
   if (remove.x + remove.w < rect.x + rect.w) {
-    if (!AddRect(Rect(remove.x + remove.w, remove.y,
-                      rect.x + rect.w - (remove.x + remove.w), remove.h),
-                 coalesce)) {
-      return false;
-    }
+    pieces[piece_count++] =
+        Rect(remove.x + remove.w, remove.y,
+             rect.x + rect.w - (remove.x + remove.w), remove.h);
   }
   if (remove.y + remove.h < rect.y + rect.h) {
-    if (!AddRect(Rect(rect.x, remove.y + remove.h, rect.w,
-                      rect.y + rect.h - (remove.y + remove.h)),
-                 coalesce)) {
-      return false;
-    }
+    pieces[piece_count++] = Rect(rect.x, remove.y + remove.h, rect.w,
+                                 rect.y + rect.h - (remove.y + remove.h));
   }
+  Combine(pieces, piece_count, Operation::kUnion);
   return true;
 }
 
+void RectRegion::Combine(const Rect* other, size_t other_count,
+                         Operation op) {
+  auto first = rects_.begin();
+  auto last = rects_.end();
+  if (op != Operation::kIntersect && other_count) {
+    // Bands are sorted and don't overlap, so both their tops and bottoms are
+    // increasing.
+    int top = other[0].y;
+    int bottom = other[other_count - 1].y + other[other_count - 1].h;
+    first = std::partition_point(first, last, [top](const Rect& rect) {
+      return rect.y + rect.h < top;
+    });
+    last = std::partition_point(first, last, [bottom](const Rect& rect) {
+      return rect.y <= bottom;
+    });
+  }
+  if (first == rects_.begin() && last == rects_.end()) {
+    CombineBands(rects_.data(), rects_.data() + rects_.size(), other,
+                 other + other_count, op);
+    rects_.swap(combine_rects_);
+    return;
+  }
+  CombineBands(rects_.data() + (first - rects_.begin()),
+               rects_.data() + (last - rects_.begin()), other,
+               other + other_count, op);
+  // Replace the affected bands with the result.
+  size_t index = first - rects_.begin();
+  size_t old_count = last - first;
+  size_t new_count = combine_rects_.size();
+  if (new_count > old_count) {
+    rects_.insert(rects_.begin() + index + old_count, new_count - old_count,
+                  Rect());
+  } else if (new_count < old_count) {
+    rects_.erase(rects_.begin() + index + new_count,
+                 rects_.begin() + index + old_count);
+  }
+  std::copy(combine_rects_.begin(), combine_rects_.end(),
+            rects_.begin() + index);
+}
+
+void RectRegion::CombineBands(const Rect* a, const Rect* a_end, const Rect* b,
+                              const Rect* b_end, Operation op) {
+  combine_rects_.clear();
+
+  // Sweep down through the bands of both regions. Each step covers the rows
+  // until the next band of either region starts or ends, so the spans within
+  // a step are constant.
+  int y = std::numeric_limits<int>::max();
+  if (a != a_end) {
+    y = a->y;
+  }
+  if (b != b_end) {
+    y = std::min(y, b->y);
+  }
+  size_t prev_band = std::numeric_limits<size_t>::max();
+  while (a != a_end || b != b_end) {
+    // Nothing more can come out of intersecting with or subtracting from an
+    // empty remainder.
+    if (a == a_end && op != Operation::kUnion) {
+      break;
+    }
+    if (b == b_end && op == Operation::kIntersect) {
+      break;
+    }
+    const Rect* a_band_end = GetBandEnd(a, a_end);
+    const Rect* b_band_end = GetBandEnd(b, b_end);
+    bool a_active = a != a_end && a->y <= y;
+    bool b_active = b != b_end && b->y <= y;
+    int next_y = std::numeric_limits<int>::max();
+    if (a != a_end) {
+      next_y = std::min(next_y, a_active ? a->y + a->h : a->y);
+    }
+    if (b != b_end) {
+      next_y = std::min(next_y, b_active ? b->y + b->h : b->y);
+    }
+
+    if (a_active || b_active) {
+      size_t band_start = combine_rects_.size();
+      CombineSpans(a_active ? a : nullptr, a_active ? a_band_end : nullptr,
+                   b_active ? b : nullptr, b_active ? b_band_end : nullptr, op,
+                   y, next_y - y);
+      size_t band_size = combine_rects_.size() - band_start;
+      // Merge the band into the previous one if they touch and have the same
+      // spans.
+      bool merged = false;
+      if (band_size && prev_band != std::numeric_limits<size_t>::max() &&
+          band_start - prev_band == band_size) {
+        const Rect& prev = combine_rects_[prev_band];
+        if (prev.y + prev.h == y) {
+          merged = true;
+          for (size_t i = 0; i < band_size; ++i) {
+            const Rect& r1 = combine_rects_[prev_band + i];
+            const Rect& r2 = combine_rects_[band_start + i];
+            if (r1.x != r2.x || r1.w != r2.w) {
+              merged = false;
+              break;
+            }
+          }
+        }
+      }
+      if (merged) {
+        for (size_t i = 0; i < band_size; ++i) {
+          combine_rects_[prev_band + i].h += next_y - y;
+        }
+        combine_rects_.resize(band_start);
+      } else if (band_size) {
+        prev_band = band_start;
+      }
+    }
+
+    y = next_y;
+    if (a != a_end && a->y + a->h <= y) {
+      a = a_band_end;
+    }
+    if (b != b_end && b->y + b->h <= y) {
+      b = b_band_end;
+    }
+  }
+}
+
+void RectRegion::CombineSpans(const Rect* a, const Rect* a_end, const Rect* b,
+                              const Rect* b_end, Operation op, int y, int h) {
+  const size_t band_start = combine_rects_.size();
+  bool in_a = false;
+  bool in_b = false;
+  bool in_result = false;
+  int span_start = 0;
+  // Step through the span edges of both in x order, tracking whether we're
+  // inside each of them.
+  while (a != a_end || b != b_end) {
+    int a_x = std::numeric_limits<int>::max();
+    if (a != a_end) {
+      a_x = in_a ? a->x + a->w : a->x;
+    }
+    int b_x = std::numeric_limits<int>::max();
+    if (b != b_end) {
+      b_x = in_b ? b->x + b->w : b->x;
+    }
+    int x = std::min(a_x, b_x);
+    if (a_x == x) {
+      if (in_a) {
+        ++a;
+      }
+      in_a = !in_a;
+    }
+    if (b_x == x) {
+      if (in_b) {
+        ++b;
+      }
+      in_b = !in_b;
+    }
+    bool inside;
+    switch (op) {
+      case Operation::kUnion:
+        inside = in_a || in_b;
+        break;
+      case Operation::kIntersect:
+        inside = in_a && in_b;
+        break;
+      case Operation::kSubtract:
+        inside = in_a && !in_b;
+        break;
+    }
+    if (inside == in_result) {
+      continue;
+    }
+    in_result = inside;
+    if (inside) {
+      span_start = x;
+    } else if (combine_rects_.size() > band_start &&
+               combine_rects_.back().x + combine_rects_.back().w ==
+                   span_start) {
+      // Touches the previous span (the edges of the operands met here).
+      combine_rects_.back().w = x - combine_rects_.back().x;
+    } else {
+      combine_rects_.push_back(Rect(span_start, y, x - span_start, h));
+    }
+  }
+}
+
 const Rect& RectRegion::operator[](size_t index) const {
   assert(index >= 0 && index < rects_.size());
   return rects_[index];
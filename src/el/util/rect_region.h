@@ -18,6 +18,11 @@ namespace el {
 namespace util {
 
 // Performs calculations on regions represented by a list of rectangles.
+// The rectangles are kept banded: sorted by y and then x, where each band is a
+// row of rectangles sharing the same y and height that neither overlap nor
+// touch, and identical vertically adjacent bands are merged. This allows all
+// boolean operations to be done in one sweep over both operands, in time
+// linear to their number of rectangles.
 class RectRegion {
  public:
   RectRegion();
@@ -26,8 +31,8 @@ class RectRegion {
   // Removes the rect at the given index.
   void RemoveRect(size_t index);
 
-  // Remove the rect at the given index.
-  // This method will change the order of rectangles after index.
+  // Removes the rect at the given index.
+  // Same as RemoveRect, since the rectangles must stay in band order.
   void RemoveRectFast(size_t index);
 
   // Removes all rectangles so the region becomes empty.
@@ -36,30 +41,63 @@ class RectRegion {
   // Sets the region to the given rect.
   bool Set(const Rect& rect);
 
-  // Adds the rect without doing any overlap check.
-  // If coalesce is true, it will coalesce the rectangle with existing
-  // rectangles if possible (until there's nothing more to coalesce it with).
-  bool AddRect(const Rect& rect, bool coalesce);
+  // Adds the rect to the region. coalesce is ignored, as rectangles are always
+  // coalesced to keep the region banded.
+  bool AddRect(const Rect& rect, bool coalesce = true);
 
   // Includes the rect in the region.
   // This will add only the parts that's not already in the region so the
-  // result doesn't contain overlap parts. This assumes there's no overlap in
-  // the region already!
+  // result doesn't contain overlap parts.
   bool IncludeRect(const Rect& include_rect);
 
   // Excludes the rect from the region.
   bool ExcludeRect(const Rect& exclude_rect);
 
+  // Clips the region to the given rect.
+  bool IntersectRect(const Rect& intersect_rect);
+
+  // Includes all of the given region in this region.
+  bool IncludeRegion(const RectRegion& region);
+
+  // Excludes all of the given region from this region.
+  bool ExcludeRegion(const RectRegion& region);
+
+  // Clips this region to the given region.
+  bool IntersectRegion(const RectRegion& region);
+
   // Adds the rectangles that's left of rect after excluding exclude_rect.
+  // coalesce is ignored like for AddRect.
   bool AddExcludingRects(const Rect& rect, const Rect& exclude_rect,
-                         bool coalesce);
+                         bool coalesce = true);
 
   bool empty() const { return rects_.empty(); }
   size_t size() const { return rects_.size(); }
   const Rect& operator[](size_t index) const;
 
  private:
+  enum class Operation {
+    kUnion,
+    kIntersect,
+    kSubtract,
+  };
+
+  // Replaces the region with the result of the operation between the region
+  // and the given banded rectangles.
+  // Union and subtraction only touch the bands overlapping the other
+  // rectangles (and their neighbours, which they might be merged with).
+  void Combine(const Rect* other, size_t other_count, Operation op);
+  // Combines the bands [a, a_end) of the region with the given rectangles and
+  // stores the result in combine_rects_.
+  void CombineBands(const Rect* a, const Rect* a_end, const Rect* b,
+                    const Rect* b_end, Operation op);
+  // Appends the spans of one band resulting from the operation between the
+  // spans [a, a_end) and [b, b_end) to combine_rects_.
+  void CombineSpans(const Rect* a, const Rect* a_end, const Rect* b,
+                    const Rect* b_end, Operation op, int y, int h);
+
   std::vector<Rect> rects_;
+  // Result of the last Combine, kept to reuse its memory.
+  std::vector<Rect> combine_rects_;
 };
 
 }  // namespace util
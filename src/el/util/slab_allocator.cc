@@ -0,0 +1,192 @@
+/**
+ ******************************************************************************
+ * Elemental Forms : a lightweight user interface framework                   *
+ ******************************************************************************
+ * Copyright 2015 Ben Vanik. All rights reserved. Licensed as BSD 3-clause.   *
+ * Portions ©2011-2015 Emil Segerås: https://github.com/fruxo/turbobadger     *
+ ******************************************************************************
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <new>
+
+#include "el/util/slab_allocator.h"
+
+namespace el {
+namespace util {
+
+namespace {
+
+// All blocks are a multiple of this, and blocks are aligned to it.
+const size_t kGranularity = 16;
+// Chunks are sized to hold about this many bytes of blocks.
+const size_t kTargetChunkBytes = 16 * 1024;
+const size_t kMinBlocksPerChunk = 4;
+
+// Precedes every block, so that Free can find the chunk the block lives in.
+// Padded to kGranularity to keep the block aligned.
+struct alignas(kGranularity) BlockHeader {
+  void* chunk;
+  BlockHeader* next_free;
+};
+
+// Size of T rounded up to keep what follows it aligned.
+template <typename T>
+constexpr size_t AlignedSize() {
+  return (sizeof(T) + kGranularity - 1) / kGranularity * kGranularity;
+}
+
+}  // namespace
+
+struct SlabAllocator::Chunk {
+  SizeClass* size_class;
+  BlockHeader* free_blocks;
+  // Next chunk with free blocks in the size class, if this one has any.
+  Chunk* next_free;
+  Chunk* prev_free;
+  size_t live_blocks;
+  bool has_free_blocks() const { return free_blocks != nullptr; }
+};
+
+SlabAllocator::SlabAllocator(size_t max_block_size)
+    : m_max_block_size(max_block_size) {
+  size_t class_count = (max_block_size + kGranularity - 1) / kGranularity;
+  m_size_classes.resize(class_count);
+  for (size_t i = 0; i < class_count; ++i) {
+    auto& size_class = m_size_classes[i];
+    size_class.block_size = (i + 1) * kGranularity;
+    size_t stride = sizeof(BlockHeader) + size_class.block_size;
+    size_class.blocks_per_chunk =
+        std::max(kMinBlocksPerChunk, kTargetChunkBytes / stride);
+    // malloc only guarantees alignment for max_align_t, so over-allocate to
+    // be able to align the blocks.
+    size_class.chunk_bytes = AlignedSize<Chunk>() +
+                             stride * size_class.blocks_per_chunk +
+                             kGranularity;
+  }
+}
+
+SlabAllocator::~SlabAllocator() {
+  // Live blocks are leaked along with their chunks, which is only expected
+  // when the allocator outlives its users.
+  for (auto& size_class : m_size_classes) {
+    for (Chunk* chunk : size_class.chunks) {
+      if (!chunk->live_blocks) {
+        std::free(chunk);
+      }
+    }
+  }
+}
+
+SlabAllocator::Chunk* SlabAllocator::NewChunk(SizeClass* size_class) {
+  size_t stride = sizeof(BlockHeader) + size_class->block_size;
+  auto chunk = static_cast<Chunk*>(std::malloc(size_class->chunk_bytes));
+  if (!chunk) {
+    throw std::bad_alloc();
+  }
+  chunk->size_class = size_class;
+  chunk->free_blocks = nullptr;
+  chunk->live_blocks = 0;
+  uintptr_t first_block =
+      reinterpret_cast<uintptr_t>(chunk) + AlignedSize<Chunk>();
+  first_block = (first_block + kGranularity - 1) & ~(kGranularity - 1);
+  for (size_t i = size_class->blocks_per_chunk; i-- > 0;) {
+    auto block = reinterpret_cast<BlockHeader*>(first_block + i * stride);
+    block->chunk = chunk;
+    block->next_free = chunk->free_blocks;
+    chunk->free_blocks = block;
+  }
+  size_class->chunks.push_back(chunk);
+  chunk->prev_free = nullptr;
+  chunk->next_free = size_class->free_chunks;
+  if (size_class->free_chunks) {
+    size_class->free_chunks->prev_free = chunk;
+  }
+  size_class->free_chunks = chunk;
+  ++m_stats.chunk_count;
+  m_stats.chunk_bytes += size_class->chunk_bytes;
+  return chunk;
+}
+
+void* SlabAllocator::Allocate(size_t size) {
+  ++m_stats.total_allocations;
+  if (size > m_max_block_size || !size) {
+    ++m_stats.oversize_allocations;
+    return ::operator new(size);
+  }
+  SizeClass* size_class = &m_size_classes[(size - 1) / kGranularity];
+  Chunk* chunk = size_class->free_chunks;
+  if (!chunk) {
+    chunk = NewChunk(size_class);
+  }
+  BlockHeader* block = chunk->free_blocks;
+  chunk->free_blocks = block->next_free;
+  ++chunk->live_blocks;
+  if (!chunk->has_free_blocks()) {
+    // Unlink the full chunk (always the first) from the free chunk list.
+    size_class->free_chunks = chunk->next_free;
+    if (chunk->next_free) {
+      chunk->next_free->prev_free = nullptr;
+    }
+  }
+  ++m_stats.live_blocks;
+  return block + 1;
+}
+
+void SlabAllocator::Free(void* ptr, size_t size) {
+  if (!ptr) {
+    return;
+  }
+  if (size > m_max_block_size || !size) {
+    ::operator delete(ptr);
+    return;
+  }
+  BlockHeader* block = static_cast<BlockHeader*>(ptr) - 1;
+  auto chunk = static_cast<Chunk*>(block->chunk);
+  SizeClass* size_class = chunk->size_class;
+  assert(size_class == &m_size_classes[(size - 1) / kGranularity]);
+  if (!chunk->has_free_blocks()) {
+    // The chunk was full, so it goes back on the free chunk list.
+    chunk->prev_free = nullptr;
+    chunk->next_free = size_class->free_chunks;
+    if (size_class->free_chunks) {
+      size_class->free_chunks->prev_free = chunk;
+    }
+    size_class->free_chunks = chunk;
+  }
+  block->next_free = chunk->free_blocks;
+  chunk->free_blocks = block;
+  --chunk->live_blocks;
+  --m_stats.live_blocks;
+}
+
+void SlabAllocator::Trim() {
+  for (auto& size_class : m_size_classes) {
+    auto& chunks = size_class.chunks;
+    auto it = std::remove_if(chunks.begin(), chunks.end(), [&](Chunk* chunk) {
+      if (chunk->live_blocks) {
+        return false;
+      }
+      // Empty chunks always have free blocks, so they are on the list.
+      if (chunk->prev_free) {
+        chunk->prev_free->next_free = chunk->next_free;
+      } else {
+        size_class.free_chunks = chunk->next_free;
+      }
+      if (chunk->next_free) {
+        chunk->next_free->prev_free = chunk->prev_free;
+      }
+      std::free(chunk);
+      --m_stats.chunk_count;
+      m_stats.chunk_bytes -= size_class.chunk_bytes;
+      ++m_stats.released_chunks;
+      return true;
+    });
+    chunks.erase(it, chunks.end());
+  }
+}
+
+}  // namespace util
+}  // namespace el
@@ -0,0 +1,76 @@
+/**
+ ******************************************************************************
+ * Elemental Forms : a lightweight user interface framework                   *
+ ******************************************************************************
+ * Copyright 2015 Ben Vanik. All rights reserved. Licensed as BSD 3-clause.   *
+ * Portions ©2011-2015 Emil Segerås: https://github.com/fruxo/turbobadger     *
+ ******************************************************************************
+ */
+
+#ifndef EL_UTIL_SLAB_ALLOCATOR_H_
+#define EL_UTIL_SLAB_ALLOCATOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace el {
+namespace util {
+
+// Size class allocator for objects that are created and destroyed often, such
+// as elements of popups and menus.
+// Blocks are carved out of chunks that each hold blocks of one size class.
+// Every chunk has its own free list, so chunks whose blocks have all been
+// freed can be returned to the system in bulk with Trim.
+// Allocations larger than max_block_size go to the general heap.
+class SlabAllocator {
+ public:
+  struct Stats {
+    // Blocks currently allocated from chunks.
+    size_t live_blocks = 0;
+    // Allocations served since construction, including oversized ones.
+    size_t total_allocations = 0;
+    // Allocations too large for any size class.
+    size_t oversize_allocations = 0;
+    // Chunks currently held and their total size in bytes.
+    size_t chunk_count = 0;
+    size_t chunk_bytes = 0;
+    // Chunks returned to the system by Trim.
+    size_t released_chunks = 0;
+  };
+
+  explicit SlabAllocator(size_t max_block_size);
+  ~SlabAllocator();
+
+  // Allocates size bytes aligned to 16 bytes.
+  void* Allocate(size_t size);
+  // Frees a pointer returned by Allocate. size must be the allocation size.
+  void Free(void* ptr, size_t size);
+
+  // Returns all chunks without live blocks to the system.
+  void Trim();
+
+  const Stats& stats() const { return m_stats; }
+
+ private:
+  struct Chunk;
+  struct SizeClass {
+    size_t block_size = 0;
+    size_t blocks_per_chunk = 0;
+    size_t chunk_bytes = 0;
+    std::vector<Chunk*> chunks;
+    // Chunks with at least one free block, linked through Chunk::next_free.
+    Chunk* free_chunks = nullptr;
+  };
+
+  Chunk* NewChunk(SizeClass* size_class);
+
+  size_t m_max_block_size;
+  std::vector<SizeClass> m_size_classes;
+  Stats m_stats;
+};
+
+}  // namespace util
+}  // namespace el
+
+#endif  // EL_UTIL_SLAB_ALLOCATOR_H_
@@ -21,6 +21,9 @@ namespace util {
 // means that ProcessMessages should be called asap (but NOT from this call!).
 // It may also be MessageHandler::kNotSoon which means that ProcessMessages
 // doesn't need to be called.
+// This is normally called on the thread processing messages, but
+// MessageHandler::PostMessageFromAnyThread calls it with 0 from the posting
+// thread, so hosts using that must handle this from any thread.
 void RescheduleTimer(uint64_t fire_time_millis);
 
 }  // namespace util
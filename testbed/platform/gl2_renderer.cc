@@ -30,12 +30,15 @@ GL2Renderer::GL2Bitmap::~GL2Bitmap() {
   glDeleteTextures(1, &handle_);
 }
 
-bool GL2Renderer::GL2Bitmap::Init(int width, int height, uint32_t* data) {
+bool GL2Renderer::GL2Bitmap::Init(int width, int height,
+                                  el::graphics::PixelFormat format,
+                                  const void* data) {
   assert(width == el::util::GetNearestPowerOfTwo(width));
   assert(height == el::util::GetNearestPowerOfTwo(height));
 
   width_ = width;
   height_ = height;
+  format_ = format;
 
   glGenTextures(1, &handle_);
   renderer_->BindBitmap(this);
@@ -47,14 +50,35 @@ bool GL2Renderer::GL2Bitmap::Init(int width, int height, uint32_t* data) {
   return true;
 }
 
-void GL2Renderer::GL2Bitmap::set_data(uint32_t* data) {
+GLenum GL2Renderer::GL2Bitmap::gl_format() const {
+  return format_ == el::graphics::PixelFormat::kA8 ? GL_ALPHA : GL_RGBA;
+}
+
+void GL2Renderer::GL2Bitmap::set_data(const void* data) {
   renderer_->FlushBitmap(this);
   renderer_->BindBitmap(this);
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width_, height_, 0, GL_RGBA,
+  // A8 rows are not necessarily 4 byte aligned.
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glTexImage2D(GL_TEXTURE_2D, 0, gl_format(), width_, height_, 0, gl_format(),
                GL_UNSIGNED_BYTE, data);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
   ++renderer_->bitmap_validations_;
 }
 
+bool GL2Renderer::GL2Bitmap::set_data_region(const el::Rect& rect,
+                                             const void* data, int stride) {
+  renderer_->FlushBitmap(this);
+  renderer_->BindBitmap(this);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, stride);
+  glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x, rect.y, rect.w, rect.h,
+                  gl_format(), GL_UNSIGNED_BYTE, data);
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  ++renderer_->bitmap_validations_;
+  return true;
+}
+
 GL2Renderer::GL2Renderer() {
   const std::string vertex_shader_source =
       "\
@@ -78,7 +102,13 @@ GL2Renderer::GL2Renderer() {
     varying vec2 vtx_uv;\n\
     void main() {\n\
       gl_FragColor = vtx_color;\n\
-      if (texture_mix > 0.0) {\n\
+      if (texture_mix > 2.5) {\n\
+        gl_FragColor.a *= texture2D(texture_sampler, vtx_uv).a;\n\
+      } else if (texture_mix > 1.5) {\n\
+        float d = texture2D(texture_sampler, vtx_uv).a;\n\
+        float w = clamp(fwidth(d) * 0.75, 0.001, 0.5);\n\
+        gl_FragColor.a *= smoothstep(0.5 - w, 0.5 + w, d);\n\
+      } else if (texture_mix > 0.0) {\n\
         gl_FragColor *= texture2D(texture_sampler, vtx_uv).rgba;\n\
       }\n\
     }\n\
@@ -123,6 +153,7 @@ void GL2Renderer::BeginPaint(int render_target_w, int render_target_h) {
   Renderer::BeginPaint(render_target_w, render_target_h);
 
   current_texture_ = 0;
+  current_texture_mix_ = 0.0f;
   batch_.vertices = vertices_;
 
   // Ortho2D(0, (GLfloat)render_target_w, (GLfloat)render_target_h, 0);
@@ -183,19 +214,30 @@ void GL2Renderer::EndPaint() {
 }
 
 std::unique_ptr<el::graphics::Bitmap> GL2Renderer::CreateBitmap(
-    int width, int height, uint32_t* data) {
+    int width, int height, el::graphics::PixelFormat format, const void* data) {
   auto bitmap = std::make_unique<GL2Bitmap>(this);
-  if (!bitmap->Init(width, height, data)) {
+  if (!bitmap->Init(width, height, format, data)) {
     return nullptr;
   }
   return std::unique_ptr<el::graphics::Bitmap>(std::move(bitmap));
 }
 
 void GL2Renderer::RenderBatch(Batch* batch) {
-  if (current_texture_ && !batch->bitmap) {
-    glUniform1f(texture_mix_loc_, 0.0f);
-  } else if (!current_texture_ && batch->bitmap) {
-    glUniform1f(texture_mix_loc_, 1.0f);
+  // 0 = untextured, 1 = textured, 2 = distance field, 3 = alpha only.
+  float texture_mix = 0.0f;
+  if (batch->bitmap) {
+    if (batch->is_distance_field) {
+      texture_mix = 2.0f;
+    } else if (static_cast<GL2Bitmap*>(batch->bitmap)->format_ ==
+               el::graphics::PixelFormat::kA8) {
+      texture_mix = 3.0f;
+    } else {
+      texture_mix = 1.0f;
+    }
+  }
+  if (texture_mix != current_texture_mix_) {
+    current_texture_mix_ = texture_mix;
+    glUniform1f(texture_mix_loc_, texture_mix);
   }
   BindBitmap(batch->bitmap);
   glDrawArrays(GL_TRIANGLES, 0, uint32_t(batch->vertex_count));
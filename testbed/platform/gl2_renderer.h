@@ -26,8 +26,15 @@ class GL2Renderer : public el::graphics::Renderer {
   void BeginPaint(int render_target_w, int render_target_h) override;
   void EndPaint() override;
 
-  std::unique_ptr<el::graphics::Bitmap> CreateBitmap(int width, int height,
-                                                     uint32_t* data) override;
+  std::unique_ptr<el::graphics::Bitmap> CreateBitmap(
+      int width, int height, el::graphics::PixelFormat format,
+      const void* data) override;
+
+  bool supports_pixel_format(
+      el::graphics::PixelFormat /*format*/) const override {
+    return true;
+  }
+  bool supports_distance_field() const override { return true; }
 
  protected:
   class GL2Bitmap : public el::graphics::Bitmap {
@@ -35,15 +42,20 @@ class GL2Renderer : public el::graphics::Renderer {
     GL2Bitmap(GL2Renderer* renderer);
     ~GL2Bitmap() override;
 
-    bool Init(int width, int height, uint32_t* data);
+    bool Init(int width, int height, el::graphics::PixelFormat format,
+              const void* data);
     int width() override { return width_; }
     int height() override { return height_; }
-    void set_data(uint32_t* data) override;
+    void set_data(const void* data) override;
+    bool set_data_region(const el::Rect& rect, const void* data,
+                         int stride) override;
+    GLenum gl_format() const;
 
    public:
     GL2Renderer* renderer_ = nullptr;
     int width_ = 0;
     int height_ = 0;
+    el::graphics::PixelFormat format_ = el::graphics::PixelFormat::kBGRA32;
     GLuint handle_ = 0;
   };
 
@@ -61,6 +73,7 @@ class GL2Renderer : public el::graphics::Renderer {
   GLuint texture_mix_loc_ = 0;
 
   GLuint current_texture_ = 0;
+  float current_texture_mix_ = 0.0f;
   Vertex vertices_[kMaxVertexBatchSize];
 
   size_t bitmap_validations_ = 0;
@@ -17,6 +17,7 @@
 
 #include "el/element.h"
 #include "el/elemental_forms.h"
+#include "el/frame_scheduler.h"
 #include "el/message_handler.h"
 #include "el/util/metrics.h"
 #include "el/util/timer.h"
@@ -52,25 +53,11 @@ ApplicationBackendGLFW* GetBackend(GLFWwindow* window) {
   return static_cast<ApplicationBackendGLFW*>(glfwGetWindowUserPointer(window));
 }
 
-// The root of all elements in a GLFW window.
-class RootElement : public Element {
- public:
-  RootElement(ApplicationBackendGLFW* backend) : m_backend(backend) {}
-  virtual void OnInvalid();
-
- private:
-  ApplicationBackendGLFW* m_backend;
-};
-
 class ApplicationBackendGLFW : public ApplicationBackend {
  public:
   bool Init(TestbedApplication* app, int width, int height, const char* title);
   ApplicationBackendGLFW()
-      : m_application(nullptr),
-        m_renderer(nullptr),
-        m_root(this),
-        mainWindow(0),
-        has_pending_update(false) {}
+      : m_application(nullptr), m_renderer(nullptr), mainWindow(0) {}
   ~ApplicationBackendGLFW();
 
   virtual void Run();
@@ -82,17 +69,11 @@ class ApplicationBackendGLFW : public ApplicationBackend {
 
   TestbedApplication* m_application;
   GL2Renderer* m_renderer;
-  RootElement m_root;
+  // The root of all elements in the window.
+  Element m_root;
   GLFWwindow* mainWindow;
-  bool has_pending_update;
 };
 
-void RootElement::OnInvalid() {
-  if (!m_backend->has_pending_update) {
-    m_backend->has_pending_update = true;
-  }
-}
-
 ModifierKeys GetModifierKeys() {
   ModifierKeys code = ModifierKeys::kNone;
   if (key_alt) code |= ModifierKeys::kAlt;
@@ -369,10 +350,9 @@ static void scroll_callback(GLFWwindow* window, double x, double y) {
 static void window_refresh_callback(GLFWwindow* window) {
   ApplicationBackendGLFW* backend = GetBackend(window);
 
+  FrameScheduler::BeginFrame();
   backend->m_application->Process();
 
-  backend->has_pending_update = false;
-
   // Bail out if we get here with invalid dimensions.
   // This may happen when minimizing windows (GLFW 3.0.4, Windows 8.1).
   if (backend->width() == 0 || backend->height() == 0) return;
@@ -480,6 +460,9 @@ bool ApplicationBackendGLFW::Init(TestbedApplication* app, int width,
 
 #if (GLFW_VERSION_MAJOR >= 3 && GLFW_VERSION_MINOR >= 1)
   glfwSetDropCallback(mainWindow, drop_callback);
+  // Wakes Run up from glfwWaitEvents when messages are posted from other
+  // threads.
+  MessageHandler::set_wake_up_callback([]() { glfwPostEmptyEvent(); });
 #endif
 
   gladLoadGL();
@@ -511,6 +494,8 @@ ApplicationBackendGLFW::~ApplicationBackendGLFW() {
   m_application->OnBackendDetached();
   m_application = nullptr;
 
+  MessageHandler::set_wake_up_callback(nullptr);
+
   el::Shutdown();
 
   glfwTerminate();
@@ -520,10 +505,30 @@ ApplicationBackendGLFW::~ApplicationBackendGLFW() {
 
 void ApplicationBackendGLFW::Run() {
   do {
-    glfwPollEvents();
+    // Sleep until there is input or the library needs another frame, so an
+    // idle window doesn't use any CPU.
+    uint64_t deadline = FrameScheduler::GetNextDeadline();
+    uint64_t now = el::util::GetTimeMS();
+    if (deadline == FrameScheduler::kNotSoon) {
+      glfwWaitEvents();
+    } else if (deadline > now) {
+#if GLFW_VERSION_MAJOR > 3 || \
+    (GLFW_VERSION_MAJOR == 3 && GLFW_VERSION_MINOR >= 2)
+      glfwWaitEventsTimeout((deadline - now) / 1000.0);
+#else
+      glfwPollEvents();
+#endif
+    } else {
+      glfwPollEvents();
+    }
 
-    if (has_pending_update) window_refresh_callback(mainWindow);
+    // Process due messages here as well, since there is no platform timer on
+    // all platforms and the wait above may wake up before it fires.
+    if (MessageHandler::GetNextMessageFireTime() <= el::util::GetTimeMS()) {
+      MessageHandler::ProcessMessages();
+    }
 
+    if (FrameScheduler::is_dirty()) window_refresh_callback(mainWindow);
   } while (!glfwWindowShouldClose(mainWindow));
 }
 
@@ -34,7 +34,9 @@ ResourceEditWindow::ResourceEditWindow()
       m_build_container(nullptr),
       m_source_text_box(nullptr) {
   // Register as global listener to intercept events in the build container
-  ElementListener::AddGlobalListener(this);
+  ElementListener::AddGlobalListener(
+      this, ElementListenerEvents::kInvokeEvent |
+                ElementListenerEvents::kAdded | ElementListenerEvents::kRemove);
 
   LoadFile("resource_edit_window.tb.txt");
 
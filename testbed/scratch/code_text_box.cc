@@ -8,6 +8,7 @@
  */
 
 #include <cctype>
+#include <cstring>
 
 #include "el/parsing/element_factory.h"
 #include "el/parsing/element_inflater.h"
@@ -22,57 +23,87 @@ void CodeTextBox::RegisterInflater() {
                                ElementZ::kTop);
 }
 
-CodeTextBox::CodeTextBox() : TextBox(), inComment(false) {}
+CodeTextBox::CodeTextBox() : TextBox() { text_view()->set_styler(this); }
 
 void CodeTextBox::OnInflate(const parsing::InflateInfo& info) {
   TextBox::OnInflate(info);
 }
 
-void CodeTextBox::DrawString(int32_t x, int32_t y, text::FontFace* font,
-                             const Color& color, const char* str, size_t len) {
-  Color finalColor(color);
-  StringHasColorOverride(str, len, finalColor);
-  TextBox::DrawString(x, y, font, finalColor, str, len);
-}
-
-void CodeTextBox::OnBreak() { inComment = false; }
-
-bool CodeTextBox::StringHasColorOverride(const char* str, size_t len,
-                                         Color& colour) {
-  if (strlen(str) >= 2) {
-    if (str[0] == '/' && str[1] == '/') {
-      inComment = true;
+uint32_t CodeTextBox::StyleBlock(const char* text, size_t len,
+                                 uint32_t start_state,
+                                 std::vector<text::TextStyleRun>* out_runs) {
+  const Color comment_color(113, 143, 113);
+  const Color keyword_color(90, 127, 230);
+  size_t i = 0;
+  if (start_state == kInBlockComment) {
+    // Continue the comment from the previous block until it's closed.
+    while (i < len && !(text[i] == '*' && i + 1 < len && text[i + 1] == '/')) {
+      ++i;
     }
+    if (i == len) {
+      out_runs->push_back({0, len, comment_color});
+      return kInBlockComment;
+    }
+    i += 2;
+    out_runs->push_back({0, i, comment_color});
   }
-
-  if (inComment) {
-    colour = Color(113, 143, 113);
-    return true;
+  while (i < len) {
+    if (text[i] == '/' && i + 1 < len && text[i + 1] == '/') {
+      out_runs->push_back({i, len - i, comment_color});
+      return kNormal;
+    }
+    if (text[i] == '/' && i + 1 < len && text[i + 1] == '*') {
+      size_t start = i;
+      i += 2;
+      while (i < len &&
+             !(text[i] == '*' && i + 1 < len && text[i + 1] == '/')) {
+        ++i;
+      }
+      if (i == len) {
+        out_runs->push_back({start, len - start, comment_color});
+        return kInBlockComment;
+      }
+      i += 2;
+      out_runs->push_back({start, i - start, comment_color});
+      continue;
+    }
+    if (std::isalnum(static_cast<unsigned char>(text[i])) || text[i] == '_') {
+      size_t start = i;
+      while (i < len && (std::isalnum(static_cast<unsigned char>(text[i])) ||
+                         text[i] == '_')) {
+        ++i;
+      }
+      if (IsKeyword(text + start, i - start)) {
+        out_runs->push_back({start, i - start, keyword_color});
+      }
+      continue;
+    }
+    ++i;
   }
+  return kNormal;
+}
 
-  const char* keywords[] = {"in",  "vec3",  "uvec2",   "const", "uniform", "void",
-                      "if",  "float", "vec4",    "for",   "uint",    "abs",
-                      "sin", "cos",   "texture", "int"};
+bool CodeTextBox::IsKeyword(const char* str, size_t len) {
+  const char* keywords[] = {"in",   "vec3", "uvec2", "const",   "uniform",
+                            "void", "if",   "float", "vec4",    "for",
+                            "uint", "abs",  "sin",   "cos",     "texture",
+                            "int"};
 
-  for (int32_t keywordIdx = 0; keywordIdx < 16; keywordIdx++) {
-    const char* matchAgainst = keywords[keywordIdx];
-    int32_t matchLen = (int32_t)strlen(matchAgainst);
-    if (matchLen == len) {
-      auto matched = true;
-      for (int32_t i = 0; i < len; ++i) {
-        if (toupper(matchAgainst[i]) != toupper(str[i])) {
-          matched = false;
-          break;
-        }
-      }
-
-      if (matched) {
-        colour = Color(90, 127, 230);
-        return true;
+  for (const char* keyword : keywords) {
+    if (strlen(keyword) != len) {
+      continue;
+    }
+    bool matched = true;
+    for (size_t i = 0; i < len; ++i) {
+      if (toupper(keyword[i]) != toupper(str[i])) {
+        matched = false;
+        break;
       }
     }
+    if (matched) {
+      return true;
+    }
   }
-
   return false;
 }
 
@@ -16,23 +16,27 @@
 
 namespace testbed {
 
-class CodeTextBox : public el::elements::TextBox {
+// A TextBox that highlights keywords and comments using a TextStyler.
+class CodeTextBox : public el::elements::TextBox,
+                    private el::text::TextStyler {
  public:
   static void RegisterInflater();
 
-  enum SpecialStringTypes { Keyword, Variable };
   CodeTextBox();
 
   virtual void OnInflate(const el::parsing::InflateInfo& info);
 
  private:
-  virtual void DrawString(int32_t x, int32_t y, el::text::FontFace* font,
-                          const el::Color& color, const char* str, size_t len);
-  virtual void OnBreak();
+  // States at the end of a block.
+  enum StyleState : uint32_t {
+    kNormal = 0,
+    kInBlockComment = 1,
+  };
 
-  bool StringHasColorOverride(const char* str, size_t len, el::Color& colour);
+  uint32_t StyleBlock(const char* text, size_t len, uint32_t start_state,
+                      std::vector<el::text::TextStyleRun>* out_runs) override;
 
-  bool inComment;
+  static bool IsKeyword(const char* str, size_t len);
 };
 
 }  // namespace testbed
@@ -201,9 +201,9 @@ void TestbedApplication::RenderFrame(int window_w, int window_h) {
 
   Renderer::get()->EndPaint();
 
-  // If we want continous updates or got animations running, reinvalidate
-  // immediately
-  if (continuous_repaint || AnimationManager::has_running_animations()) {
+  // If we want continous updates, reinvalidate immediately. Running
+  // animations keep FrameScheduler dirty by themselves.
+  if (continuous_repaint) {
     GetRoot()->Invalidate();
   }
 }